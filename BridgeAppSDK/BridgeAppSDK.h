@@ -44,9 +44,13 @@ FOUNDATION_EXPORT const unsigned char BridgeAppSDKVersionString[];
 #import <BridgeAppSDK/SBADefines.h>
 #import <BridgeAppSDK/SBADemographicDataObjectType.h>
 #import <BridgeAppSDK/SBALog.h>
+#import <BridgeAppSDK/SBALogSink.h>
+#import <BridgeAppSDK/SBALogEventLog.h>
 #import <BridgeAppSDK/SBADataArchive.h>
 #import <BridgeAppSDK/SBANewsFeedItem.h>
 #import <BridgeAppSDK/SBANewsFeedManager.h>
+#import <BridgeAppSDK/SBANewsFeedParser.h>
+#import <BridgeAppSDK/SBANewsFeedStore.h>
 #import <BridgeAppSDK/SBAOnboardingAppDelegate.h>
 #import <BridgeAppSDK/SBAProfileItem.h>
 #import <BridgeAppSDK/SBAProfileSection.h>
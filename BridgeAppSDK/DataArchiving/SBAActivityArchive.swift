@@ -132,11 +132,42 @@ open class SBAActivityArchive: SBBDataArchive {
 
     fileprivate var metadata = [String: AnyObject]()
     
-    public convenience init?(result: SBAActivityResult, jsonValidationMapping: [String: NSPredicate]? = nil) {
-        self.init(result: result as SBAScheduledActivityResult, schedule: result.schedule, jsonValidationMapping: jsonValidationMapping)
+    /**
+     Default size of the buffer used to write an archive entry to disk when streaming.
+     */
+    public static let defaultStreamBufferSize = 64 * 1024
+    
+    /**
+     Size of the buffer used to write each archive entry to disk as it is built. If `nil`, then
+     the archive entries are held in memory until the archive is completed.
+     
+     When streaming, the JSON and data entries are written to a staging file and inserted into the
+     archive as memory-mapped data. This keeps the serialized entries out of the dirty memory
+     footprint of the app so that large results (such as sensor recordings) do not spike memory.
+     */
+    public let streamBufferSize: Int?
+    
+    /**
+     Whether or not this archive streams each entry to disk as it is built.
+     */
+    public var isStreaming: Bool {
+        return streamBufferSize != nil
+    }
+    
+    // Filenames with a json validation mapping are always inserted as dictionaries
+    // so that the validation is applied by the base class.
+    fileprivate let validatedFilenames: Set<String>
+    
+    fileprivate var stagingDirectory: URL?
+    
+    public convenience init?(result: SBAActivityResult, jsonValidationMapping: [String: NSPredicate]? = nil, streamBufferSize: Int? = nil) {
+        self.init(result: result as SBAScheduledActivityResult, schedule: result.schedule, jsonValidationMapping: jsonValidationMapping, streamBufferSize: streamBufferSize)
     }
     
-    public init?(result: SBAScheduledActivityResult, schedule: SBBScheduledActivity, jsonValidationMapping: [String: NSPredicate]? = nil) {
+    public init?(result: SBAScheduledActivityResult, schedule: SBBScheduledActivity, jsonValidationMapping: [String: NSPredicate]? = nil, streamBufferSize: Int? = nil) {
+        
+        self.streamBufferSize = streamBufferSize
+        self.validatedFilenames = Set(jsonValidationMapping?.keys.map({ $0 }) ?? [])
         
         super.init(reference: result.schemaIdentifier, jsonValidationMapping: jsonValidationMapping)
         
@@ -185,9 +216,18 @@ open class SBAActivityArchive: SBBDataArchive {
     func buildArchiveForResult(_ activityResult: SBAScheduledActivityResult) -> Bool {
         guard let archivableResults = activityResult.archivableResults() else { return false }
 
+        // Staged files are unlinked as soon as they are mapped, so the directory can be removed
+        // once all the results have been inserted.
+        defer {
+            removeStagingDirectory()
+        }
+
         // (although there _still_ might be nothing to archive, if none of the stepResults have any results.)
         for (stepIdentifier, result) in archivableResults {
-            if !insert(result: result, stepIdentifier: stepIdentifier, activityIdentifier: activityResult.identifier) {
+            let success: Bool = autoreleasepool {
+                return insert(result: result, stepIdentifier: stepIdentifier, activityIdentifier: activityResult.identifier)
+            }
+            if !success {
                 return false
             }
         }
@@ -211,18 +251,127 @@ open class SBAActivityArchive: SBBDataArchive {
             return false
         }
         
-        if let urlResult = archiveableResult.result as? URL {
-            self.insertURL(intoArchive: urlResult, fileName: archiveableResult.filename)
-        } else if let dictResult = archiveableResult.result as? [AnyHashable: Any] {
-            self.insertDictionary(intoArchive: dictResult, filename: archiveableResult.filename, createdOn: result.startDate)
-        } else if let dataResult = archiveableResult.result as? NSData {
-            self.insertData(intoArchive: dataResult as Data, filename: archiveableResult.filename, createdOn: result.startDate)
+        return insert(archiveObject: archiveableResult.result, filename: archiveableResult.filename, createdOn: result.startDate)
+    }
+    
+    /**
+     Method for inserting an archive object into the archive. If this archive is streaming, then
+     JSON and data objects are written to disk before being inserted.
+     
+     Files (such as sensor recordings in the task output directory) are memory-mapped rather than
+     read into memory, so that the pages can be dropped by the system and are never dirtied.
+     
+     @param     archiveObject   The object to insert. Supported types are `URL`, `NSDictionary` and `NSData`.
+     @param     filename        The filename to use for the object in the archive.
+     @param     createdOn       The timestamp to use for when the object was created.
+     @return                    `true` if the object was inserted.
+     */
+    open func insert(archiveObject: Any, filename: String, createdOn: Date) -> Bool {
+        
+        if let urlResult = archiveObject as? URL {
+            if let data = mappedData(fileURL: urlResult) {
+                self.insertData(intoArchive: data.data, filename: filename, createdOn: data.createdOn ?? createdOn)
+            } else {
+                self.insertURL(intoArchive: urlResult, fileName: filename)
+            }
+        } else if let dictResult = archiveObject as? [AnyHashable: Any] {
+            if let data = streamedData(jsonObject: dictResult, filename: filename) {
+                self.insertData(intoArchive: data, filename: filename, createdOn: createdOn)
+            } else {
+                self.insertDictionary(intoArchive: dictResult, filename: filename, createdOn: createdOn)
+            }
+        } else if let dataResult = archiveObject as? NSData {
+            let data = streamedData(data: dataResult as Data) ?? dataResult as Data
+            self.insertData(intoArchive: data, filename: filename, createdOn: createdOn)
         } else {
-            assertionFailure("Unsupported archiveable result type: \(archiveableResult.result)")
+            assertionFailure("Unsupported archiveable result type: \(archiveObject)")
             return false
         }
         
         return true
     }
     
+    // MARK: Streaming
+    
+    /**
+     Map a file into memory. Mapped data is backed by the file, which is only read as the archive
+     is compressed.
+     */
+    fileprivate func mappedData(fileURL: URL) -> (data: Data, createdOn: Date?)? {
+        guard fileURL.isFileURL, let data = try? Data(contentsOf: fileURL, options: .alwaysMapped) else { return nil }
+        let createdOn = (try? fileURL.resourceValues(forKeys: [.creationDateKey]))?.creationDate
+        return (data, createdOn)
+    }
+    
+    fileprivate func streamedData(jsonObject: [AnyHashable: Any], filename: String) -> Data? {
+        guard isStreaming, !validatedFilenames.contains(filename),
+            JSONSerialization.isValidJSONObject(jsonObject)
+            else {
+                return nil
+        }
+        return stageFile { (stream) -> Bool in
+            var error: NSError?
+            JSONSerialization.writeJSONObject(jsonObject, to: stream, options: [], error: &error)
+            return error == nil
+        }
+    }
+    
+    fileprivate func streamedData(data: Data) -> Data? {
+        guard let bufferSize = streamBufferSize else { return nil }
+        return stageFile { (stream) -> Bool in
+            return data.withUnsafeBytes { (bytes: UnsafePointer<UInt8>) -> Bool in
+                var offset = 0
+                while offset < data.count {
+                    let written = stream.write(bytes.advanced(by: offset), maxLength: min(bufferSize, data.count - offset))
+                    guard written > 0 else { return false }
+                    offset += written
+                }
+                return true
+            }
+        }
+    }
+    
+    /**
+     Write to a staging file and then map the file into memory. The file is unlinked once mapped
+     so that the disk space is reclaimed when the archive releases the data.
+     */
+    fileprivate func stageFile(_ write: (OutputStream) -> Bool) -> Data? {
+        guard let directory = createStagingDirectoryIfNeeded() else { return nil }
+        let url = directory.appendingPathComponent(UUID().uuidString)
+        guard let stream = OutputStream(url: url, append: false) else { return nil }
+        defer {
+            try? FileManager.default.removeItem(at: url)
+        }
+        
+        stream.open()
+        let success = write(stream)
+        stream.close()
+        
+        guard success else { return nil }
+        return try? Data(contentsOf: url, options: .alwaysMapped)
+    }
+    
+    fileprivate func createStagingDirectoryIfNeeded() -> URL? {
+        if let directory = stagingDirectory {
+            return directory
+        }
+        let url = URL(fileURLWithPath: NSTemporaryDirectory(), isDirectory: true)
+            .appendingPathComponent("SBAActivityArchive", isDirectory: true)
+            .appendingPathComponent(UUID().uuidString, isDirectory: true)
+        do {
+            try FileManager.default.createDirectory(at: url, withIntermediateDirectories: true, attributes: nil)
+            stagingDirectory = url
+            return url
+        }
+        catch let error {
+            print("Failed to create archive staging directory: \(error)")
+            return nil
+        }
+    }
+    
+    fileprivate func removeStagingDirectory() {
+        guard let directory = stagingDirectory else { return }
+        try? FileManager.default.removeItem(at: directory)
+        stagingDirectory = nil
+    }
 }
@@ -0,0 +1,279 @@
+//
+//  SBADiskBudget.swift
+//  BridgeAppSDK
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+import Foundation
+
+/**
+ Disk usage of the files tracked by an `SBADiskBudget`.
+ */
+public struct SBADiskUsage {
+    
+    public internal(set) var archiveCount: Int = 0
+    public internal(set) var archiveBytes: Int64 = 0
+    public internal(set) var outputDirectoryCount: Int = 0
+    public internal(set) var outputDirectoryBytes: Int64 = 0
+    
+    /**
+     Number of pending archives and output directories deleted by the budget since it was created.
+     */
+    public internal(set) var evictedCount: Int = 0
+    
+    /**
+     Number of bytes deleted by the budget since it was created.
+     */
+    public internal(set) var evictedBytes: Int64 = 0
+    
+    public var totalBytes: Int64 {
+        return archiveBytes + outputDirectoryBytes
+    }
+}
+
+/**
+ `SBADiskBudget` limits the disk space used by the encrypted archives that are waiting to be
+ uploaded and by the ResearchKit output directories of the tasks that have been run.
+ 
+ When `enforce()` is called, the budget first deletes the output directories that are no longer
+ needed. These are the directories registered during a previous launch (the task was interrupted
+ before its directory was deleted) or more than `outputDirectoryMaximumAge` ago. Then pending
+ archives that are older than `maximumArchiveAge` are deleted. Last, if the files still use more
+ than `maximumBytes`, the oldest pending archives are deleted until they fit.
+ */
+public final class SBADiskBudget {
+    
+    /**
+     The shared budget for the archives in `SBAUploadLedger.shared`.
+     */
+    public static let shared = SBADiskBudget()
+    
+    /**
+     The default location of the file where the output directories are stored.
+     */
+    public static var defaultURL: URL {
+        let supportURL = FileManager.default.urls(for: .applicationSupportDirectory, in: .userDomainMask).first!
+        return supportURL.appendingPathComponent("SBADiskBudget.json")
+    }
+    
+    /**
+     The ledger of the pending archives.
+     */
+    public let ledger: SBAUploadLedger
+    
+    /**
+     The file where the registered output directories are stored.
+     */
+    public let fileURL: URL
+    
+    /**
+     Maximum number of bytes for the pending archives and output directories. Default = 200 MB.
+     */
+    public var maximumBytes: Int64 = 200 * 1024 * 1024
+    
+    /**
+     Pending archives older than this are deleted. Default = 60 days.
+     */
+    public var maximumArchiveAge: TimeInterval = 60 * 24 * 60 * 60
+    
+    /**
+     Output directories registered longer ago than this are deleted. Default = 1 day.
+     */
+    public var outputDirectoryMaximumAge: TimeInterval = 24 * 60 * 60
+    
+    private let lockQueue = DispatchQueue(label: "org.sagebase.BridgeAppSDK.SBADiskBudget")
+    private var _outputDirectories: [String : Date]?
+    private var _activeOutputDirectories = Set<String>()
+    private var _evictedCount = 0
+    private var _evictedBytes: Int64 = 0
+    
+    public init(ledger: SBAUploadLedger = SBAUploadLedger.shared, fileURL: URL = SBADiskBudget.defaultURL) {
+        self.ledger = ledger
+        self.fileURL = fileURL
+    }
+    
+    /**
+     Track the output directory of a task that is running.
+     */
+    public func registerOutputDirectory(_ url: URL) {
+        let path = url.path
+        lockQueue.sync {
+            _activeOutputDirectories.insert(path)
+            var directories = outputDirectories()
+            guard directories[path] == nil else { return }
+            directories[path] = Date()
+            _outputDirectories = directories
+            save()
+        }
+    }
+    
+    /**
+     Stop tracking an output directory once it has been deleted.
+     */
+    public func unregisterOutputDirectory(_ url: URL) {
+        let path = url.path
+        lockQueue.sync {
+            _activeOutputDirectories.remove(path)
+            var directories = outputDirectories()
+            guard directories.removeValue(forKey: path) != nil else { return }
+            _outputDirectories = directories
+            save()
+        }
+    }
+    
+    /**
+     The current disk usage.
+     */
+    public func usage() -> SBADiskUsage {
+        let archives = ledger.pendingEntries
+        return lockQueue.sync {
+            var usage = SBADiskUsage()
+            usage.archiveCount = archives.count
+            usage.archiveBytes = archives.reduce(0) { $0 + $1.fileSize }
+            let directories = outputDirectories()
+            usage.outputDirectoryCount = directories.count
+            usage.outputDirectoryBytes = directories.keys.reduce(0) { $0 + SBADiskBudget.allocatedSize(ofDirectory: $1) }
+            usage.evictedCount = _evictedCount
+            usage.evictedBytes = _evictedBytes
+            return usage
+        }
+    }
+    
+    /**
+     Delete the files that are no longer needed or do not fit in the budget.
+     
+     @param now     The current date.
+     @return        The disk usage after the files have been deleted.
+     */
+    @discardableResult
+    public func enforce(now: Date = Date()) -> SBADiskUsage {
+        
+        // Prune the raw output of the tasks that are not running
+        lockQueue.sync {
+            var directories = outputDirectories()
+            for (path, registeredOn) in directories {
+                let isActive = _activeOutputDirectories.contains(path)
+                guard !isActive || now.timeIntervalSince(registeredOn) > outputDirectoryMaximumAge else { continue }
+                evict(URL(fileURLWithPath: path), size: SBADiskBudget.allocatedSize(ofDirectory: path))
+                directories[path] = nil
+                _activeOutputDirectories.remove(path)
+            }
+            _outputDirectories = directories
+            save()
+        }
+        
+        // Drop the archives that are too old
+        ledger.refresh()
+        var archives = ledger.pendingEntries.sorted(by: { $0.addedOn < $1.addedOn })
+        while let oldest = archives.first, now.timeIntervalSince(oldest.addedOn) > maximumArchiveAge {
+            evictArchive(oldest)
+            archives.removeFirst()
+        }
+        
+        // Then the oldest archives until the rest fit
+        var total = archives.reduce(0) { $0 + $1.fileSize } + lockQueue.sync {
+            outputDirectories().keys.reduce(0) { $0 + SBADiskBudget.allocatedSize(ofDirectory: $1) }
+        }
+        while total > maximumBytes, let oldest = archives.first {
+            evictArchive(oldest)
+            archives.removeFirst()
+            total -= oldest.fileSize
+        }
+        
+        return usage()
+    }
+    
+    private func evictArchive(_ entry: SBAUploadLedgerEntry) {
+        let url = ledger.rootURL.appendingPathComponent(entry.path)
+        debugPrint("Deleting archive that was not uploaded: \(entry.path)")
+        SBAEncryptionHelper.cleanUpEncryptedFile(url)
+        ledger.remove(url)
+        lockQueue.sync {
+            _evictedCount += 1
+            _evictedBytes += entry.fileSize
+        }
+    }
+    
+    // MARK: Called on the lock queue
+    
+    private func evict(_ url: URL, size: Int64) {
+        do {
+            if FileManager.default.fileExists(atPath: url.path) {
+                try FileManager.default.removeItem(at: url)
+                _evictedCount += 1
+                _evictedBytes += size
+            }
+        } catch let err {
+            debugPrint("Failed to delete \(url): \(err)")
+        }
+    }
+    
+    private func outputDirectories() -> [String : Date] {
+        if let directories = _outputDirectories {
+            return directories
+        }
+        var directories: [String : Date] = [:]
+        if let data = try? Data(contentsOf: fileURL) {
+            do {
+                directories = try JSONDecoder().decode([String : Date].self, from: data)
+            } catch let err {
+                debugPrint("Failed to read the disk budget: \(err)")
+            }
+        }
+        _outputDirectories = directories
+        return directories
+    }
+    
+    private func save() {
+        do {
+            let data = try JSONEncoder().encode(_outputDirectories ?? [:])
+            try FileManager.default.createDirectory(at: fileURL.deletingLastPathComponent(), withIntermediateDirectories: true, attributes: nil)
+            try data.write(to: fileURL, options: [.atomic, .completeFileProtectionUntilFirstUserAuthentication])
+        } catch let err {
+            debugPrint("Failed to save the disk budget: \(err)")
+        }
+    }
+    
+    private static func allocatedSize(ofDirectory path: String) -> Int64 {
+        let url = URL(fileURLWithPath: path, isDirectory: true)
+        let keys: [URLResourceKey] = [.isRegularFileKey, .totalFileAllocatedSizeKey, .fileSizeKey]
+        guard let enumerator = FileManager.default.enumerator(at: url, includingPropertiesForKeys: keys, options: [], errorHandler: nil)
+            else {
+                return 0
+        }
+        var size: Int64 = 0
+        for case let fileURL as URL in enumerator {
+            guard let values = try? fileURL.resourceValues(forKeys: Set(keys)), values.isRegularFile == true else { continue }
+            size += Int64(values.totalFileAllocatedSize ?? values.fileSize ?? 0)
+        }
+        return size
+    }
+}
@@ -56,20 +56,21 @@ import UIKit
         return NSTemporaryDirectory()
     }
     
+    /**
+     The encrypted archives that are waiting for an upload response, smallest first. These are
+     looked up in the `SBAUploadLedger` rather than by walking the temporary directory.
+     */
     open class func encryptedFilesAwaitingUploadResponse() -> [String] {
-        let tmpDir = encryptedDataPathRoot()
-        let fileMan = FileManager.default
-        
-        let tmpContents = fileMan.subpaths(atPath: tmpDir)
-        let filesOfInterest = tmpContents?.sba_mapAndFilter({ (file) -> String? in
-            guard isEncryptedString(file as NSString) else { return nil }
-            return (tmpDir as NSString).appendingPathComponent(file)
-        })
-        return filesOfInterest ?? []
+        let ledger = SBAUploadLedger.shared
+        ledger.refresh()
+        return ledger.pendingFileURLs.map { $0.path }
     }
 
     open class func cleanUpEncryptedFile(_ file: URL) {
         let dirUrl = isEncryptedURL(file) ? file.deletingLastPathComponent() : file
+        if isEncryptedURL(file) {
+            SBAUploadLedger.shared.remove(file)
+        }
         
         do {
             try FileManager.default.removeItem(at: dirUrl)
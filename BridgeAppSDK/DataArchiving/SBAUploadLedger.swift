@@ -0,0 +1,415 @@
+//
+//  SBAUploadLedger.swift
+//  BridgeAppSDK
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+import Foundation
+
+/**
+ An encrypted archive that is waiting to be uploaded.
+ */
+public struct SBAUploadLedgerEntry: Codable, Equatable {
+    
+    /**
+     The path to the encrypted archive, relative to the ledger's `rootURL`.
+     */
+    public let path: String
+    
+    /**
+     The size of the encrypted archive in bytes.
+     */
+    public let fileSize: Int64
+    
+    /**
+     When the archive was added to the ledger (or created, if the archive was found on disk).
+     */
+    public let addedOn: Date
+    
+    /**
+     The number of times that the ledger has tried to upload the archive.
+     */
+    public internal(set) var attemptCount: Int = 0
+    
+    /**
+     When the ledger last tried to upload the archive.
+     */
+    public internal(set) var lastAttemptOn: Date?
+    
+    /**
+     The error from the last failed upload.
+     */
+    public internal(set) var lastError: String?
+    
+    init(path: String, fileSize: Int64, addedOn: Date) {
+        self.path = path
+        self.fileSize = fileSize
+        self.addedOn = addedOn
+    }
+}
+
+/**
+ Upload counts and throughput for the uploads retried by an `SBAUploadLedger`.
+ */
+public struct SBAUploadMetrics {
+    
+    public internal(set) var uploadCount: Int = 0
+    public internal(set) var failureCount: Int = 0
+    public internal(set) var bytesUploaded: Int64 = 0
+    public internal(set) var uploadDuration: TimeInterval = 0
+    
+    /**
+     Average throughput of the successful uploads.
+     */
+    public var bytesPerSecond: Double {
+        return uploadDuration > 0 ? Double(bytesUploaded) / uploadDuration : 0
+    }
+}
+
+/**
+ The `SBAArchiveUploader` protocol is used by `SBAUploadLedger` to upload an encrypted archive.
+ */
+public protocol SBAArchiveUploader: class {
+    
+    /**
+     Upload the file and call the completion handler when the server has accepted it, or with an
+     error if the upload failed.
+     */
+    func uploadFile(_ fileURL: URL, completion: @escaping (Error?) -> Void)
+}
+
+/**
+ Uploads the encrypted archives to Bridge using the BridgeSDK background session.
+ */
+public final class SBABridgeArchiveUploader: SBAArchiveUploader {
+    
+    public init() {
+    }
+    
+    public func uploadFile(_ fileURL: URL, completion: @escaping (Error?) -> Void) {
+        SBABridgeManager.uploadFile(fileURL, contentType: "application/zip") { (error) in
+            completion(error)
+        }
+    }
+}
+
+/**
+ `SBAUploadLedger` is an index of the encrypted archives that are waiting for an upload response.
+ 
+ Each entry has the size of the archive, the number of upload attempts and the last error. The
+ ledger is stored on disk, so finding the pending archives does not require walking the temporary
+ directory. The archives are added to the ledger by `refresh()`, which only looks at the top level
+ of each directory in the `rootURL`.
+ 
+ The archives are uploaded with the session of the participant who is signed in, so `removeAll()`
+ should be called when the participant signs out.
+ 
+ BridgeSDK uploads each archive when it is encrypted and retries the uploads that are interrupted
+ while the background session is active. Archives that are still on disk after `retryAge` are
+ uploaded again by `retryPendingUploads()`, smallest first, backing off after each failed attempt.
+ */
+public final class SBAUploadLedger {
+    
+    /**
+     The shared ledger for the encrypted archives in `SBAEncryptionHelper.encryptedDataPathRoot()`.
+     */
+    public static let shared = SBAUploadLedger()
+    
+    /**
+     The default location of the file where the ledger is stored.
+     */
+    public static var defaultURL: URL {
+        let supportURL = FileManager.default.urls(for: .applicationSupportDirectory, in: .userDomainMask).first!
+        return supportURL.appendingPathComponent("SBAUploadLedger.json")
+    }
+    
+    /**
+     The directory that holds the encrypted archives.
+     */
+    public let rootURL: URL
+    
+    /**
+     The file where the ledger is stored.
+     */
+    public let fileURL: URL
+    
+    /**
+     The uploader used to retry the pending uploads.
+     */
+    public let uploader: SBAArchiveUploader
+    
+    /**
+     How long to wait after an archive is added before trying to upload it again. Default = 1 day.
+     */
+    public var retryAge: TimeInterval = 24 * 60 * 60
+    
+    /**
+     How long to wait after the first failed upload attempt. The wait is doubled after each
+     failure, up to `maximumRetryInterval`. Default = 1 minute.
+     */
+    public var retryInterval: TimeInterval = 60
+    
+    /**
+     Maximum time to wait between upload attempts. Default = 1 day.
+     */
+    public var maximumRetryInterval: TimeInterval = 24 * 60 * 60
+    
+    private let lockQueue = DispatchQueue(label: "org.sagebase.BridgeAppSDK.SBAUploadLedger")
+    private var _entries: [String : SBAUploadLedgerEntry]?
+    private var _metrics = SBAUploadMetrics()
+    private var _isRetrying = false
+    
+    public init(rootURL: URL = URL(fileURLWithPath: SBAEncryptionHelper.encryptedDataPathRoot()),
+                fileURL: URL = SBAUploadLedger.defaultURL,
+                uploader: SBAArchiveUploader = SBABridgeArchiveUploader()) {
+        self.rootURL = rootURL.resolvingSymlinksInPath()
+        self.fileURL = fileURL
+        self.uploader = uploader
+    }
+    
+    /**
+     The pending archives, smallest first.
+     */
+    public var pendingEntries: [SBAUploadLedgerEntry] {
+        return lockQueue.sync { sortedEntries(Array(entries().values)) }
+    }
+    
+    /**
+     The file URLs of the pending archives, smallest first.
+     */
+    public var pendingFileURLs: [URL] {
+        return pendingEntries.map { rootURL.appendingPathComponent($0.path) }
+    }
+    
+    /**
+     Upload counts and throughput for the uploads retried by this ledger.
+     */
+    public var metrics: SBAUploadMetrics {
+        return lockQueue.sync { _metrics }
+    }
+    
+    /**
+     Remove an archive from the ledger. This does not delete the file.
+     */
+    public func remove(_ fileURL: URL) {
+        guard let path = relativePath(for: fileURL) else { return }
+        lockQueue.sync {
+            var entries = self.entries()
+            guard entries.removeValue(forKey: path) != nil else { return }
+            _entries = entries
+            save()
+        }
+    }
+    
+    /**
+     Add any encrypted archives found in the `rootURL` (or in the directories at its top level) that
+     are not in the ledger and remove the entries for the archives that are no longer on disk.
+     */
+    public func refresh() {
+        lockQueue.sync {
+            let fileMan = FileManager.default
+            var found = Set<String>()
+            if fileMan.fileExists(atPath: rootURL.appendingPathComponent(SBAEncryptionHelper.kEncryptedDataFilename).path) {
+                found.insert(SBAEncryptionHelper.kEncryptedDataFilename)
+            }
+            let children = (try? fileMan.contentsOfDirectory(atPath: rootURL.path)) ?? []
+            for child in children {
+                let path = (child as NSString).appendingPathComponent(SBAEncryptionHelper.kEncryptedDataFilename)
+                if fileMan.fileExists(atPath: rootURL.appendingPathComponent(path).path) {
+                    found.insert(path)
+                }
+            }
+            
+            var entries = self.entries()
+            let previous = Set(entries.keys)
+            for path in found.subtracting(previous) {
+                entries[path] = newEntry(path: path, addedOn: nil)
+            }
+            for path in previous.subtracting(found) {
+                entries[path] = nil
+            }
+            guard Set(entries.keys) != previous else { return }
+            _entries = entries
+            save()
+        }
+    }
+    
+    /**
+     Delete the pending archives and empty the ledger. This is called when the participant signs
+     out so that their archives are not uploaded with the next participant's session.
+     */
+    public func removeAll() {
+        refresh()
+        let paths: [String] = lockQueue.sync {
+            let paths = Array(entries().keys)
+            _entries = [:]
+            save()
+            return paths
+        }
+        for path in paths {
+            // Remove the directory that holds the archive unless the archive is at the top level
+            let fileURL = rootURL.appendingPathComponent(path)
+            let url = path.contains("/") ? fileURL.deletingLastPathComponent() : fileURL
+            do {
+                try FileManager.default.removeItem(at: url)
+            } catch let err {
+                debugPrint("Failed to remove \(url): \(err)")
+            }
+        }
+    }
+    
+    /**
+     Refresh the ledger and upload the pending archives that are due to be retried, one at a time
+     and smallest first. Archives that are uploaded are deleted using
+     `SBAEncryptionHelper.cleanUpEncryptedFile()`.
+     
+     @param completion  Called when all the archives have been tried.
+     */
+    public func retryPendingUploads(completion: (() -> Void)? = nil) {
+        refresh()
+        let due: [SBAUploadLedgerEntry]? = lockQueue.sync {
+            guard !_isRetrying else { return nil }
+            let now = Date()
+            let due = sortedEntries(entries().values.filter { nextAttemptDate(for: $0) <= now })
+            _isRetrying = due.count > 0
+            return due
+        }
+        guard let entries = due, entries.count > 0 else {
+            completion?()
+            return
+        }
+        upload(entries[...], completion: completion)
+    }
+    
+    private func upload(_ entries: ArraySlice<SBAUploadLedgerEntry>, completion: (() -> Void)?) {
+        guard let entry = entries.first else {
+            lockQueue.sync { _isRetrying = false }
+            completion?()
+            return
+        }
+        
+        let fileURL = rootURL.appendingPathComponent(entry.path)
+        let startTime = ProcessInfo.processInfo.systemUptime
+        uploader.uploadFile(fileURL) { [weak self] (error) in
+            guard let strongSelf = self else { return }
+            let duration = ProcessInfo.processInfo.systemUptime - startTime
+            strongSelf.didUpload(entry, error: error, duration: duration)
+            if error == nil {
+                SBAEncryptionHelper.cleanUpEncryptedFile(fileURL)
+            }
+            strongSelf.upload(entries.dropFirst(), completion: completion)
+        }
+    }
+    
+    private func didUpload(_ entry: SBAUploadLedgerEntry, error: Error?, duration: TimeInterval) {
+        lockQueue.sync {
+            var entries = self.entries()
+            if let error = error {
+                _metrics.failureCount += 1
+                var failed = entries[entry.path] ?? entry
+                failed.attemptCount += 1
+                failed.lastAttemptOn = Date()
+                failed.lastError = String(describing: error)
+                entries[entry.path] = failed
+            } else {
+                _metrics.uploadCount += 1
+                _metrics.bytesUploaded += entry.fileSize
+                _metrics.uploadDuration += duration
+                entries[entry.path] = nil
+            }
+            _entries = entries
+            save()
+        }
+    }
+    
+    // MARK: Called on the lock queue
+    
+    private func entries() -> [String : SBAUploadLedgerEntry] {
+        if let entries = _entries {
+            return entries
+        }
+        var entries: [String : SBAUploadLedgerEntry] = [:]
+        if let data = try? Data(contentsOf: fileURL) {
+            do {
+                let list = try JSONDecoder().decode([SBAUploadLedgerEntry].self, from: data)
+                for entry in list {
+                    entries[entry.path] = entry
+                }
+            } catch let err {
+                debugPrint("Failed to read the upload ledger: \(err)")
+            }
+        }
+        _entries = entries
+        return entries
+    }
+    
+    private func save() {
+        do {
+            let data = try JSONEncoder().encode(Array((_entries ?? [:]).values))
+            try FileManager.default.createDirectory(at: fileURL.deletingLastPathComponent(), withIntermediateDirectories: true, attributes: nil)
+            try data.write(to: fileURL, options: [.atomic, .completeFileProtectionUntilFirstUserAuthentication])
+        } catch let err {
+            debugPrint("Failed to save the upload ledger: \(err)")
+        }
+    }
+    
+    private func newEntry(path: String, addedOn: Date?) -> SBAUploadLedgerEntry? {
+        guard let attributes = try? FileManager.default.attributesOfItem(atPath: rootURL.appendingPathComponent(path).path)
+            else {
+                return nil
+        }
+        let fileSize = (attributes[.size] as? NSNumber)?.int64Value ?? 0
+        let created = addedOn ?? (attributes[.modificationDate] as? Date) ?? Date()
+        return SBAUploadLedgerEntry(path: path, fileSize: fileSize, addedOn: created)
+    }
+    
+    private func nextAttemptDate(for entry: SBAUploadLedgerEntry) -> Date {
+        guard entry.attemptCount > 0, let lastAttemptOn = entry.lastAttemptOn else {
+            return entry.addedOn.addingTimeInterval(retryAge)
+        }
+        let interval = min(retryInterval * pow(2, Double(entry.attemptCount - 1)), maximumRetryInterval)
+        return lastAttemptOn.addingTimeInterval(interval)
+    }
+    
+    private func sortedEntries<S: Sequence>(_ entries: S) -> [SBAUploadLedgerEntry] where S.Element == SBAUploadLedgerEntry {
+        return entries.sorted(by: { (lhs, rhs) -> Bool in
+            guard lhs.fileSize == rhs.fileSize else { return lhs.fileSize < rhs.fileSize }
+            return lhs.addedOn < rhs.addedOn
+        })
+    }
+    
+    private func relativePath(for fileURL: URL) -> String? {
+        let rootPath = rootURL.path.hasSuffix("/") ? rootURL.path : rootURL.path + "/"
+        let path = fileURL.resolvingSymlinksInPath().path
+        guard path.hasPrefix(rootPath) else { return nil }
+        return String(path.dropFirst(rootPath.count))
+    }
+}
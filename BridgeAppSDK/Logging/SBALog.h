@@ -33,8 +33,42 @@
 // 
  
 #import <Foundation/Foundation.h>
+#import <BridgeAppSDK/SBALogSink.h>
 
 
+// ---------------------------------------------------------
+#pragma mark - Log levels
+// ---------------------------------------------------------
+
+/*
+ Each message is logged at a level. A message is only logged
+ if its level is enabled both at compile time and at runtime.
+
+ The compile-time level defaults to "debug" for DEBUG builds
+ and "error" for release builds.  Define SBA_LOG_COMPILED_LEVEL
+ to change it.  Messages above the compiled level are removed
+ by the compiler.
+
+ The runtime level defaults to the compiled level and can be
+ lowered (or raised back up to the compiled level) by calling
+ +[SBALog setLogLevel:].  The macros below check the runtime
+ level before the method info or the message arguments are
+ evaluated, so a disabled level costs a single comparison.
+ */
+
+#ifndef SBA_LOG_COMPILED_LEVEL
+#if DEBUG
+#define SBA_LOG_COMPILED_LEVEL  SBALogLevelDebug
+#else
+#define SBA_LOG_COMPILED_LEVEL  SBALogLevelError
+#endif
+#endif
+
+/** The current runtime log level.  Call +[SBALog setLogLevel:] to change it. */
+FOUNDATION_EXPORT volatile SBALogLevel SBALogRuntimeLevel;
+
+#define SBALogIsEnabled( level )                        ((level) <= SBA_LOG_COMPILED_LEVEL && (level) <= SBALogRuntimeLevel)
+
 
 @interface SBALog : NSObject
 
@@ -43,7 +77,7 @@
 // ---------------------------------------------------------
 
 /*
- These macros wrap NSLog.
+ These macros replace NSLog.
  
  You can also just call the Objective-C versions yourself.
  The reasons to use the macros are:
@@ -57,24 +91,63 @@
 	defined at the bottom of this file.
  */
 
-#define SBALogError( ... )                              [SBALog methodInfo: SBALogMethodInfo ()  errorMessage: __VA_ARGS__]
-#define SBALogError2( nsErrorObject )                   [SBALog methodInfo: SBALogMethodInfo ()  error: nsErrorObject]
-#define SBALogException( nsException )                  [SBALog methodInfo: SBALogMethodInfo ()  exception: nsException]
-#if DEBUG
-#define SBALogDebug( ... )                              [SBALog methodInfo: SBALogMethodInfo ()  debug: __VA_ARGS__]
-#define SBALogEvent( ... )                              [SBALog methodInfo: SBALogMethodInfo ()  event: __VA_ARGS__]
-#define SBALogEventWithData( name, dictionary )         [SBALog methodInfo: SBALogMethodInfo ()  eventName: name  data: dictionary]
-#define SBALogViewControllerAppeared()                  [SBALog methodInfo: SBALogMethodInfo ()  viewControllerAppeared: self]
-#define SBALogFilenameBeingArchived( filenameOrPath )   [SBALog methodInfo: SBALogMethodInfo ()  filenameBeingArchived: filenameOrPath]
-#define SBALogFilenameBeingUploaded( filenameOrPath )   [SBALog methodInfo: SBALogMethodInfo ()  filenameBeingUploaded: filenameOrPath]
-#else
-#define SBALogDebug( ... )
-#define SBALogEvent( ... )
-#define SBALogEventWithData( name, dictionary )
-#define SBALogViewControllerAppeared()
-#define SBALogFilenameBeingArchived( filenameOrPath )
-#define SBALogFilenameBeingUploaded( filenameOrPath )
-#endif
+#define SBALogIfEnabled( level, statement )             do { if (SBALogIsEnabled (level)) { statement; } } while (0)
+
+#define SBALogError( ... )                              SBALogIfEnabled (SBALogLevelError, [SBALog methodInfo: SBALogMethodInfo ()  errorMessage: __VA_ARGS__])
+#define SBALogError2( nsErrorObject )                   SBALogIfEnabled (SBALogLevelError, [SBALog methodInfo: SBALogMethodInfo ()  error: nsErrorObject])
+#define SBALogException( nsException )                  SBALogIfEnabled (SBALogLevelError, [SBALog methodInfo: SBALogMethodInfo ()  exception: nsException])
+#define SBALogDebug( ... )                              SBALogIfEnabled (SBALogLevelDebug, [SBALog methodInfo: SBALogMethodInfo ()  debug: __VA_ARGS__])
+#define SBALogEvent( ... )                              SBALogIfEnabled (SBALogLevelInfo,  [SBALog methodInfo: SBALogMethodInfo ()  event: __VA_ARGS__])
+#define SBALogEventWithData( name, dictionary )         SBALogIfEnabled (SBALogLevelInfo,  [SBALog methodInfo: SBALogMethodInfo ()  eventName: name  data: dictionary])
+#define SBALogViewControllerAppeared()                  SBALogIfEnabled (SBALogLevelInfo,  [SBALog methodInfo: SBALogMethodInfo ()  viewControllerAppeared: self])
+#define SBALogFilenameBeingArchived( filenameOrPath )   SBALogIfEnabled (SBALogLevelInfo,  [SBALog methodInfo: SBALogMethodInfo ()  filenameBeingArchived: filenameOrPath])
+#define SBALogFilenameBeingUploaded( filenameOrPath )   SBALogIfEnabled (SBALogLevelInfo,  [SBALog methodInfo: SBALogMethodInfo ()  filenameBeingUploaded: filenameOrPath])
+
+
+
+// ---------------------------------------------------------
+#pragma mark - Log pipeline
+// ---------------------------------------------------------
+
+/*
+ Messages are not written on the calling thread.  Each message
+ is added to a fixed-size, lock-free ring buffer and a background
+ writer drains the buffer and passes the entries to each sink.
+ If the buffer is full, the message is dropped (and counted)
+ rather than blocking the caller.
+
+ Expensive descriptions, such as the friendly description of an
+ NSError, are built by the writer rather than by the caller.
+
+ By default, the only sink is an SBALogConsoleSink.  Add an
+ SBALogFileSink to also write the messages to a rotating set
+ of files.
+ */
+
+/** The runtime log level.  This cannot be set higher than SBA_LOG_COMPILED_LEVEL. */
+@property (class, nonatomic) SBALogLevel logLevel;
+
+/** Whether or not messages at the given level are logged. */
++ (BOOL) isLevelEnabled: (SBALogLevel) level;
+
+/** Add a sink.  Entries logged after this call are written to the sink. */
++ (void) addSink: (id <SBALogSink>) sink;
+
+/** Remove a sink. */
++ (void) removeSink: (id <SBALogSink>) sink;
+
+/** Remove all the sinks, including the default console sink. */
++ (void) removeAllSinks;
+
+/** The number of messages that were dropped because the buffer was full. */
++ (NSUInteger) droppedEntryCount;
+
+/**
+ Block until all the messages logged before this call have been
+ written to the sinks and then flush each sink.  Do not call this
+ from a sink.
+ */
++ (void) flush;
 
 
 
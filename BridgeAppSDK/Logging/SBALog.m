@@ -33,20 +33,34 @@
 // 
  
 #import "SBALog.h"
+#import "SBALogRingBuffer.h"
+#import <stdatomic.h>
 //#import "SBAConstants.h"
 //#import "SBAUtilities.h"
 //#import "NSError+SBAAdditions.h"
 
 
-static NSDateFormatter *dateFormatter = nil;
 static NSString * const kErrorIndentationString = @"    ";
 
 
-/**
- Apple says they use these formatting codes:
- http://www.unicode.org/reports/tr35/tr35-31/tr35-dates.html#Date_Format_Patterns
+volatile SBALogLevel SBALogRuntimeLevel = SBA_LOG_COMPILED_LEVEL;
+
+
+// ---------------------------------------------------------
+#pragma mark - Pipeline state
+// ---------------------------------------------------------
+
+/*
+ The ring buffer is written by any thread.  Everything else
+ is only touched on the log queue.
  */
-static NSString *LOG_DATE_FORMAT = @"yyyy-MM-dd HH:mm:ss.SSS ZZZZ";
+static NSUInteger const kLogBufferCapacity = 2048;
+static SBALogRingBuffer *logBuffer = nil;
+static dispatch_queue_t logQueue = nil;
+static dispatch_source_t logSource = nil;
+static NSMutableArray <id <SBALogSink>> *logSinks = nil;
+static atomic_ulong droppedEntryCount = 0;
+static atomic_ulong unreportedDroppedEntryCount = 0;
 
 
 // ---------------------------------------------------------
@@ -93,11 +107,82 @@ static NSString * const SBALogTagUpload  = @"SBA_UPLOAD ";
  */
 + (void) initialize
 {
-	if (dateFormatter == nil)
-	{
-		dateFormatter = [NSDateFormatter new];
-		dateFormatter.dateFormat = LOG_DATE_FORMAT;
-	}
+	static dispatch_once_t onceToken;
+	dispatch_once (&onceToken, ^{
+		logBuffer = [[SBALogRingBuffer alloc] initWithCapacity: kLogBufferCapacity];
+		logSinks = [NSMutableArray arrayWithObject: [SBALogConsoleSink new]];
+		logQueue = dispatch_queue_create ("org.sagebase.BridgeAppSDK.SBALog", DISPATCH_QUEUE_SERIAL);
+		dispatch_set_target_queue (logQueue, dispatch_get_global_queue (QOS_CLASS_UTILITY, 0));
+
+		// Coalesce the wakeups so that the writer drains the buffer once per burst of messages
+		logSource = dispatch_source_create (DISPATCH_SOURCE_TYPE_DATA_ADD, 0, 0, logQueue);
+		dispatch_source_set_event_handler (logSource, ^{
+			[SBALog drainBuffer];
+		});
+		dispatch_resume (logSource);
+	});
+}
+
+
+
+// ---------------------------------------------------------
+#pragma mark - Levels and sinks
+// ---------------------------------------------------------
+
++ (SBALogLevel) logLevel
+{
+	return SBALogRuntimeLevel;
+}
+
++ (void) setLogLevel: (SBALogLevel) logLevel
+{
+	SBALogRuntimeLevel = MIN (logLevel, SBA_LOG_COMPILED_LEVEL);
+	atomic_thread_fence (memory_order_release);
+}
+
++ (BOOL) isLevelEnabled: (SBALogLevel) level
+{
+	return SBALogIsEnabled (level);
+}
+
++ (void) addSink: (id <SBALogSink>) sink
+{
+	dispatch_async (logQueue, ^{
+		[logSinks addObject: sink];
+	});
+}
+
++ (void) removeSink: (id <SBALogSink>) sink
+{
+	dispatch_async (logQueue, ^{
+		[logSinks removeObject: sink];
+	});
+}
+
++ (void) removeAllSinks
+{
+	dispatch_async (logQueue, ^{
+		[logSinks removeAllObjects];
+	});
+}
+
++ (NSUInteger) droppedEntryCount
+{
+	return atomic_load (&droppedEntryCount);
+}
+
++ (void) flush
+{
+	dispatch_sync (logQueue, ^{
+		[self drainBuffer];
+		for (id <SBALogSink> sink in logSinks)
+		{
+			if ([sink respondsToSelector: @selector (flush)])
+			{
+				[sink flush];
+			}
+		}
+	});
 }
 
 // ---------------------------------------------------------
@@ -107,6 +192,11 @@ static NSString * const SBALogTagUpload  = @"SBA_UPLOAD ";
 + (void) methodInfo: (NSString *) sbaLogMethodInfo
 	   errorMessage: (NSString *) formatString, ...
 {
+	if (!SBALogIsEnabled (SBALogLevelError))
+	{
+		return;
+	}
+
 	if (formatString == nil)
 	{
 		formatString = @"(no message)";
@@ -114,41 +204,49 @@ static NSString * const SBALogTagUpload  = @"SBA_UPLOAD ";
 
 	NSString *formattedMessage = NSStringFromVariadicArgumentsAndFormat(formatString);
 
-	[self logInternal_tag: SBALogTagError
-				   method: sbaLogMethodInfo
-				  message: formattedMessage];
+	[self logInternal_level: SBALogLevelError
+						tag: SBALogTagError
+					 method: sbaLogMethodInfo
+					message: formattedMessage];
 }
 
 + (void) methodInfo: (NSString *) sbaLogMethodData
 			  error: (NSError *) error
 {
-	if (error != nil)
+	if (error != nil && SBALogIsEnabled (SBALogLevelError))
 	{
-        // Note:  this is expensive.
-        NSString *description = error.friendlyFormattedString;
-
-		[self logInternal_tag: SBALogTagError
-					   method: sbaLogMethodData
-					  message: description];
+        // Note:  this is expensive, so it is built by the log writer.
+		[self logInternal_level: SBALogLevelError
+							tag: SBALogTagError
+						 method: sbaLogMethodData
+				   messageBlock: ^NSString *{
+					   return error.friendlyFormattedString;
+				   }];
 	}
 }
 
 + (void) methodInfo: (NSString *) sbaLogMethodData
 		  exception: (NSException *) exception
 {
-	if (exception != nil)
+	if (exception != nil && SBALogIsEnabled (SBALogLevelError))
 	{
-		NSString *printout = [NSString stringWithFormat: @"EXCEPTION: [%@]. Stack trace:\n%@", exception, exception.callStackSymbols];
-
-		[self logInternal_tag: SBALogTagError
-					   method: sbaLogMethodData
-					  message: printout];
+		[self logInternal_level: SBALogLevelError
+							tag: SBALogTagError
+						 method: sbaLogMethodData
+				   messageBlock: ^NSString *{
+					   return [NSString stringWithFormat: @"EXCEPTION: [%@]. Stack trace:\n%@", exception, exception.callStackSymbols];
+				   }];
 	}
 }
 
 + (void) methodInfo: (NSString *) sbaLogMethodData
 			  debug: (NSString *) formatString, ...
 {
+	if (!SBALogIsEnabled (SBALogLevelDebug))
+	{
+		return;
+	}
+
 	if (formatString == nil)
 	{
 		formatString = @"(no message)";
@@ -156,34 +254,54 @@ static NSString * const SBALogTagUpload  = @"SBA_UPLOAD ";
 
 	NSString *formattedMessage = NSStringFromVariadicArgumentsAndFormat(formatString);
 
-	[self logInternal_tag: SBALogTagDebug
-				   method: sbaLogMethodData
-				  message: formattedMessage];
+	[self logInternal_level: SBALogLevelDebug
+						tag: SBALogTagDebug
+					 method: sbaLogMethodData
+					message: formattedMessage];
 }
 
 + (void)       methodInfo: (NSString *) sbaLogMethodInfo
     filenameBeingArchived: (NSString *) filenameOrPath
 {
-    NSString *message = [NSString stringWithFormat: @"Adding file to .zip archive for uploading: [%@]", filenameOrPath];
+    if (!SBALogIsEnabled (SBALogLevelInfo))
+    {
+        return;
+    }
 
-    [self logInternal_tag: SBALogTagArchive
-                   method: sbaLogMethodInfo
-                  message: message];
+    NSString *filename = [filenameOrPath copy];
+    [self logInternal_level: SBALogLevelInfo
+                        tag: SBALogTagArchive
+                     method: sbaLogMethodInfo
+               messageBlock: ^NSString *{
+                   return [NSString stringWithFormat: @"Adding file to .zip archive for uploading: [%@]", filename];
+               }];
 }
 
 + (void)       methodInfo: (NSString *) sbaLogMethodInfo
     filenameBeingUploaded: (NSString *) filenameOrPath
 {
-    NSString *message = [NSString stringWithFormat: @"Uploading file to Sage: [%@]", filenameOrPath];
+    if (!SBALogIsEnabled (SBALogLevelInfo))
+    {
+        return;
+    }
 
-    [self logInternal_tag: SBALogTagUpload
-                   method: sbaLogMethodInfo
-                  message: message];
+    NSString *filename = [filenameOrPath copy];
+    [self logInternal_level: SBALogLevelInfo
+                        tag: SBALogTagUpload
+                     method: sbaLogMethodInfo
+               messageBlock: ^NSString *{
+                   return [NSString stringWithFormat: @"Uploading file to Sage: [%@]", filename];
+               }];
 }
 
 + (void) methodInfo: (NSString *) sbaLogMethodData
 			  event: (NSString *) formatString, ...
 {
+	if (!SBALogIsEnabled (SBALogLevelInfo))
+	{
+		return;
+	}
+
 	if (formatString == nil)
 	{
 		formatString = @"(no message)";
@@ -191,30 +309,44 @@ static NSString * const SBALogTagUpload  = @"SBA_UPLOAD ";
 
 	NSString *formattedMessage = NSStringFromVariadicArgumentsAndFormat(formatString);
 
-	[self logInternal_tag: SBALogTagEvent
-				   method: sbaLogMethodData
-				  message: formattedMessage];
+	[self logInternal_level: SBALogLevelInfo
+						tag: SBALogTagEvent
+					 method: sbaLogMethodData
+					message: formattedMessage];
 }
 
 + (void) methodInfo: (NSString *) sbaLogMethodData
 		  eventName: (NSString *) eventName
 			   data: (NSDictionary *) eventDictionary
 {
-	NSString *message = [NSString stringWithFormat: @"%@: %@", eventName, eventDictionary];
+	if (!SBALogIsEnabled (SBALogLevelInfo))
+	{
+		return;
+	}
 
-	[self logInternal_tag: SBALogTagData
-				   method: sbaLogMethodData
-				  message: message];
+	// The dictionary is kept as structured data and is only formatted by the text sinks
+	[self logEntry: [[SBALogEntry alloc] initWithLevel: SBALogLevelInfo
+												   tag: SBALogTagData
+											methodInfo: sbaLogMethodData
+											   message: eventName ?: @""
+												  data: eventDictionary]];
 }
 
 + (void)        methodInfo: (NSString *) sbaLogMethodData
 	viewControllerAppeared: (NSObject *) viewController
 {
-	NSString *message = [NSString stringWithFormat: @"%@ appeared.", NSStringFromClass (viewController.class)];
+	if (!SBALogIsEnabled (SBALogLevelInfo))
+	{
+		return;
+	}
 
-	[self logInternal_tag: SBALogTagView
-				   method: sbaLogMethodData
-				  message: message];
+	NSString *className = NSStringFromClass (viewController.class);
+	[self logInternal_level: SBALogLevelInfo
+						tag: SBALogTagView
+					 method: sbaLogMethodData
+			   messageBlock: ^NSString *{
+				   return [NSString stringWithFormat: @"%@ appeared.", className];
+			   }];
 }
 
 
@@ -223,19 +355,73 @@ static NSString * const SBALogTagUpload  = @"SBA_UPLOAD ";
 #pragma mark - The centralized, internal logging method
 // ---------------------------------------------------------
 
-+ (void) logInternal_tag: (NSString *) tag
-				  method: (NSString *) methodInfo
-				 message: (NSString *) message
++ (void) logInternal_level: (SBALogLevel) level
+					   tag: (NSString *) tag
+					method: (NSString *) methodInfo
+				   message: (NSString *) message
+{
+	[self logEntry: [[SBALogEntry alloc] initWithLevel: level
+												   tag: tag
+											methodInfo: methodInfo
+											   message: message]];
+}
+
++ (void) logInternal_level: (SBALogLevel) level
+					   tag: (NSString *) tag
+					method: (NSString *) methodInfo
+			  messageBlock: (NSString * (^)(void)) messageBlock
+{
+	[self logEntry: [[SBALogEntry alloc] initWithLevel: level
+												   tag: tag
+											methodInfo: methodInfo
+										  messageBlock: messageBlock]];
+}
+
++ (void) logEntry: (SBALogEntry *) entry
 {
 	/*
-	 Objective-C disables all NSLog() statements in
-	 a "release" build, so this is safe to leave as-is.
+	 This is called on the logging thread, so it must not
+	 block.  If the buffer is full, the entry is dropped and
+	 the writer reports how many entries were dropped.
 	 */
-    
-    // Although the above statement is not in fact true, this wouldn't be the right place
-    // to handle it anyway, as error- and exception-level log messages are still useful
-    // in release builds.
-	NSLog (@"%@ %@ => %@", tag, methodInfo, message);
+	if ([logBuffer enqueue: entry])
+	{
+		dispatch_source_merge_data (logSource, 1);
+	}
+	else
+	{
+		atomic_fetch_add (&droppedEntryCount, 1);
+		atomic_fetch_add (&unreportedDroppedEntryCount, 1);
+	}
+}
+
+/** Called on the log queue. */
++ (void) drainBuffer
+{
+	SBALogEntry *entry = nil;
+	while ((entry = [logBuffer dequeue]) != nil)
+	{
+		[self writeEntry: entry];
+	}
+
+	unsigned long dropped = atomic_exchange (&unreportedDroppedEntryCount, 0);
+	if (dropped > 0)
+	{
+		NSString *message = [NSString stringWithFormat: @"Dropped %lu log messages because the log buffer was full.", dropped];
+		[self writeEntry: [[SBALogEntry alloc] initWithLevel: SBALogLevelError
+														 tag: SBALogTagError
+												  methodInfo: SBALogMethodInfo ()
+													 message: message]];
+	}
+}
+
+/** Called on the log queue. */
++ (void) writeEntry: (SBALogEntry *) entry
+{
+	for (id <SBALogSink> sink in logSinks)
+	{
+		[sink writeEntry: entry];
+	}
 }
 
 @end
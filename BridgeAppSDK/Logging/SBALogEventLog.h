@@ -0,0 +1,117 @@
+//
+//  SBALogEventLog.h
+//  BridgeAppSDK
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+#import <Foundation/Foundation.h>
+#import <BridgeAppSDK/SBALogSink.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ `SBALogEventSink` writes the log entries to a compact, append-only binary file. Each record holds the
+ level, timestamp, tag, method info, message and the typed key/values from the entry's `data`.
+
+ The log is bounded. When the current file is larger than half of `maximumSize`, it replaces the
+ previous file and a new file is started, so the log never uses more than `maximumSize` bytes.
+
+ Tags are stored without the padding used to align the console output, for example `SBA_UPLOAD`.
+
+ Use `SBALogEventReader` to query or export the events.
+ */
+@interface SBALogEventSink : NSObject <SBALogSink>
+
+@property (nonatomic, readonly) NSURL *directoryURL;
+@property (nonatomic, readonly) unsigned long long maximumSize;
+
+/**
+ If set, only entries with one of these tags are recorded. Default = `nil` (all tags).
+ */
+@property (nonatomic, copy, nullable) NSSet<NSString *> *tags;
+
+/**
+ Create an event sink with a maximum size of 1 MB.
+ */
+- (instancetype)initWithDirectoryURL:(NSURL *)directoryURL;
+
+- (instancetype)initWithDirectoryURL:(NSURL *)directoryURL maximumSize:(unsigned long long)maximumSize NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+/**
+ `SBALogEventReader` reads the events written by an `SBALogEventSink`. Records that do not match the
+ tag and time range are skipped without decoding their data.
+ */
+@interface SBALogEventReader : NSObject
+
+/**
+ The event files, ordered from oldest to newest.
+ */
+@property (nonatomic, readonly) NSArray<NSURL *> *eventFileURLs;
+
+- (instancetype)initWithDirectoryURL:(NSURL *)directoryURL NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Enumerate the events in the order that they were logged.
+ @param tags        The tags to include, or `nil` for all tags.
+ @param startDate   The earliest event to include, or `nil`.
+ @param endDate     The latest event to include, or `nil`.
+ @param block       Called for each matching event. Set `stop` to `YES` to stop the enumeration.
+ */
+- (void)enumerateEntriesWithTags:(nullable NSSet<NSString *> *)tags
+                       startDate:(nullable NSDate *)startDate
+                         endDate:(nullable NSDate *)endDate
+                      usingBlock:(void (NS_NOESCAPE ^)(SBALogEntry *entry, BOOL *stop))block NS_SWIFT_NAME(enumerateEntries(withTags:startDate:endDate:using:));
+
+/**
+ The matching events in the order that they were logged.
+ */
+- (NSArray<SBALogEntry *> *)entriesWithTags:(nullable NSSet<NSString *> *)tags
+                                  startDate:(nullable NSDate *)startDate
+                                    endDate:(nullable NSDate *)endDate NS_SWIFT_NAME(entries(withTags:startDate:endDate:));
+
+/**
+ Export the matching events as a JSON array. Each event is a dictionary with the keys `timestamp`
+ (ISO 8601), `level`, `tag`, `method`, `message` and, if the event has data, `data`.
+ */
+- (nullable NSData *)JSONDataWithTags:(nullable NSSet<NSString *> *)tags
+                            startDate:(nullable NSDate *)startDate
+                              endDate:(nullable NSDate *)endDate
+                                error:(NSError * _Nullable *)error NS_SWIFT_NAME(jsonData(withTags:startDate:endDate:));
+
+@end
+
+NS_ASSUME_NONNULL_END
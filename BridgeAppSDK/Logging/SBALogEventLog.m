@@ -0,0 +1,633 @@
+//
+//  SBALogEventLog.m
+//  BridgeAppSDK
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+#import "SBALogEventLog.h"
+
+/*
+ File layout (all integers are little-endian):
+
+    header:  "SBAE" | uint8 version | 3 bytes reserved
+    record:  uint32 body length | body
+
+    body:    float64 timestamp (since the reference date) | uint8 level
+             | str8 tag | str16 method | str32 message
+             | uint16 value count | { str16 key | uint8 type | value } ...
+
+ The timestamp, level and tag come first so that the reader can filter
+ the records without decoding the rest of the body. A partial record at
+ the end of a file (for example, if the app was killed mid-write) is
+ ignored by the reader and is removed by the sink before it appends to
+ the file.
+ */
+
+static NSString * const kEventFileName      = @"SBAEvents";
+static NSString * const kEventFileExtension = @"bin";
+static const char kEventFileMagic[4]        = { 'S', 'B', 'A', 'E' };
+static const uint8_t kEventFileVersion      = 1;
+static const NSUInteger kEventFileHeaderLength = 8;
+
+typedef NS_ENUM(uint8_t, SBALogEventValueType) {
+    SBALogEventValueTypeNull = 0,
+    SBALogEventValueTypeBool,
+    SBALogEventValueTypeInteger,
+    SBALogEventValueTypeDouble,
+    SBALogEventValueTypeString,
+    SBALogEventValueTypeDate,
+    SBALogEventValueTypeData,
+    SBALogEventValueTypeJSON,
+};
+
+static NSURL *SBALogEventFileURL(NSURL *directoryURL, NSUInteger index)
+{
+    NSString *filename = (index == 0) ? kEventFileName : [NSString stringWithFormat:@"%@.%@", kEventFileName, @(index)];
+    return [[directoryURL URLByAppendingPathComponent:filename] URLByAppendingPathExtension:kEventFileExtension];
+}
+
+static NSString *SBALogEventTrimmedTag(NSString *tag)
+{
+    return [tag stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+}
+
+static NSSet<NSString *> *SBALogEventTrimmedTags(NSSet<NSString *> *tags)
+{
+    if (tags == nil) {
+        return nil;
+    }
+    NSMutableSet *trimmed = [NSMutableSet setWithCapacity:tags.count];
+    for (NSString *tag in tags) {
+        [trimmed addObject:SBALogEventTrimmedTag(tag)];
+    }
+    return trimmed;
+}
+
+
+// ---------------------------------------------------------
+#pragma mark - Encoding
+// ---------------------------------------------------------
+
+static void SBALogEventAppendUInt8(NSMutableData *data, uint8_t value)
+{
+    [data appendBytes:&value length:sizeof(value)];
+}
+
+static void SBALogEventAppendUInt16(NSMutableData *data, uint16_t value)
+{
+    value = CFSwapInt16HostToLittle(value);
+    [data appendBytes:&value length:sizeof(value)];
+}
+
+static void SBALogEventAppendUInt32(NSMutableData *data, uint32_t value)
+{
+    value = CFSwapInt32HostToLittle(value);
+    [data appendBytes:&value length:sizeof(value)];
+}
+
+static void SBALogEventAppendUInt64(NSMutableData *data, uint64_t value)
+{
+    value = CFSwapInt64HostToLittle(value);
+    [data appendBytes:&value length:sizeof(value)];
+}
+
+static void SBALogEventAppendDouble(NSMutableData *data, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    SBALogEventAppendUInt64(data, bits);
+}
+
+static void SBALogEventAppendBytes(NSMutableData *data, NSData *bytes, uint8_t lengthSize)
+{
+    uint64_t maxLength = (lengthSize == 1) ? UINT8_MAX : (lengthSize == 2) ? UINT16_MAX : UINT32_MAX;
+    NSUInteger length = (NSUInteger)MIN((uint64_t)bytes.length, maxLength);
+    switch (lengthSize) {
+        case 1: SBALogEventAppendUInt8(data, (uint8_t)length); break;
+        case 2: SBALogEventAppendUInt16(data, (uint16_t)length); break;
+        default: SBALogEventAppendUInt32(data, (uint32_t)length); break;
+    }
+    [data appendBytes:bytes.bytes length:length];
+}
+
+static void SBALogEventAppendString(NSMutableData *data, NSString *string, uint8_t lengthSize)
+{
+    // Strings that are too long are truncated at a character boundary
+    NSData *bytes = [string ?: @"" dataUsingEncoding:NSUTF8StringEncoding];
+    uint64_t maxLength = (lengthSize == 1) ? UINT8_MAX : (lengthSize == 2) ? UINT16_MAX : UINT32_MAX;
+    if (bytes.length > maxLength) {
+        NSUInteger length = (NSUInteger)maxLength;
+        const uint8_t *utf8 = bytes.bytes;
+        while (length > 0 && (utf8[length] & 0xC0) == 0x80) {
+            length--;
+        }
+        bytes = [bytes subdataWithRange:NSMakeRange(0, length)];
+    }
+    SBALogEventAppendBytes(data, bytes, lengthSize);
+}
+
+static void SBALogEventAppendValue(NSMutableData *data, id value)
+{
+    if (value == nil || value == [NSNull null]) {
+        SBALogEventAppendUInt8(data, SBALogEventValueTypeNull);
+    }
+    else if ([value isKindOfClass:[NSNumber class]]) {
+        NSNumber *number = value;
+        if (CFGetTypeID((__bridge CFTypeRef)number) == CFBooleanGetTypeID()) {
+            SBALogEventAppendUInt8(data, SBALogEventValueTypeBool);
+            SBALogEventAppendUInt8(data, number.boolValue ? 1 : 0);
+        }
+        else if (CFNumberIsFloatType((__bridge CFNumberRef)number)) {
+            SBALogEventAppendUInt8(data, SBALogEventValueTypeDouble);
+            SBALogEventAppendDouble(data, number.doubleValue);
+        }
+        else {
+            SBALogEventAppendUInt8(data, SBALogEventValueTypeInteger);
+            SBALogEventAppendUInt64(data, (uint64_t)number.longLongValue);
+        }
+    }
+    else if ([value isKindOfClass:[NSString class]]) {
+        SBALogEventAppendUInt8(data, SBALogEventValueTypeString);
+        SBALogEventAppendString(data, value, 4);
+    }
+    else if ([value isKindOfClass:[NSDate class]]) {
+        SBALogEventAppendUInt8(data, SBALogEventValueTypeDate);
+        SBALogEventAppendDouble(data, [(NSDate *)value timeIntervalSinceReferenceDate]);
+    }
+    else if ([value isKindOfClass:[NSData class]]) {
+        SBALogEventAppendUInt8(data, SBALogEventValueTypeData);
+        SBALogEventAppendBytes(data, value, 4);
+    }
+    else if (([value isKindOfClass:[NSArray class]] || [value isKindOfClass:[NSDictionary class]]) &&
+             [NSJSONSerialization isValidJSONObject:value]) {
+        SBALogEventAppendUInt8(data, SBALogEventValueTypeJSON);
+        SBALogEventAppendBytes(data, [NSJSONSerialization dataWithJSONObject:value options:0 error:nil], 4);
+    }
+    else {
+        SBALogEventAppendUInt8(data, SBALogEventValueTypeString);
+        SBALogEventAppendString(data, [value description], 4);
+    }
+}
+
+static NSData *SBALogEventRecord(SBALogEntry *entry, NSString *tag)
+{
+    NSMutableData *body = [NSMutableData dataWithCapacity:128];
+    SBALogEventAppendDouble(body, entry.timestamp);
+    SBALogEventAppendUInt8(body, (uint8_t)entry.level);
+    SBALogEventAppendString(body, tag, 1);
+    SBALogEventAppendString(body, entry.methodInfo, 2);
+    SBALogEventAppendString(body, entry.message, 4);
+    
+    NSDictionary *values = entry.data;
+    NSUInteger count = MIN(values.count, (NSUInteger)UINT16_MAX);
+    SBALogEventAppendUInt16(body, (uint16_t)count);
+    NSUInteger index = 0;
+    for (id key in values) {
+        if (index++ >= count) {
+            break;
+        }
+        SBALogEventAppendString(body, [key description], 2);
+        SBALogEventAppendValue(body, values[key]);
+    }
+    
+    NSMutableData *record = [NSMutableData dataWithCapacity:body.length + sizeof(uint32_t)];
+    SBALogEventAppendUInt32(record, (uint32_t)body.length);
+    [record appendData:body];
+    return record;
+}
+
+
+// ---------------------------------------------------------
+#pragma mark - Decoding
+// ---------------------------------------------------------
+
+typedef struct {
+    const uint8_t *bytes;
+    NSUInteger length;
+    NSUInteger offset;
+    BOOL failed;
+} SBALogEventCursor;
+
+static const uint8_t *SBALogEventRead(SBALogEventCursor *cursor, NSUInteger length)
+{
+    if (cursor->failed || length > cursor->length - cursor->offset) {
+        cursor->failed = YES;
+        return NULL;
+    }
+    const uint8_t *bytes = cursor->bytes + cursor->offset;
+    cursor->offset += length;
+    return bytes;
+}
+
+static uint8_t SBALogEventReadUInt8(SBALogEventCursor *cursor)
+{
+    const uint8_t *bytes = SBALogEventRead(cursor, 1);
+    return bytes ? bytes[0] : 0;
+}
+
+static uint16_t SBALogEventReadUInt16(SBALogEventCursor *cursor)
+{
+    uint16_t value = 0;
+    const uint8_t *bytes = SBALogEventRead(cursor, sizeof(value));
+    if (bytes) {
+        memcpy(&value, bytes, sizeof(value));
+    }
+    return CFSwapInt16LittleToHost(value);
+}
+
+static uint32_t SBALogEventReadUInt32(SBALogEventCursor *cursor)
+{
+    uint32_t value = 0;
+    const uint8_t *bytes = SBALogEventRead(cursor, sizeof(value));
+    if (bytes) {
+        memcpy(&value, bytes, sizeof(value));
+    }
+    return CFSwapInt32LittleToHost(value);
+}
+
+static uint64_t SBALogEventReadUInt64(SBALogEventCursor *cursor)
+{
+    uint64_t value = 0;
+    const uint8_t *bytes = SBALogEventRead(cursor, sizeof(value));
+    if (bytes) {
+        memcpy(&value, bytes, sizeof(value));
+    }
+    return CFSwapInt64LittleToHost(value);
+}
+
+static double SBALogEventReadDouble(SBALogEventCursor *cursor)
+{
+    uint64_t bits = SBALogEventReadUInt64(cursor);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static NSData *SBALogEventReadBytes(SBALogEventCursor *cursor, uint8_t lengthSize)
+{
+    NSUInteger length = (lengthSize == 1) ? SBALogEventReadUInt8(cursor) : (lengthSize == 2) ? SBALogEventReadUInt16(cursor) : SBALogEventReadUInt32(cursor);
+    const uint8_t *bytes = SBALogEventRead(cursor, length);
+    return bytes ? [NSData dataWithBytes:bytes length:length] : nil;
+}
+
+static NSString *SBALogEventReadString(SBALogEventCursor *cursor, uint8_t lengthSize)
+{
+    NSUInteger length = (lengthSize == 1) ? SBALogEventReadUInt8(cursor) : (lengthSize == 2) ? SBALogEventReadUInt16(cursor) : SBALogEventReadUInt32(cursor);
+    const uint8_t *bytes = SBALogEventRead(cursor, length);
+    if (bytes == NULL) {
+        return nil;
+    }
+    return [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding] ?: @"";
+}
+
+static id SBALogEventReadValue(SBALogEventCursor *cursor)
+{
+    switch ((SBALogEventValueType)SBALogEventReadUInt8(cursor)) {
+        case SBALogEventValueTypeNull:
+            return [NSNull null];
+        case SBALogEventValueTypeBool:
+            return @(SBALogEventReadUInt8(cursor) != 0);
+        case SBALogEventValueTypeInteger:
+            return @((int64_t)SBALogEventReadUInt64(cursor));
+        case SBALogEventValueTypeDouble:
+            return @(SBALogEventReadDouble(cursor));
+        case SBALogEventValueTypeString:
+            return SBALogEventReadString(cursor, 4);
+        case SBALogEventValueTypeDate:
+            return [NSDate dateWithTimeIntervalSinceReferenceDate:SBALogEventReadDouble(cursor)];
+        case SBALogEventValueTypeData:
+            return SBALogEventReadBytes(cursor, 4);
+        case SBALogEventValueTypeJSON: {
+            NSData *json = SBALogEventReadBytes(cursor, 4);
+            return json ? [NSJSONSerialization JSONObjectWithData:json options:0 error:nil] : nil;
+        }
+    }
+    cursor->failed = YES;
+    return nil;
+}
+
+static BOOL SBALogEventIsValidFile(NSData *fileData)
+{
+    return fileData.length >= kEventFileHeaderLength &&
+        memcmp(fileData.bytes, kEventFileMagic, sizeof(kEventFileMagic)) == 0 &&
+        ((const uint8_t *)fileData.bytes)[sizeof(kEventFileMagic)] == kEventFileVersion;
+}
+
+/**
+ Returns the length of the file up to the end of the last complete record, or 0 if the file does
+ not have a valid header.
+ */
+static unsigned long long SBALogEventCompleteFileLength(NSURL *url)
+{
+    NSData *fileData = [NSData dataWithContentsOfURL:url options:NSDataReadingMappedIfSafe error:nil];
+    if (!SBALogEventIsValidFile(fileData)) {
+        return 0;
+    }
+    SBALogEventCursor file = { fileData.bytes, fileData.length, kEventFileHeaderLength, NO };
+    NSUInteger completeLength = file.offset;
+    while (file.offset < file.length) {
+        uint32_t bodyLength = SBALogEventReadUInt32(&file);
+        if (SBALogEventRead(&file, bodyLength) == NULL) {
+            break;
+        }
+        completeLength = file.offset;
+    }
+    return completeLength;
+}
+
+
+// ---------------------------------------------------------
+#pragma mark - SBALogEventSink
+// ---------------------------------------------------------
+
+@interface SBALogEventSink ()
+
+@property (nonatomic, strong) NSFileHandle *fileHandle;
+@property (nonatomic) unsigned long long currentFileSize;
+
+@end
+
+@implementation SBALogEventSink
+
+- (instancetype)initWithDirectoryURL:(NSURL *)directoryURL
+{
+    return [self initWithDirectoryURL:directoryURL maximumSize:1024 * 1024];
+}
+
+- (instancetype)initWithDirectoryURL:(NSURL *)directoryURL maximumSize:(unsigned long long)maximumSize
+{
+    self = [super init];
+    if (self) {
+        _directoryURL = [directoryURL copy];
+        _maximumSize = MAX(maximumSize, 2 * kEventFileHeaderLength);
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [_fileHandle closeFile];
+}
+
+- (void)setTags:(NSSet<NSString *> *)tags
+{
+    _tags = [SBALogEventTrimmedTags(tags) copy];
+}
+
+- (NSFileHandle *)openFileHandle
+{
+    if (self.fileHandle == nil) {
+        NSFileManager *fileManager = [NSFileManager defaultManager];
+        [fileManager createDirectoryAtURL:self.directoryURL withIntermediateDirectories:YES attributes:nil error:nil];
+        NSURL *url = SBALogEventFileURL(self.directoryURL, 0);
+        unsigned long long completeLength = [fileManager fileExistsAtPath:url.path] ? SBALogEventCompleteFileLength(url) : 0;
+        if (completeLength == 0) {
+            // Create the file (or replace a file that does not have a valid header)
+            NSMutableData *header = [NSMutableData dataWithBytes:kEventFileMagic length:sizeof(kEventFileMagic)];
+            SBALogEventAppendUInt8(header, kEventFileVersion);
+            [header increaseLengthBy:kEventFileHeaderLength - header.length];
+            [fileManager createFileAtPath:url.path contents:header attributes:@{NSFileProtectionKey : NSFileProtectionCompleteUntilFirstUserAuthentication}];
+        }
+        self.fileHandle = [NSFileHandle fileHandleForWritingToURL:url error:nil];
+        unsigned long long fileSize = [self.fileHandle seekToEndOfFile];
+        if (completeLength > 0 && completeLength < fileSize) {
+            // Remove a partial record left at the end of the file so that the new records are
+            // not read as part of it
+            [self.fileHandle truncateFileAtOffset:completeLength];
+            fileSize = completeLength;
+        }
+        self.currentFileSize = fileSize;
+    }
+    return self.fileHandle;
+}
+
+- (void)rotateFiles
+{
+    [self.fileHandle closeFile];
+    self.fileHandle = nil;
+    
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSURL *previousURL = SBALogEventFileURL(self.directoryURL, 1);
+    [fileManager removeItemAtURL:previousURL error:nil];
+    [fileManager moveItemAtURL:SBALogEventFileURL(self.directoryURL, 0) toURL:previousURL error:nil];
+}
+
+- (void)writeEntry:(SBALogEntry *)entry
+{
+    NSString *tag = SBALogEventTrimmedTag(entry.tag);
+    if (self.tags != nil && ![self.tags containsObject:tag]) {
+        return;
+    }
+    
+    // Each file holds at most half of the maximum size so that the current and previous files fit
+    NSData *record = SBALogEventRecord(entry, tag);
+    unsigned long long maximumFileSize = self.maximumSize / 2;
+    if (kEventFileHeaderLength + record.length > maximumFileSize) {
+        return;
+    }
+    
+    NSFileHandle *fileHandle = [self openFileHandle];
+    if (self.currentFileSize > kEventFileHeaderLength && self.currentFileSize + record.length > maximumFileSize) {
+        [self rotateFiles];
+        fileHandle = [self openFileHandle];
+    }
+    
+    @try {
+        [fileHandle writeData:record];
+        self.currentFileSize += record.length;
+    }
+    @catch (NSException *exception) {
+        // If the file cannot be written (for example, the disk is full) then drop the entry
+        [fileHandle closeFile];
+        self.fileHandle = nil;
+    }
+}
+
+- (void)flush
+{
+    [self.fileHandle synchronizeFile];
+}
+
+@end
+
+
+// ---------------------------------------------------------
+#pragma mark - SBALogEventReader
+// ---------------------------------------------------------
+
+@interface SBALogEventReader ()
+
+@property (nonatomic, copy) NSURL *directoryURL;
+
+@end
+
+@implementation SBALogEventReader
+
+- (instancetype)initWithDirectoryURL:(NSURL *)directoryURL
+{
+    self = [super init];
+    if (self) {
+        _directoryURL = [directoryURL copy];
+    }
+    return self;
+}
+
+- (NSArray<NSURL *> *)eventFileURLs
+{
+    NSMutableArray *urls = [NSMutableArray new];
+    for (NSInteger ii = 1; ii >= 0; ii--) {
+        NSURL *url = SBALogEventFileURL(self.directoryURL, ii);
+        if ([[NSFileManager defaultManager] fileExistsAtPath:url.path]) {
+            [urls addObject:url];
+        }
+    }
+    return urls;
+}
+
+- (void)enumerateEntriesWithTags:(NSSet<NSString *> *)tags
+                       startDate:(NSDate *)startDate
+                         endDate:(NSDate *)endDate
+                      usingBlock:(void (NS_NOESCAPE ^)(SBALogEntry *entry, BOOL *stop))block
+{
+    NSSet<NSString *> *trimmedTags = SBALogEventTrimmedTags(tags);
+    NSTimeInterval start = startDate ? startDate.timeIntervalSinceReferenceDate : -DBL_MAX;
+    NSTimeInterval end = endDate ? endDate.timeIntervalSinceReferenceDate : DBL_MAX;
+    
+    // Cache the tag strings since there are only a handful of distinct tags
+    NSMutableDictionary<NSData *, NSString *> *tagCache = [NSMutableDictionary new];
+    
+    BOOL stop = NO;
+    for (NSURL *url in self.eventFileURLs) {
+        NSData *fileData = [NSData dataWithContentsOfURL:url options:NSDataReadingMappedIfSafe error:nil];
+        if (!SBALogEventIsValidFile(fileData)) {
+            continue;
+        }
+        
+        SBALogEventCursor file = { fileData.bytes, fileData.length, kEventFileHeaderLength, NO };
+        while (!stop && file.offset < file.length) {
+            uint32_t bodyLength = SBALogEventReadUInt32(&file);
+            const uint8_t *body = SBALogEventRead(&file, bodyLength);
+            if (body == NULL) {
+                break;
+            }
+            
+            SBALogEventCursor cursor = { body, bodyLength, 0, NO };
+            NSTimeInterval timestamp = SBALogEventReadDouble(&cursor);
+            SBALogLevel level = (SBALogLevel)SBALogEventReadUInt8(&cursor);
+            NSData *tagBytes = SBALogEventReadBytes(&cursor, 1);
+            if (cursor.failed || timestamp < start || timestamp > end) {
+                continue;
+            }
+            NSString *tag = tagCache[tagBytes];
+            if (tag == nil) {
+                tag = [[NSString alloc] initWithData:tagBytes encoding:NSUTF8StringEncoding] ?: @"";
+                tagCache[tagBytes] = tag;
+            }
+            if (trimmedTags != nil && ![trimmedTags containsObject:tag]) {
+                continue;
+            }
+            
+            NSString *methodInfo = SBALogEventReadString(&cursor, 2);
+            NSString *message = SBALogEventReadString(&cursor, 4);
+            NSUInteger count = SBALogEventReadUInt16(&cursor);
+            NSMutableDictionary *values = (count > 0) ? [NSMutableDictionary dictionaryWithCapacity:count] : nil;
+            for (NSUInteger ii = 0; ii < count && !cursor.failed; ii++) {
+                NSString *key = SBALogEventReadString(&cursor, 2);
+                id value = SBALogEventReadValue(&cursor);
+                if (key != nil && value != nil) {
+                    values[key] = value;
+                }
+            }
+            if (cursor.failed) {
+                continue;
+            }
+            
+            NSString *entryMessage = message;
+            SBALogEntry *entry = [[SBALogEntry alloc] initWithLevel:level tag:tag methodInfo:methodInfo timestamp:timestamp data:values messageBlock:^NSString *{
+                return entryMessage;
+            }];
+            block(entry, &stop);
+        }
+        if (stop) {
+            break;
+        }
+    }
+}
+
+- (NSArray<SBALogEntry *> *)entriesWithTags:(NSSet<NSString *> *)tags
+                                  startDate:(NSDate *)startDate
+                                    endDate:(NSDate *)endDate
+{
+    NSMutableArray *entries = [NSMutableArray new];
+    [self enumerateEntriesWithTags:tags startDate:startDate endDate:endDate usingBlock:^(SBALogEntry *entry, BOOL *stop) {
+        [entries addObject:entry];
+    }];
+    return entries;
+}
+
+- (NSData *)JSONDataWithTags:(NSSet<NSString *> *)tags
+                   startDate:(NSDate *)startDate
+                     endDate:(NSDate *)endDate
+                       error:(NSError * _Nullable *)error
+{
+    NSISO8601DateFormatter *formatter = [NSISO8601DateFormatter new];
+    formatter.formatOptions = NSISO8601DateFormatWithInternetDateTime | NSISO8601DateFormatWithFractionalSeconds;
+    
+    NSMutableArray *events = [NSMutableArray new];
+    [self enumerateEntriesWithTags:tags startDate:startDate endDate:endDate usingBlock:^(SBALogEntry *entry, BOOL *stop) {
+        NSMutableDictionary *event = [NSMutableDictionary new];
+        event[@"timestamp"] = [formatter stringFromDate:[NSDate dateWithTimeIntervalSinceReferenceDate:entry.timestamp]];
+        event[@"level"] = @(entry.level);
+        event[@"tag"] = entry.tag;
+        event[@"method"] = entry.methodInfo;
+        event[@"message"] = entry.message;
+        if (entry.data != nil) {
+            NSMutableDictionary *data = [NSMutableDictionary dictionaryWithCapacity:entry.data.count];
+            [entry.data enumerateKeysAndObjectsUsingBlock:^(NSString *key, id value, BOOL *stopData) {
+                if ([value isKindOfClass:[NSDate class]]) {
+                    data[key] = [formatter stringFromDate:value];
+                }
+                else if ([value isKindOfClass:[NSData class]]) {
+                    data[key] = [(NSData *)value base64EncodedStringWithOptions:0];
+                }
+                else {
+                    data[key] = value;
+                }
+            }];
+            event[@"data"] = data;
+        }
+        [events addObject:event];
+    }];
+    
+    return [NSJSONSerialization dataWithJSONObject:events options:NSJSONWritingPrettyPrinted error:error];
+}
+
+@end
@@ -0,0 +1,129 @@
+//
+//  SBALogRingBuffer.m
+//  BridgeAppSDK
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+#import "SBALogRingBuffer.h"
+#import <stdatomic.h>
+
+/*
+ Bounded queue using a sequence number per slot. A producer claims a slot by
+ incrementing the enqueue position and then publishes the object by setting
+ the slot sequence to position + 1. The consumer reads the slot once the
+ sequence is published and then releases the slot for the next lap around
+ the buffer by setting the sequence to position + capacity.
+ */
+typedef struct {
+    _Atomic(uintptr_t) sequence;
+    void *object;
+} SBALogRingBufferSlot;
+
+@implementation SBALogRingBuffer {
+    SBALogRingBufferSlot *_slots;
+    uintptr_t _mask;
+    _Atomic(uintptr_t) _enqueuePosition;
+    uintptr_t _dequeuePosition;
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity
+{
+    self = [super init];
+    if (self) {
+        NSUInteger size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        _capacity = size;
+        _mask = size - 1;
+        _slots = calloc(size, sizeof(SBALogRingBufferSlot));
+        for (NSUInteger ii = 0; ii < size; ii++) {
+            atomic_init(&_slots[ii].sequence, ii);
+        }
+        atomic_init(&_enqueuePosition, 0);
+        _dequeuePosition = 0;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    while ([self dequeue] != nil) {
+    }
+    free(_slots);
+}
+
+- (BOOL)enqueue:(id)object
+{
+    uintptr_t position = atomic_load_explicit(&_enqueuePosition, memory_order_relaxed);
+    SBALogRingBufferSlot *slot = NULL;
+    for (;;) {
+        slot = &_slots[position & _mask];
+        uintptr_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)position;
+        if (diff == 0) {
+            // The slot is free. Claim it (on failure, position is updated to the current value)
+            if (atomic_compare_exchange_weak_explicit(&_enqueuePosition, &position, position + 1, memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        }
+        else if (diff < 0) {
+            // The slot has not been released by the consumer so the buffer is full
+            return NO;
+        }
+        else {
+            // Another producer claimed the slot
+            position = atomic_load_explicit(&_enqueuePosition, memory_order_relaxed);
+        }
+    }
+    
+    slot->object = (void *)CFBridgingRetain(object);
+    atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+    return YES;
+}
+
+- (id)dequeue
+{
+    SBALogRingBufferSlot *slot = &_slots[_dequeuePosition & _mask];
+    uintptr_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+    if ((intptr_t)sequence - (intptr_t)(_dequeuePosition + 1) < 0) {
+        // The slot has not been published
+        return nil;
+    }
+    
+    id object = CFBridgingRelease(slot->object);
+    slot->object = NULL;
+    atomic_store_explicit(&slot->sequence, _dequeuePosition + _mask + 1, memory_order_release);
+    _dequeuePosition += 1;
+    return object;
+}
+
+@end
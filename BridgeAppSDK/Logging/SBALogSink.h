@@ -0,0 +1,130 @@
+//
+//  SBALogSink.h
+//  BridgeAppSDK
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The level at which a message is logged. Lower levels are more severe.
+ */
+typedef NS_ENUM(NSInteger, SBALogLevel) {
+    SBALogLevelNone = 0,
+    SBALogLevelError,
+    SBALogLevelInfo,
+    SBALogLevelDebug,
+};
+
+/**
+ `SBALogEntry` is a single logged message. An entry is created on the thread that logged the message
+ and is then passed to each sink on the log writer queue.
+ */
+@interface SBALogEntry : NSObject
+
+@property (nonatomic, readonly) SBALogLevel level;
+@property (nonatomic, readonly, copy) NSString *tag;
+@property (nonatomic, readonly, copy) NSString *methodInfo;
+@property (nonatomic, readonly) NSTimeInterval timestamp;
+
+/**
+ The message. If the entry was created with a message block, then the block is called the first time
+ this property is read. This should only be read from a sink.
+ */
+@property (nonatomic, readonly, copy) NSString *message;
+
+/**
+ Structured key/value data for the entry, if any. For an event logged with `SBALogEventWithData()`,
+ the message is the event name and this is the event dictionary.
+ */
+@property (nonatomic, readonly, copy, nullable) NSDictionary<NSString *, id> *data;
+
+- (instancetype)initWithLevel:(SBALogLevel)level tag:(NSString *)tag methodInfo:(NSString *)methodInfo message:(NSString *)message;
+
+- (instancetype)initWithLevel:(SBALogLevel)level tag:(NSString *)tag methodInfo:(NSString *)methodInfo messageBlock:(NSString * (^)(void))messageBlock;
+
+- (instancetype)initWithLevel:(SBALogLevel)level tag:(NSString *)tag methodInfo:(NSString *)methodInfo message:(NSString *)message data:(nullable NSDictionary<NSString *, id> *)data;
+
+- (instancetype)initWithLevel:(SBALogLevel)level tag:(NSString *)tag methodInfo:(NSString *)methodInfo timestamp:(NSTimeInterval)timestamp data:(nullable NSDictionary<NSString *, id> *)data messageBlock:(nullable NSString * (^)(void))messageBlock NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+/**
+ A destination for log entries. The methods are called on the log writer queue.
+ */
+@protocol SBALogSink <NSObject>
+
+- (void)writeEntry:(SBALogEntry *)entry;
+
+@optional
+
+- (void)flush;
+
+@end
+
+/**
+ Writes the log entries using `NSLog()`.
+ */
+@interface SBALogConsoleSink : NSObject <SBALogSink>
+
+@end
+
+/**
+ Writes the log entries to a file in the given directory. When the file is larger than the maximum
+ file size, it is renamed and a new file is started. Only the newest `maximumFileCount` files are kept.
+ */
+@interface SBALogFileSink : NSObject <SBALogSink>
+
+@property (nonatomic, readonly) NSURL *directoryURL;
+@property (nonatomic, readonly) unsigned long long maximumFileSize;
+@property (nonatomic, readonly) NSUInteger maximumFileCount;
+
+/**
+ The log files that currently exist, ordered from newest to oldest.
+ */
+@property (nonatomic, readonly) NSArray<NSURL *> *logFileURLs;
+
+/**
+ Create a file sink with a maximum file size of 512 KB and a maximum of 4 files.
+ */
+- (instancetype)initWithDirectoryURL:(NSURL *)directoryURL;
+
+- (instancetype)initWithDirectoryURL:(NSURL *)directoryURL maximumFileSize:(unsigned long long)maximumFileSize maximumFileCount:(NSUInteger)maximumFileCount NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,225 @@
+//
+//  SBALogSink.m
+//  BridgeAppSDK
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+#import "SBALogSink.h"
+
+static NSString * const kLogFileName      = @"SBALog";
+static NSString * const kLogFileExtension = @"log";
+static NSString * const kLogDateFormat    = @"yyyy-MM-dd HH:mm:ss.SSS ZZZZ";
+
+@interface SBALogEntry ()
+
+/**
+ The message followed by the data (if any), as written by the text sinks.
+ */
+- (NSString *)formattedMessage;
+
+@end
+
+@implementation SBALogEntry {
+    NSString *_message;
+    NSString * (^_messageBlock)(void);
+}
+
+- (instancetype)initWithLevel:(SBALogLevel)level tag:(NSString *)tag methodInfo:(NSString *)methodInfo message:(NSString *)message
+{
+    self = [self initWithLevel:level tag:tag methodInfo:methodInfo messageBlock:nil];
+    if (self) {
+        _message = [message copy];
+    }
+    return self;
+}
+
+- (instancetype)initWithLevel:(SBALogLevel)level tag:(NSString *)tag methodInfo:(NSString *)methodInfo messageBlock:(NSString * (^)(void))messageBlock
+{
+    return [self initWithLevel:level tag:tag methodInfo:methodInfo timestamp:[NSDate timeIntervalSinceReferenceDate] data:nil messageBlock:messageBlock];
+}
+
+- (instancetype)initWithLevel:(SBALogLevel)level tag:(NSString *)tag methodInfo:(NSString *)methodInfo message:(NSString *)message data:(NSDictionary<NSString *, id> *)data
+{
+    self = [self initWithLevel:level tag:tag methodInfo:methodInfo timestamp:[NSDate timeIntervalSinceReferenceDate] data:data messageBlock:nil];
+    if (self) {
+        _message = [message copy];
+    }
+    return self;
+}
+
+- (instancetype)initWithLevel:(SBALogLevel)level tag:(NSString *)tag methodInfo:(NSString *)methodInfo timestamp:(NSTimeInterval)timestamp data:(NSDictionary<NSString *, id> *)data messageBlock:(NSString * (^)(void))messageBlock
+{
+    self = [super init];
+    if (self) {
+        _level = level;
+        _tag = [tag copy];
+        _methodInfo = [methodInfo copy];
+        _timestamp = timestamp;
+        _data = [data copy];
+        _messageBlock = [messageBlock copy];
+    }
+    return self;
+}
+
+- (NSString *)message
+{
+    if (_message == nil && _messageBlock != nil) {
+        _message = [_messageBlock() copy];
+        _messageBlock = nil;
+    }
+    return _message ?: @"";
+}
+
+- (NSString *)formattedMessage
+{
+    return (self.data != nil) ? [NSString stringWithFormat:@"%@: %@", self.message, self.data] : self.message;
+}
+
+@end
+
+@implementation SBALogConsoleSink
+
+- (void)writeEntry:(SBALogEntry *)entry
+{
+    NSLog(@"%@ %@ => %@", entry.tag, entry.methodInfo, entry.formattedMessage);
+}
+
+@end
+
+@interface SBALogFileSink ()
+
+@property (nonatomic, strong) NSFileHandle *fileHandle;
+@property (nonatomic) unsigned long long currentFileSize;
+@property (nonatomic, strong) NSDateFormatter *dateFormatter;
+
+@end
+
+@implementation SBALogFileSink
+
+- (instancetype)initWithDirectoryURL:(NSURL *)directoryURL
+{
+    return [self initWithDirectoryURL:directoryURL maximumFileSize:512 * 1024 maximumFileCount:4];
+}
+
+- (instancetype)initWithDirectoryURL:(NSURL *)directoryURL maximumFileSize:(unsigned long long)maximumFileSize maximumFileCount:(NSUInteger)maximumFileCount
+{
+    self = [super init];
+    if (self) {
+        _directoryURL = [directoryURL copy];
+        _maximumFileSize = maximumFileSize;
+        _maximumFileCount = MAX(maximumFileCount, 1);
+        _dateFormatter = [NSDateFormatter new];
+        _dateFormatter.locale = [NSLocale localeWithLocaleIdentifier:@"en_US_POSIX"];
+        _dateFormatter.dateFormat = kLogDateFormat;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [_fileHandle closeFile];
+}
+
+- (NSURL *)logFileURLAtIndex:(NSUInteger)index
+{
+    NSString *filename = (index == 0) ? kLogFileName : [NSString stringWithFormat:@"%@.%@", kLogFileName, @(index)];
+    return [[self.directoryURL URLByAppendingPathComponent:filename] URLByAppendingPathExtension:kLogFileExtension];
+}
+
+- (NSArray<NSURL *> *)logFileURLs
+{
+    NSMutableArray *urls = [NSMutableArray new];
+    for (NSUInteger ii = 0; ii < self.maximumFileCount; ii++) {
+        NSURL *url = [self logFileURLAtIndex:ii];
+        if ([[NSFileManager defaultManager] fileExistsAtPath:url.path]) {
+            [urls addObject:url];
+        }
+    }
+    return urls;
+}
+
+- (NSFileHandle *)openFileHandle
+{
+    if (self.fileHandle == nil) {
+        NSFileManager *fileManager = [NSFileManager defaultManager];
+        [fileManager createDirectoryAtURL:self.directoryURL withIntermediateDirectories:YES attributes:nil error:nil];
+        NSURL *url = [self logFileURLAtIndex:0];
+        if (![fileManager fileExistsAtPath:url.path]) {
+            [fileManager createFileAtPath:url.path contents:nil attributes:@{NSFileProtectionKey : NSFileProtectionCompleteUntilFirstUserAuthentication}];
+        }
+        self.fileHandle = [NSFileHandle fileHandleForWritingToURL:url error:nil];
+        self.currentFileSize = [self.fileHandle seekToEndOfFile];
+    }
+    return self.fileHandle;
+}
+
+- (void)rotateFiles
+{
+    [self.fileHandle closeFile];
+    self.fileHandle = nil;
+    
+    // Shift each file up by one, removing the oldest
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    [fileManager removeItemAtURL:[self logFileURLAtIndex:self.maximumFileCount - 1] error:nil];
+    for (NSInteger ii = (NSInteger)self.maximumFileCount - 2; ii >= 0; ii--) {
+        [fileManager moveItemAtURL:[self logFileURLAtIndex:ii] toURL:[self logFileURLAtIndex:ii + 1] error:nil];
+    }
+}
+
+- (void)writeEntry:(SBALogEntry *)entry
+{
+    NSDate *date = [NSDate dateWithTimeIntervalSinceReferenceDate:entry.timestamp];
+    NSString *line = [NSString stringWithFormat:@"%@ %@ %@ => %@\n", [self.dateFormatter stringFromDate:date], entry.tag, entry.methodInfo, entry.formattedMessage];
+    NSData *data = [line dataUsingEncoding:NSUTF8StringEncoding];
+    
+    NSFileHandle *fileHandle = [self openFileHandle];
+    if (self.currentFileSize > 0 && self.currentFileSize + data.length > self.maximumFileSize) {
+        [self rotateFiles];
+        fileHandle = [self openFileHandle];
+    }
+    
+    @try {
+        [fileHandle writeData:data];
+        self.currentFileSize += data.length;
+    }
+    @catch (NSException *exception) {
+        // If the file cannot be written (for example, the disk is full) then drop the entry
+        [fileHandle closeFile];
+        self.fileHandle = nil;
+    }
+}
+
+- (void)flush
+{
+    [self.fileHandle synchronizeFile];
+}
+
+@end
@@ -88,6 +88,21 @@ open class SBAActivityTableViewController: UITableViewController, SBAScheduledAc
         self.tableView.reloadData()
     }
     
+    open func scheduledActivitiesDidChange(_ sender: Any?, changes: SBAScheduledActivityChanges) {
+        self.refreshControl?.endRefreshing()
+        
+        // Only animate the changes if the table is visible and the rows that changed are known
+        guard !changes.requiresReload, self.isViewLoaded, self.tableView.window != nil else {
+            self.tableView.reloadData()
+            return
+        }
+        guard changes.deletedIndexPaths.count > 0 || changes.insertedIndexPaths.count > 0 else { return }
+        self.tableView.beginUpdates()
+        self.tableView.deleteRows(at: changes.deletedIndexPaths, with: .fade)
+        self.tableView.insertRows(at: changes.insertedIndexPaths, with: .fade)
+        self.tableView.endUpdates()
+    }
+    
     // MARK: table cell customization
     
     /**
@@ -131,12 +146,12 @@ open class SBAActivityTableViewController: UITableViewController, SBAScheduledAc
         // Show a detail that is most appropriate to the schedule status
         if schedule.isCompleted {
             let format = Localization.localizedString("SBA_ACTIVITY_SCHEDULE_COMPLETE_%@")
-            let dateString = DateFormatter.localizedString(from: schedule.finishedOn!, dateStyle: .medium, timeStyle: .short)
+            let dateString = SBAFormatterCache.shared.dateFormatter(dateStyle: .medium, timeStyle: .short).string(from: schedule.finishedOn!)
             activityCell.subtitleLabel.text = String.localizedStringWithFormat(format, dateString)
         }
         else if schedule.isExpired {
             let format = Localization.localizedString("SBA_ACTIVITY_SCHEDULE_EXPIRED_%@")
-            let dateString = schedule.isToday ? schedule.expiresTime! : DateFormatter.localizedString(from: schedule.expiresOn!, dateStyle: .medium, timeStyle: .short)
+            let dateString = schedule.isToday ? schedule.expiresTime! : SBAFormatterCache.shared.dateFormatter(dateStyle: .medium, timeStyle: .short).string(from: schedule.expiresOn!)
             activityCell.subtitleLabel.text = String.localizedStringWithFormat(format, dateString)
         }
         else if schedule.isToday {
@@ -147,7 +162,7 @@ open class SBAActivityTableViewController: UITableViewController, SBAScheduledAc
         }
         else {
             let format = Localization.localizedString("SBA_ACTIVITY_SCHEDULE_AVAILABLE_ON_%@")
-            let dateString = DateFormatter.localizedString(from: schedule.scheduledOn, dateStyle: .medium, timeStyle: .none)
+            let dateString = SBAFormatterCache.shared.dateFormatter(dateStyle: .medium, timeStyle: .none).string(from: schedule.scheduledOn)
             activityCell.subtitleLabel.text = String.localizedStringWithFormat(format, dateString)
         }
         
@@ -96,9 +96,20 @@ public let SBAMainStoryboardName = "Main"
         self.initializeBridgeServerConnection()
         BridgeSDK.setErrorUIDelegate(self)
         
+        // Build the task and schema lookup table before the schedules are loaded.
+        let _ = self.bridgeInfo.taskSchemaRegistry
+        
         // Save any outstanding clientData profile item updates to Bridge, and ensure the class has
         // access to all the SBBScheduledActivity objects in BridgeSDK's cache.
         SBAClientDataProfileItem.updateChangesToBridge()
+        
+        // Send any schedule updates that were still queued when the app was last terminated.
+        SBAScheduleUpdateQueue.shared.flush()
+        
+        // Delete the task output and pending archives that do not fit in the disk budget.
+        DispatchQueue.global(qos: .utility).async {
+            SBADiskBudget.shared.enforce()
+        }
 
         // Set the tint colors if applicable
         if let tintColor = UIColor.primaryTintColor {
@@ -132,6 +143,12 @@ public let SBAMainStoryboardName = "Main"
     }
     
     open func applicationDidEnterBackground(_ application: UIApplication) {
+        // Write any cached clientData profile item changes to the keychain.
+        SBAClientDataProfileItem.flushCurrentValues()
+        
+        // Send the queued schedule updates rather than waiting for the batch interval.
+        SBAScheduleUpdateQueue.shared.flush()
+        
         if shouldShowPasscode() {
             // Hide content so it doesn't appear in the app switcher.
             rootViewController?.contentHidden = true
@@ -149,6 +166,11 @@ public let SBAMainStoryboardName = "Main"
         rootViewController?.contentHidden = false
         
         self.currentUser.ensureSignedInWithCompletion() { (error) in
+            // Upload any encrypted archives that were orphaned by the background session
+            if error == nil {
+                SBAUploadLedger.shared.retryPendingUploads()
+            }
+            
             // Check if there are any errors during sign in that we need to address
             if let error = error, let errorCode = SBBErrorCode(rawValue: (error as NSError).code) {
                 switch errorCode {
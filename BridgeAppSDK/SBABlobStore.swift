@@ -0,0 +1,221 @@
+//
+//  SBABlobStore.swift
+//  BridgeAppSDK
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+import UIKit
+import ImageIO
+import CommonCrypto
+
+/**
+ `SBABlobStore` keeps large binary values, such as the profile image and the consent signature image,
+ in protected files instead of the keychain. Each blob is named by the SHA-256 hash of its contents so
+ that the keychain only needs to hold the small reference string, and storing the same data twice
+ does not write it again.
+ 
+ Thumbnails are downsampled from the stored file once and then kept alongside it.
+ */
+public final class SBABlobStore {
+    
+    public static let shared = SBABlobStore()
+    
+    /**
+     The default directory for the blobs in the Application Support directory.
+     */
+    public static var defaultURL: URL {
+        let supportURL = FileManager.default.urls(for: .applicationSupportDirectory, in: .userDomainMask).first!
+        return supportURL.appendingPathComponent("SBABlobStore", isDirectory: true)
+    }
+    
+    /**
+     The directory where the blobs are stored.
+     */
+    public let rootURL: URL
+    
+    /**
+     The data protection class for the blob files. Default = `.completeUntilFirstUserAuthentication`
+     so that the files can be read in the background after the device has been unlocked once.
+     */
+    public let fileProtection: FileProtectionType
+    
+    private let imageCache = NSCache<NSString, UIImage>()
+    
+    public init(rootURL: URL = SBABlobStore.defaultURL, fileProtection: FileProtectionType = .completeUntilFirstUserAuthentication) {
+        self.rootURL = rootURL
+        self.fileProtection = fileProtection
+    }
+    
+    /**
+     Store the data.
+     @param     data    The data to store.
+     @return            The reference to use to get the data back.
+     */
+    @discardableResult
+    public func store(_ data: Data) throws -> String {
+        let reference = SBABlobStore.reference(for: data)
+        let url = fileURL(for: reference)
+        if !FileManager.default.fileExists(atPath: url.path) {
+            try FileManager.default.createDirectory(at: rootURL, withIntermediateDirectories: true, attributes: [.protectionKey : fileProtection])
+            try data.write(to: url, options: [.atomic, writingOptions])
+        }
+        return reference
+    }
+    
+    /**
+     Whether or not there is a blob for the given reference.
+     */
+    public func contains(_ reference: String) -> Bool {
+        guard SBABlobStore.isValid(reference) else { return false }
+        return FileManager.default.fileExists(atPath: fileURL(for: reference).path)
+    }
+    
+    /**
+     The stored data for the given reference.
+     */
+    public func data(for reference: String) -> Data? {
+        guard SBABlobStore.isValid(reference) else { return nil }
+        return try? Data(contentsOf: fileURL(for: reference), options: .mappedIfSafe)
+    }
+    
+    /**
+     The stored image for the given reference. Decoded images are kept in memory until there is
+     memory pressure.
+     */
+    public func image(for reference: String) -> UIImage? {
+        if let image = imageCache.object(forKey: reference as NSString) {
+            return image
+        }
+        guard let data = data(for: reference), let image = UIImage(data: data) else { return nil }
+        imageCache.setObject(image, forKey: reference as NSString, cost: data.count)
+        return image
+    }
+    
+    /**
+     A thumbnail of the stored image that is no larger than `maxPixelSize` in either dimension.
+     The thumbnail is generated without decoding the full image, and saved so that it is only
+     generated once.
+     */
+    public func thumbnail(for reference: String, maxPixelSize: Int) -> UIImage? {
+        guard SBABlobStore.isValid(reference) else { return nil }
+        let cacheKey = "\(reference)-\(maxPixelSize)"
+        if let image = imageCache.object(forKey: cacheKey as NSString) {
+            return image
+        }
+        
+        let thumbnailURL = rootURL.appendingPathComponent("\(cacheKey).thumbnail")
+        if let data = try? Data(contentsOf: thumbnailURL), let image = UIImage(data: data) {
+            imageCache.setObject(image, forKey: cacheKey as NSString, cost: data.count)
+            return image
+        }
+        
+        let sourceOptions = [kCGImageSourceShouldCache : false] as CFDictionary
+        let thumbnailOptions = [kCGImageSourceCreateThumbnailFromImageAlways : true,
+                                kCGImageSourceCreateThumbnailWithTransform : true,
+                                kCGImageSourceShouldCacheImmediately : true,
+                                kCGImageSourceThumbnailMaxPixelSize : maxPixelSize] as CFDictionary
+        guard let source = CGImageSourceCreateWithURL(fileURL(for: reference) as CFURL, sourceOptions),
+            let cgImage = CGImageSourceCreateThumbnailAtIndex(source, 0, thumbnailOptions)
+            else {
+                return nil
+        }
+        
+        let image = UIImage(cgImage: cgImage)
+        if let data = image.jpegData(compressionQuality: 0.8) {
+            do {
+                try data.write(to: thumbnailURL, options: [.atomic, writingOptions])
+            } catch let err {
+                debugPrint("Failed to save the thumbnail for \(reference): \(err)")
+            }
+            imageCache.setObject(image, forKey: cacheKey as NSString, cost: data.count)
+        }
+        return image
+    }
+    
+    /**
+     Remove the blob and any thumbnails of it.
+     */
+    public func remove(_ reference: String) {
+        guard SBABlobStore.isValid(reference) else { return }
+        let fileManager = FileManager.default
+        try? fileManager.removeItem(at: fileURL(for: reference))
+        imageCache.removeObject(forKey: reference as NSString)
+        
+        let thumbnailPrefix = "\(reference)-"
+        let thumbnails = (try? fileManager.contentsOfDirectory(atPath: rootURL.path))?.filter { $0.hasPrefix(thumbnailPrefix) } ?? []
+        for filename in thumbnails {
+            try? fileManager.removeItem(at: rootURL.appendingPathComponent(filename))
+            let cacheKey = (filename as NSString).deletingPathExtension
+            imageCache.removeObject(forKey: cacheKey as NSString)
+        }
+    }
+    
+    /**
+     Remove all the blobs.
+     */
+    public func removeAll() {
+        try? FileManager.default.removeItem(at: rootURL)
+        imageCache.removeAllObjects()
+    }
+    
+    /**
+     The reference for the given data: the hex-encoded SHA-256 hash of its contents.
+     */
+    public static func reference(for data: Data) -> String {
+        var digest = [UInt8](repeating: 0, count: Int(CC_SHA256_DIGEST_LENGTH))
+        data.withUnsafeBytes { (bytes: UnsafeRawBufferPointer) in
+            _ = CC_SHA256(bytes.baseAddress, CC_LONG(data.count), &digest)
+        }
+        return digest.map { String(format: "%02x", $0) }.joined()
+    }
+    
+    // The reference is used as a filename so only allow the characters of a hash
+    private static func isValid(_ reference: String) -> Bool {
+        return reference.count == Int(CC_SHA256_DIGEST_LENGTH) * 2 && reference.allSatisfy { $0.isHexDigit }
+    }
+    
+    private func fileURL(for reference: String) -> URL {
+        return rootURL.appendingPathComponent("\(reference).blob")
+    }
+    
+    private var writingOptions: Data.WritingOptions {
+        switch fileProtection {
+        case .complete:
+            return .completeFileProtection
+        case .completeUnlessOpen:
+            return .completeFileProtectionUnlessOpen
+        case .none:
+            return .noFileProtection
+        default:
+            return .completeFileProtectionUntilFirstUserAuthentication
+        }
+    }
+}
@@ -247,12 +247,19 @@ extension SBABridgeInfo {
         return url
     }
         
+    /**
+     The lookup table for the task and schema mappings. This is built the first time it is used.
+     */
+    public var taskSchemaRegistry: SBATaskSchemaRegistry {
+        return SBATaskSchemaRegistry.registry(for: self)
+    }
+        
     public func schemaReferenceWithIdentifier(_ schemaIdentifier: String) -> SBASchemaReference? {
-        return self.schemaMap?.sba_find({ $0.schemaIdentifier == schemaIdentifier})
+        return taskSchemaRegistry.schemaReference(with: schemaIdentifier)
     }
     
     public func taskReferenceWithIdentifier(_ taskIdentifier: String) -> SBATaskReference? {
-        return self.taskMap?.sba_find({ $0.taskIdentifier == taskIdentifier})
+        return taskSchemaRegistry.taskReference(with: taskIdentifier)
     }
     
     public func taskReferenceForSchedule(_ schedule: SBBScheduledActivity) -> SBATaskReference? {
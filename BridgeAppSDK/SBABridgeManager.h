@@ -98,6 +98,17 @@ typedef void (^SBABridgeManagerCompletionBlock)(id _Nullable responseObject, NSE
  */
 + (void)restoreBackgroundSession:(NSString *)identifier completionHandler:(void (^)(void))completionHandler;
 
+/*!
+ Upload a file to Bridge using the background session.
+ 
+ @param fileURL           The URL of the file to upload.
+ @param contentType       The MIME type of the file.
+ @param completionBlock   Called with an error if the upload failed. Optional.
+ */
++ (void)uploadFile:(NSURL *)fileURL
+       contentType:(NSString *)contentType
+        completion:(void (^ _Nullable)(NSError * _Nullable error))completionBlock;
+
 /*!
  Sign up for an account using a SignUp record, which is basically a StudyParticipant object with a password field. At minimum, the email and password fields must be filled in; in general, you would also want to fill in any of the following information available at sign-up time: firstName, lastName, sharingScope, externalId (if used), dataGroups, notifyByEmail, and any custom attributes you've defined for the attributes field.
  
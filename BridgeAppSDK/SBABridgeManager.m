@@ -75,6 +75,15 @@
     [SBBComponent(SBBBridgeNetworkManager) restoreBackgroundSession:identifier completionHandler:completionHandler];
 }
 
++ (void)uploadFile:(NSURL *)fileURL contentType:(NSString *)contentType completion:(void (^ _Nullable)(NSError * _Nullable error))completionBlock
+{
+    [SBBComponent(SBBUploadManager) uploadFileToBridge:fileURL contentType:contentType completion:^(NSError *error) {
+        if (completionBlock) {
+            completionBlock(error);
+        }
+    }];
+}
+
 + (void)signUp:(NSString *)email
       password:(NSString *)password
     externalId:(NSString *)externalId
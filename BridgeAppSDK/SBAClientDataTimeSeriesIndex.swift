@@ -0,0 +1,178 @@
+//
+//  SBAClientDataTimeSeriesIndex.swift
+//  BridgeAppSDK
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+import Foundation
+import BridgeSDK
+
+/**
+ `SBAClientDataTimeSeriesIndex` indexes the client data values that `SBAClientDataProfileItem` stores
+ on the scheduled activities.
+ 
+ - The scheduled activities are grouped by activity identifier and sorted by `scheduledOn`, so that
+   the best activity for a given date is found with a binary search.
+ - The values for each activity identifier and source key are collected and sorted the first time
+   they are requested, and new values are then inserted in order.
+ 
+ The index is not thread safe. `SBAClientDataProfileItem` only accesses it on its cache queue.
+ */
+final class SBAClientDataTimeSeriesIndex {
+    
+    struct Entry {
+        let date: Date
+        let isNew: Bool
+        let json: [String: SBBJSONValue]
+        
+        init(json: [String: SBBJSONValue]) {
+            let whatAndWhen = SBAWhatAndWhen(dictionaryRepresentation: json)
+            self.date = whatAndWhen.date as Date
+            self.isNew = whatAndWhen.isNew
+            self.json = json
+        }
+        
+        var whatAndWhen: SBAWhatAndWhen {
+            return SBAWhatAndWhen(json[SBAWhatAndWhen.valueKey]!, asOf: date as NSDate, isNew: isNew)
+        }
+        
+        /** Same ordering as `SBAWhatAndWhen`: by date and then with `isNew == false` first. */
+        static func < (lhs: Entry, rhs: Entry) -> Bool {
+            guard lhs.date == rhs.date else { return lhs.date < rhs.date }
+            return !lhs.isNew && rhs.isNew
+        }
+    }
+    
+    private let activities: [String : [SBBScheduledActivity]]
+    private let indexedActivities: Set<ObjectIdentifier>
+    private var series: [String : [Entry]] = [:]
+    
+    init(scheduledActivities: [SBBScheduledActivity]) {
+        var activities: [String : [SBBScheduledActivity]] = [:]
+        for scheduledActivity in scheduledActivities {
+            guard let identifier = scheduledActivity.activityIdentifier as String? else { continue }
+            activities[identifier, default: []].append(scheduledActivity)
+        }
+        self.indexedActivities = Set(scheduledActivities.map { ObjectIdentifier($0) })
+        
+        // Sort by date but otherwise keep the original order
+        self.activities = activities.mapValues { (list) -> [SBBScheduledActivity] in
+            return list.enumerated().sorted(by: { (lhs, rhs) -> Bool in
+                let comparison = lhs.element.scheduledOn.compare(rhs.element.scheduledOn)
+                return comparison == .orderedSame ? lhs.offset < rhs.offset : comparison == .orderedAscending
+            }).map { $0.element }
+        }
+    }
+    
+    /**
+     The scheduled activities with this activity identifier, sorted by `scheduledOn`.
+     */
+    func scheduledActivities(for activityIdentifier: String) -> [SBBScheduledActivity] {
+        return activities[activityIdentifier] ?? []
+    }
+    
+    /**
+     The most recent activity scheduled on or before the given date, or the oldest activity if none
+     were scheduled before that date.
+     */
+    func bestScheduledActivity(for activityIdentifier: String, on date: Date) -> SBBScheduledActivity? {
+        guard let list = activities[activityIdentifier], list.count > 0 else { return nil }
+        
+        // Find the first activity scheduled after the date
+        var low = 0
+        var high = list.count
+        while low < high {
+            let mid = (low + high) / 2
+            if list[mid].scheduledOn <= date {
+                low = mid + 1
+            } else {
+                high = mid
+            }
+        }
+        return low > 0 ? list[low - 1] : list[0]
+    }
+    
+    /**
+     All the values for the given activity identifier and source key, sorted by date.
+     */
+    func entries(for activityIdentifier: String, sourceKey: String) -> [Entry] {
+        let key = seriesKey(activityIdentifier, sourceKey)
+        if let entries = series[key] {
+            return entries
+        }
+        
+        var entries: [Entry] = []
+        for scheduledActivity in scheduledActivities(for: activityIdentifier) {
+            guard let clientData = scheduledActivity.clientData as? NSDictionary,
+                let valueArray = clientData[sourceKey] as? [[String : SBBJSONValue]]
+                else {
+                    continue
+            }
+            entries.append(contentsOf: valueArray.map { Entry(json: $0) })
+        }
+        entries.sort(by: <)
+        series[key] = entries
+        return entries
+    }
+    
+    /**
+     Add a value that was stored on one of the indexed scheduled activities. If the values for this
+     activity identifier and source key have not been requested yet, then they are collected when they are.
+     */
+    func insert(_ json: [String: SBBJSONValue], to scheduledActivity: SBBScheduledActivity, sourceKey: String) {
+        guard indexedActivities.contains(ObjectIdentifier(scheduledActivity)),
+            let activityIdentifier = scheduledActivity.activityIdentifier as String?
+            else {
+                return
+        }
+        let key = seriesKey(activityIdentifier, sourceKey)
+        guard var entries = series.removeValue(forKey: key) else { return }
+        
+        // Insert after any entries that sort the same
+        let entry = Entry(json: json)
+        var low = 0
+        var high = entries.count
+        while low < high {
+            let mid = (low + high) / 2
+            if entry < entries[mid] {
+                high = mid
+            } else {
+                low = mid + 1
+            }
+        }
+        entries.insert(entry, at: low)
+        series[key] = entries
+    }
+    
+    private func seriesKey(_ activityIdentifier: String, _ sourceKey: String) -> String {
+        return "\(activityIdentifier)|\(sourceKey)"
+    }
+}
@@ -63,9 +63,33 @@ open class SBAConsentSignature: NSObject, SBAConsentSignatureWrapper, NSSecureCo
     public let identifier: String
     open var signatureBirthdate: Date?
     open var signatureName: String?
-    open var signatureImage: UIImage?
     open var signatureDate: Date?
     
+    open var signatureImage: UIImage? {
+        get {
+            if _signatureImage == nil, let reference = signatureImageReference {
+                _signatureImage = blobStore.image(for: reference)
+            }
+            return _signatureImage
+        }
+        set {
+            _signatureImage = newValue
+            signatureImageReference = nil
+        }
+    }
+    private var _signatureImage: UIImage?
+    
+    /**
+     The reference to the signature image in the `blobStore`. If set, only the reference is encoded
+     and the image is loaded from the blob store when it is first used.
+     */
+    open private(set) var signatureImageReference: String?
+    
+    /**
+     The blob store used to load the signature image. This is not encoded.
+     */
+    open var blobStore: SBABlobStore = SBABlobStore.shared
+    
     public required init(identifier: String) {
         self.identifier = identifier
         super.init()
@@ -81,12 +105,19 @@ open class SBAConsentSignature: NSObject, SBAConsentSignatureWrapper, NSSecureCo
         }
         self.signatureImage = signature.signatureImage
         if let dateString = signature.signatureDate, let dateFormat = signature.signatureDateFormatString {
-            let formatter = DateFormatter()
-            formatter.dateFormat = dateFormat
-            self.signatureDate = formatter.date(from: dateString)
+            self.signatureDate = SBAFormatterCache.shared.dateFormatter(format: dateFormat).date(from: dateString)
         }
     }
     
+    /**
+     Move the signature image into the blob store so that it is not encoded with the signature.
+     */
+    open func storeSignatureImage(in blobStore: SBABlobStore) throws {
+        self.blobStore = blobStore
+        guard signatureImageReference == nil, let data = _signatureImage?.pngData() else { return }
+        signatureImageReference = try blobStore.store(data)
+    }
+    
     // MARK: NSSecureCoding
     
     public static var supportsSecureCoding : Bool {
@@ -100,7 +131,10 @@ open class SBAConsentSignature: NSObject, SBAConsentSignatureWrapper, NSSecureCo
         self.init(identifier: identifier)
         self.signatureBirthdate = aDecoder.decodeObject(forKey: "signatureBirthdate") as? Date
         self.signatureName = aDecoder.decodeObject(forKey: "signatureName") as? String
-        self.signatureImage = aDecoder.decodeObject(forKey: "signatureImage") as? UIImage
+        self.signatureImageReference = aDecoder.decodeObject(forKey: "signatureImageReference") as? String
+        if self.signatureImageReference == nil {
+            self._signatureImage = aDecoder.decodeObject(forKey: "signatureImage") as? UIImage
+        }
         self.signatureDate = aDecoder.decodeObject(forKey: "signatureDate") as? Date
     }
     
@@ -108,7 +142,11 @@ open class SBAConsentSignature: NSObject, SBAConsentSignatureWrapper, NSSecureCo
         aCoder.encode(self.identifier, forKey: "identifier")
         aCoder.encode(self.signatureBirthdate, forKey: "signatureBirthdate")
         aCoder.encode(self.signatureName, forKey: "signatureName")
-        aCoder.encode(self.signatureImage, forKey: "signatureImage")
+        if let reference = self.signatureImageReference {
+            aCoder.encode(reference, forKey: "signatureImageReference")
+        } else {
+            aCoder.encode(self._signatureImage, forKey: "signatureImage")
+        }
         aCoder.encode(self.signatureDate, forKey: "signatureDate")
     }
     
@@ -118,7 +156,9 @@ open class SBAConsentSignature: NSObject, SBAConsentSignatureWrapper, NSSecureCo
         let copy = type(of: self).init(identifier: self.identifier)
         copy.signatureBirthdate = self.signatureBirthdate
         copy.signatureName = self.signatureName
-        copy.signatureImage = self.signatureImage
+        copy._signatureImage = self._signatureImage
+        copy.signatureImageReference = self.signatureImageReference
+        copy.blobStore = self.blobStore
         copy.signatureDate = self.signatureDate
         return copy
     }
@@ -132,7 +172,7 @@ open class SBAConsentSignature: NSObject, SBAConsentSignatureWrapper, NSSecureCo
         return  SBAObjectEquality(self.identifier, obj.identifier) &&
                 SBAObjectEquality(self.signatureBirthdate, obj.signatureBirthdate) &&
                 SBAObjectEquality(self.signatureName, obj.signatureName) &&
-                SBAObjectEquality(self.signatureImage, obj.signatureImage) &&
+                self.hasEqualSignatureImage(obj) &&
                 SBAObjectEquality(self.signatureDate, obj.signatureDate)
     }
     
@@ -140,9 +180,16 @@ open class SBAConsentSignature: NSObject, SBAConsentSignatureWrapper, NSSecureCo
         return self.identifier.hash ^
             SBAObjectHash(self.signatureBirthdate) ^
             SBAObjectHash(self.signatureName) ^
-            SBAObjectHash(self.signatureImage) ^
             SBAObjectHash(self.signatureDate)
     }
     
+    private func hasEqualSignatureImage(_ obj: SBAConsentSignature) -> Bool {
+        // Blobs are named by their contents so matching references have the same image
+        if let reference = self.signatureImageReference, reference == obj.signatureImageReference {
+            return true
+        }
+        return SBAObjectEquality(self.signatureImage, obj.signatureImage)
+    }
+    
 }
 
@@ -0,0 +1,180 @@
+//
+//  SBAFormatterCache.swift
+//  BridgeAppSDK
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+import Foundation
+
+/**
+ `SBAFormatterCache` is a thread-safe registry of formatters that are expensive to create. Date
+ formatters are keyed by their template, format or style together with the locale and calendar that
+ they use. The registry is emptied when the current locale or the system time zone changes, so the
+ next formatter that is requested picks up the new settings.
+ 
+ The formatters are shared. Do not change their properties after they are returned.
+ */
+public final class SBAFormatterCache {
+    
+    public static let shared = SBAFormatterCache()
+    
+    private struct Key: Hashable {
+        let kind: String
+        let pattern: String
+        let locale: String
+        let calendar: String
+    }
+    
+    private let lockQueue = DispatchQueue(label: "org.sagebase.BridgeAppSDK.SBAFormatterCache")
+    private var formatters = [Key : Formatter]()
+    private var observers = [NSObjectProtocol]()
+    private let notificationCenter: NotificationCenter
+    
+    public init(notificationCenter: NotificationCenter = NotificationCenter.default) {
+        self.notificationCenter = notificationCenter
+        let names: [Notification.Name] = [NSLocale.currentLocaleDidChangeNotification, .NSSystemTimeZoneDidChange]
+        observers = names.map {
+            notificationCenter.addObserver(forName: $0, object: nil, queue: nil) { [weak self] _ in
+                self?.invalidate()
+            }
+        }
+    }
+    
+    deinit {
+        observers.forEach { notificationCenter.removeObserver($0) }
+    }
+    
+    /**
+     The number of formatters in the cache.
+     */
+    public var count: Int {
+        return lockQueue.sync { formatters.count }
+    }
+    
+    /**
+     Remove all the formatters. This is called automatically when the locale or time zone changes.
+     */
+    public func invalidate() {
+        lockQueue.sync {
+            formatters.removeAll()
+        }
+    }
+    
+    /**
+     A date formatter for a localized date format template, such as "Mdy".
+     */
+    public func dateFormatter(template: String, locale: Locale = Locale.current, calendar: Calendar = Calendar.current) -> DateFormatter {
+        return dateFormatter(kind: "template", pattern: template, locale: locale, calendar: calendar) { formatter in
+            formatter.setLocalizedDateFormatFromTemplate(template)
+        }
+    }
+    
+    /**
+     A date formatter for a fixed date format, such as "yyyy-MM-dd".
+     */
+    public func dateFormatter(format: String, locale: Locale = Locale.current, calendar: Calendar = Calendar.current) -> DateFormatter {
+        return dateFormatter(kind: "format", pattern: format, locale: locale, calendar: calendar) { formatter in
+            formatter.dateFormat = format
+        }
+    }
+    
+    /**
+     A date formatter for the given styles. This replaces `DateFormatter.localizedString(from:dateStyle:timeStyle:)`.
+     */
+    public func dateFormatter(dateStyle: DateFormatter.Style, timeStyle: DateFormatter.Style, locale: Locale = Locale.current, calendar: Calendar = Calendar.current) -> DateFormatter {
+        let pattern = "\(dateStyle.rawValue)-\(timeStyle.rawValue)"
+        return dateFormatter(kind: "style", pattern: pattern, locale: locale, calendar: calendar) { formatter in
+            formatter.dateStyle = dateStyle
+            formatter.timeStyle = timeStyle
+        }
+    }
+    
+    /**
+     A length formatter for a person's height.
+     */
+    public func personHeightFormatter(locale: Locale = Locale.current) -> LengthFormatter {
+        return formatter(Key(kind: "personHeight", pattern: "", locale: locale.identifier, calendar: "")) {
+            let formatter = LengthFormatter()
+            formatter.isForPersonHeightUse = true
+            formatter.numberFormatter.locale = locale
+            return formatter
+        }
+    }
+    
+    /**
+     A mass formatter for a person's weight.
+     */
+    public func personMassFormatter(locale: Locale = Locale.current) -> MassFormatter {
+        return formatter(Key(kind: "personMass", pattern: "", locale: locale.identifier, calendar: "")) {
+            let formatter = MassFormatter()
+            formatter.isForPersonMassUse = true
+            formatter.numberFormatter.locale = locale
+            return formatter
+        }
+    }
+    
+    /**
+     A number formatter with the given style.
+     */
+    public func numberFormatter(style: NumberFormatter.Style, locale: Locale = Locale.current) -> NumberFormatter {
+        return formatter(Key(kind: "number", pattern: "\(style.rawValue)", locale: locale.identifier, calendar: "")) {
+            let formatter = NumberFormatter()
+            formatter.numberStyle = style
+            formatter.locale = locale
+            return formatter
+        }
+    }
+    
+    // MARK: private methods
+    
+    private func dateFormatter(kind: String, pattern: String, locale: Locale, calendar: Calendar, configure: (DateFormatter) -> Void) -> DateFormatter {
+        let calendarKey = "\(calendar.identifier)-\(calendar.timeZone.identifier)"
+        return formatter(Key(kind: kind, pattern: pattern, locale: locale.identifier, calendar: calendarKey)) {
+            let formatter = DateFormatter()
+            formatter.locale = locale
+            formatter.calendar = calendar
+            formatter.timeZone = calendar.timeZone
+            configure(formatter)
+            return formatter
+        }
+    }
+    
+    private func formatter<T: Formatter>(_ key: Key, create: () -> T) -> T {
+        return lockQueue.sync {
+            if let formatter = formatters[key] as? T {
+                return formatter
+            }
+            let formatter = create()
+            formatters[key] = formatter
+            return formatter
+        }
+    }
+}
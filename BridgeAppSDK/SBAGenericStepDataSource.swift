@@ -60,6 +60,18 @@ import UIKit
 
 public protocol SBAGenericStepDataSourceDelegate {
     func answersDidChange()
+    
+    /**
+     Called once for each batch of answer changes with the identifiers of the form items that changed.
+     By default, this calls `answersDidChange()`.
+     */
+    func answersDidChange(for identifiers: Set<String>)
+}
+
+extension SBAGenericStepDataSourceDelegate {
+    public func answersDidChange(for identifiers: Set<String>) {
+        answersDidChange()
+    }
 }
 
 open class SBAGenericStepDataSource: NSObject {
@@ -68,6 +80,18 @@ open class SBAGenericStepDataSource: NSObject {
     open var sections: Array<SBAGenericStepTableSection> = Array()
     open var step: ORKStep?
     
+    // Lookup tables built when the sections are populated
+    fileprivate var itemGroupIndex: [String : SBAGenericStepTableItemGroup] = [:]
+    fileprivate var rowItemGroups: [[SBAGenericStepTableItemGroup]] = []
+    
+    // Identifiers of the item groups that do not have a valid answer, updated as each answer changes
+    fileprivate var invalidIdentifiers = Set<String>()
+    
+    // Changes are reported to the delegate once the outermost batch is finished
+    fileprivate var batchDepth = 0
+    fileprivate var changedIdentifiers = Set<String>()
+    fileprivate var hasPendingChanges = false
+    
     /**
      Initialize a new SBAGenericStepDataSource.
      @param  step       The ORKStep
@@ -91,10 +115,12 @@ open class SBAGenericStepDataSource: NSObject {
             let stepResults = stepResult.results as? [ORKQuestionResult] {
             
             // for each form item result, save the existing answer to our model
-            for result in stepResults {
-                let answer = result.answer ?? ORKNullAnswerValue()
-                if let group = itemGroup(with: result.identifier) {
-                    group.answer = answer as AnyObject
+            performBatchUpdates {
+                for result in stepResults {
+                    let answer = result.answer ?? ORKNullAnswerValue()
+                    if let group = itemGroup(with: result.identifier) {
+                        group.answer = answer as AnyObject
+                    }
                 }
             }
         }
@@ -105,33 +131,35 @@ open class SBAGenericStepDataSource: NSObject {
         
         // TODO: Josh Bruhin, 6/12/17 - implement. this may require access to a HealthKit source.
         
-        for section in sections {
-            section.itemGroups.forEach({
-                if let newAnswer = defaults[$0.formItem.identifier] {
-                    $0.defaultAnswer = newAnswer as AnyObject
+        performBatchUpdates {
+            for (key, newAnswer) in defaults {
+                if let identifier = key as? String, let group = itemGroup(with: identifier) {
+                    group.defaultAnswer = newAnswer as AnyObject
                 }
-            })
-        }
-        
-        // notify our delegate that the result changed
-        if let delegate = delegate {
-            delegate.answersDidChange()
+            }
+            
+            // notify our delegate that the result changed
+            hasPendingChanges = true
         }
     }
     
+    /**
+     Make several changes to the answers and notify the delegate once when they are all done.
+     @param   updates   The changes to make
+     */
+    open func performBatchUpdates(_ updates: () -> Void) {
+        batchDepth += 1
+        updates()
+        batchDepth -= 1
+        notifyDelegateIfNeeded()
+    }
+    
     /**
      Determine if all answers are valid. Also checks the case where answers are required but one has not been provided.
      @return    A Bool indicating if all answers are valid
      */
     open func allAnswersValid() -> Bool {
-        for section in sections {
-            for itemGroup in section.itemGroups {
-                if !itemGroup.isAnswerValid {
-                    return false
-                }
-            }
-        }
-        return true
+        return invalidIdentifiers.isEmpty
     }
     
     /**
@@ -140,14 +168,7 @@ open class SBAGenericStepDataSource: NSObject {
      @return               The requested SBAGenericStepTableItemGroup, or nil if it cannot be found
      */
     open func itemGroup(with identifier: String) -> SBAGenericStepTableItemGroup? {
-        for section in sections {
-            for itemGroup in section.itemGroups {
-                if itemGroup.formItem.identifier == identifier {
-                    return itemGroup
-                }
-            }
-        }
-        return nil
+        return itemGroupIndex[identifier]
     }
     
     /**
@@ -156,13 +177,21 @@ open class SBAGenericStepDataSource: NSObject {
      @return              The requested SBAGenericStepTableItemGroup, or nil if it cannot be found
      */
     open func itemGroup(at indexPath: IndexPath) -> SBAGenericStepTableItemGroup? {
-        let section = sections[indexPath.section]
-        for itemGroup in section.itemGroups {
-            if itemGroup.beginningRowIndex ... itemGroup.beginningRowIndex + (itemGroup.items.count - 1) ~= indexPath.row {
-                return itemGroup
-            }
+        guard indexPath.section < rowItemGroups.count, indexPath.row < rowItemGroups[indexPath.section].count
+            else {
+                return nil
         }
-        return nil
+        return rowItemGroups[indexPath.section][indexPath.row]
+    }
+    
+    /**
+     Retrieve the IndexPaths of the rows for a specific ORKFormItem identifier.
+     @param   identifier   The identifier of the ORKFormItem assigned to the ItemGroup
+     @return               The IndexPaths of the rows for the ItemGroup, or an empty array if it cannot be found
+     */
+    open func indexPaths(for identifier: String) -> [IndexPath] {
+        guard let itemGroup = itemGroup(with: identifier), let section = itemGroup.sectionIndex else { return [] }
+        return itemGroup.items.indices.map { IndexPath(row: itemGroup.beginningRowIndex + $0, section: section) }
     }
     
     /**
@@ -185,13 +214,9 @@ open class SBAGenericStepDataSource: NSObject {
      */
     open func saveAnswer(_ answer: AnyObject, at indexPath: IndexPath) {
         
+        // the delegate is informed by the item group that the answers have changed
         let itemGroup = self.itemGroup(at: indexPath)
         itemGroup?.answer = answer
-        
-        // inform delegate that answers have changed
-        if let delegate = delegate {
-            delegate.answersDidChange()
-        }
     }
     
     /**
@@ -200,13 +225,34 @@ open class SBAGenericStepDataSource: NSObject {
      */
     open func selectAnswer(selected: Bool, at indexPath: IndexPath) {
         
+        // the delegate is informed by the item group that the answers have changed
         let itemGroup = self.itemGroup(at: indexPath)
         itemGroup?.select(selected, indexPath: indexPath)
+    }
+    
+    /**
+     Called by an item group when its answer changes.
+     */
+    fileprivate func answerDidChange(for itemGroup: SBAGenericStepTableItemGroup) {
+        let identifier = itemGroup.formItem.identifier
+        if itemGroup.isAnswerValid {
+            invalidIdentifiers.remove(identifier)
+        } else {
+            invalidIdentifiers.insert(identifier)
+        }
+        changedIdentifiers.insert(identifier)
+        hasPendingChanges = true
+        notifyDelegateIfNeeded()
+    }
+    
+    fileprivate func notifyDelegateIfNeeded() {
+        guard batchDepth == 0, hasPendingChanges else { return }
+        let identifiers = changedIdentifiers
+        changedIdentifiers.removeAll()
+        hasPendingChanges = false
         
         // inform delegate that answers have changed
-        if let delegate = delegate {
-            delegate.answersDidChange()
-        }
+        delegate?.answersDidChange(for: identifiers)
     }
     
     /**
@@ -247,7 +293,7 @@ open class SBAGenericStepDataSource: NSObject {
                 continue
             }
             
-            let impliedAnswerFormat = formItem.answerFormat?.implied()
+            let impliedAnswerFormat = itemGroup(with: formItem.identifier)?.impliedAnswerFormat ?? formItem.answerFormat?.implied()
             
             if let dateAnswerFormat = impliedAnswerFormat as? ORKDateAnswerFormat,
                 let dateQuestionResult = result as? ORKDateQuestionResult,
@@ -295,8 +341,9 @@ open class SBAGenericStepDataSource: NSObject {
             
             // some form items need to be in their own section
             var needExclusiveSection = false
+            let impliedAnswerFormat = item.answerFormat?.implied()
             
-            if let answerFormat = item.answerFormat?.implied() {
+            if let answerFormat = impliedAnswerFormat {
 
                 let multiCellChoice = singleSelectionTypes.contains(answerFormat.questionType) && !(answerFormat is ORKValuePickerAnswerFormat)
                 let multiLineTextEntry = answerFormat.questionType == .text
@@ -307,16 +354,26 @@ open class SBAGenericStepDataSource: NSObject {
             
             // if we don't need an exclusive section and we have an existing section and it's not exclusive ('singleFormItem'),
             // then add this item to that existing section, otherwise create a new one
-            if !needExclusiveSection, let lastSection = sections.last, !lastSection.singleFormItem {
-                lastSection.add(formItem: item)
-            }
-            else {
-                let section = SBAGenericStepTableSection(sectionIndex: sections.count)
-                section.add(formItem: item)
+            var section: SBAGenericStepTableSection! = sections.last
+            if needExclusiveSection || section == nil || section.singleFormItem {
+                section = SBAGenericStepTableSection(sectionIndex: sections.count)
                 section.title = item.text
                 section.singleFormItem = needExclusiveSection
                 sections.append(section)
+                rowItemGroups.append([])
+            }
+            
+            guard let itemGroup = section.add(formItem: item, impliedAnswerFormat: impliedAnswerFormat) else { continue }
+            
+            // index the new item group
+            if itemGroupIndex[item.identifier] == nil {
+                itemGroupIndex[item.identifier] = itemGroup
             }
+            rowItemGroups[rowItemGroups.count - 1].append(contentsOf: repeatElement(itemGroup, count: itemGroup.items.count))
+            if !itemGroup.isAnswerValid {
+                invalidIdentifiers.insert(item.identifier)
+            }
+            itemGroup.dataSource = self
         }
     }
 }
@@ -353,21 +410,34 @@ open class SBAGenericStepTableSection: NSObject {
      @param   formItem    The ORKFormItem to add to the section
      */
     public func add(formItem: ORKFormItem) {
+        add(formItem: formItem, impliedAnswerFormat: formItem.answerFormat?.implied())
+    }
+    
+    @discardableResult
+    fileprivate func add(formItem: ORKFormItem, impliedAnswerFormat: ORKAnswerFormat?) -> SBAGenericStepTableItemGroup? {
         
-        guard itemGroups.sba_find({ $0.formItem.identifier == formItem.identifier }) == nil else {
+        guard !identifiers.contains(formItem.identifier) else {
             assertionFailure("Cannot add ORKFormItem with duplicate identifier.")
-            return
+            return nil
         }
         
-        itemGroups.append(SBAGenericStepTableItemGroup(formItem: formItem, beginningRowIndex: itemCount()))
+        let itemGroup = SBAGenericStepTableItemGroup(formItem: formItem, impliedAnswerFormat: impliedAnswerFormat, beginningRowIndex: _itemCount)
+        itemGroup.sectionIndex = index
+        itemGroups.append(itemGroup)
+        identifiers.insert(formItem.identifier)
+        _itemCount += itemGroup.items.count
+        return itemGroup
     }
     
+    private var identifiers = Set<String>()
+    private var _itemCount = 0
+    
     /**
      Returns the total count of all Items in this section.
      @return    The total number of SBAGenericStepTableItems in this section
      */
     public func itemCount() -> Int {
-        return itemGroups.reduce(0, {$0 + $1.items.count})
+        return _itemCount
     }
 }
 
@@ -378,6 +448,13 @@ open class SBAGenericStepTableItemGroup: NSObject {
     
     var items: [SBAGenericStepTableItem]!
     var beginningRowIndex = 0
+    var sectionIndex: Int?
+    
+    // the implied answer format is built once rather than each time it is needed
+    let impliedAnswerFormat: ORKAnswerFormat?
+    
+    // the data source is told when the answer changes so that it can update the validity of the answers
+    weak var dataSource: SBAGenericStepDataSource?
     
     var singleSelection: Bool = true
     
@@ -385,7 +462,9 @@ open class SBAGenericStepTableItemGroup: NSObject {
     var calendar = Calendar.current
     var timezone = TimeZone.current
     
-    var defaultAnswer: Any = ORKNullAnswerValue() as Any
+    var defaultAnswer: Any = ORKNullAnswerValue() as Any {
+        didSet { dataSource?.answerDidChange(for: self) }
+    }
     private var _answer: Any?
     
     /**
@@ -394,7 +473,10 @@ open class SBAGenericStepTableItemGroup: NSObject {
      */
     public var answer: Any! {
         get { return internalAnswer() }
-        set { setInternalAnswer(newValue) }
+        set {
+            setInternalAnswer(newValue)
+            dataSource?.answerDidChange(for: self)
+        }
     }
     
     /**
@@ -408,7 +490,7 @@ open class SBAGenericStepTableItemGroup: NSObject {
             return false
         }
         
-        return formItem.answerFormat?.implied().isAnswerValid(answer) ?? false
+        return impliedAnswerFormat?.isAnswerValid(answer) ?? false
     }
     
     /**
@@ -416,19 +498,21 @@ open class SBAGenericStepTableItemGroup: NSObject {
      @param  formItem   The ORKFormItem to add to the model
      @param  beginningRowIndex  The row index in the section at which this formItem begins
      */
-    fileprivate init(formItem: ORKFormItem, beginningRowIndex: Int) {
+    fileprivate init(formItem: ORKFormItem, impliedAnswerFormat: ORKAnswerFormat?, beginningRowIndex: Int) {
         
         self.formItem = formItem
+        self.impliedAnswerFormat = impliedAnswerFormat
+        self.beginningRowIndex = beginningRowIndex
         
         super.init()
         
-        if let textChoiceAnswerFormat = formItem.answerFormat?.implied() as? ORKTextChoiceAnswerFormat {
+        if let textChoiceAnswerFormat = impliedAnswerFormat as? ORKTextChoiceAnswerFormat {
             singleSelection = textChoiceAnswerFormat.style == .singleChoice
             self.items = textChoiceAnswerFormat.textChoices.enumerated().map { (index, _) -> SBAGenericStepTableItem in
-                SBAGenericStepTableItem(formItem: formItem, choiceIndex: index, rowIndex: beginningRowIndex + index)
+                SBAGenericStepTableItem(formItem: formItem, answerFormat: impliedAnswerFormat, choiceIndex: index, rowIndex: beginningRowIndex + index)
             }
         } else {
-            let tableItem = SBAGenericStepTableItem(formItem: formItem, choiceIndex: 0, rowIndex: beginningRowIndex)
+            let tableItem = SBAGenericStepTableItem(formItem: formItem, answerFormat: impliedAnswerFormat, choiceIndex: 0, rowIndex: beginningRowIndex)
             self.items = [tableItem]
         }
         
@@ -454,6 +538,8 @@ open class SBAGenericStepTableItemGroup: NSObject {
                 item.selected = (ii == index)
             }
         }
+        
+        dataSource?.answerDidChange(for: self)
     }
     
     fileprivate func internalAnswer() -> Any {
@@ -552,9 +638,10 @@ open class SBAGenericStepTableItem: NSObject {
      @param   choiceIndex   The index of this item relative to all the choices in this ItemGroup
      @param   rowIndex      The index of this item relative to all rows in the section in which this item resides
      */
-    fileprivate init(formItem: ORKFormItem!, choiceIndex: Int, rowIndex: Int) {
+    fileprivate init(formItem: ORKFormItem!, answerFormat: ORKAnswerFormat?, choiceIndex: Int, rowIndex: Int) {
         super.init()
-        commonInit(formItem: formItem)
+        self.formItem = formItem
+        self.answerFormat = answerFormat
         self.choiceIndex = choiceIndex
         self.rowIndex = rowIndex
         if let textChoiceFormat = textChoiceAnswerFormat() {
@@ -47,6 +47,15 @@
 
 @property (nonatomic, copy) NSString *guid;
 
+/**
+ The key used to recognize this item in later fetches. This is the `guid` if there is one, otherwise the `link`.
+ */
+@property (nonatomic, readonly) NSString *identifier;
+
+- (instancetype)initWithDictionaryRepresentation:(NSDictionary *)dictionary;
+
+- (NSDictionary *)dictionaryRepresentation;
+
 - (NSArray *)imageURLsFromContent;
 
 - (NSArray *)imageURLsFromItemDescription;
@@ -31,6 +31,14 @@
 
 #import "SBANewsFeedItem.h"
 
+static NSString * const kTitleKey           = @"title";
+static NSString * const kLinkKey            = @"link";
+static NSString * const kItemDescriptionKey = @"itemDescription";
+static NSString * const kContentKey         = @"content";
+static NSString * const kPubDateKey         = @"pubDate";
+static NSString * const kAuthorKey          = @"author";
+static NSString * const kGuidKey            = @"guid";
+
 @implementation SBANewsFeedItem
 
 - (instancetype)init
@@ -46,6 +54,45 @@
     return self;
 }
 
+- (instancetype)initWithDictionaryRepresentation:(NSDictionary *)dictionary
+{
+    self = [self init];
+    if (self) {
+        _title = [dictionary[kTitleKey] copy] ?: @"";
+        _link = [dictionary[kLinkKey] copy] ?: @"";
+        _itemDescription = [dictionary[kItemDescriptionKey] copy] ?: @"";
+        _content = [dictionary[kContentKey] copy] ?: @"";
+        _author = [dictionary[kAuthorKey] copy];
+        _guid = [dictionary[kGuidKey] copy];
+        
+        NSNumber *pubDate = dictionary[kPubDateKey];
+        if (pubDate != nil) {
+            _pubDate = [NSDate dateWithTimeIntervalSince1970:[pubDate doubleValue]];
+        }
+    }
+    return self;
+}
+
+- (NSDictionary *)dictionaryRepresentation
+{
+    NSMutableDictionary *dictionary = [NSMutableDictionary new];
+    dictionary[kTitleKey] = self.title;
+    dictionary[kLinkKey] = self.link;
+    dictionary[kItemDescriptionKey] = self.itemDescription;
+    dictionary[kContentKey] = self.content;
+    dictionary[kAuthorKey] = self.author;
+    dictionary[kGuidKey] = self.guid;
+    if (self.pubDate != nil) {
+        dictionary[kPubDateKey] = @([self.pubDate timeIntervalSince1970]);
+    }
+    return [dictionary copy];
+}
+
+- (NSString *)identifier
+{
+    return (self.guid.length > 0) ? self.guid : (self.link ?: @"");
+}
+
 - (NSArray *)imageURLsFromItemDescription
 {
     NSArray *images = nil;
@@ -41,11 +41,27 @@ FOUNDATION_EXPORT NSString * const SBANewsFeedUpdateNotificationKey;
 typedef void (^SBANewsFeedManagerCompletionBlock)(NSArray * _Nullable  posts, NSError * _Nullable error);
 
 @class SBANewsFeedItem;
+@class SBANewsFeedParser;
 
 @interface SBANewsFeedManager : NSObject
 
+/**
+ The current posts. Setting this updates the unread count and forgets read posts that are no
+ longer in the feed.
+ */
 @property (nonatomic, strong, nullable) NSArray<SBANewsFeedItem *> *feedPosts;
 
+- (instancetype)init;
+
+/**
+ @param feedParser      The parser used to fetch the feed.
+ @param userDefaults    The defaults where the read posts are saved.
+ */
+- (instancetype)initWithFeedParser:(SBANewsFeedParser *)feedParser userDefaults:(NSUserDefaults *)userDefaults NS_DESIGNATED_INITIALIZER;
+
+/**
+ The number of posts in `feedPosts` that the user has not read.
+ */
 - (NSUInteger)unreadPostsCount;
 
 - (void)fetchFeedWithCompletion:(SBANewsFeedManagerCompletionBlock _Nullable)completion;
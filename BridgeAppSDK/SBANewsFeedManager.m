@@ -34,7 +34,9 @@
 
 
 #import "SBANewsFeedManager.h"
+#import "SBANewsFeedItem.h"
 #import "SBANewsFeedParser.h"
+#import "SBANewsFeedStore.h"
 #import "SBALog.h"
 #import <BridgeAppSDK/BridgeAppSDK-Swift.h>
 
@@ -43,39 +45,69 @@ NSString * const SBANewsFeedUpdateNotificationKey = @"SBANewsFeedUpdateNotificat
 static NSString * const kAPCReadPostsKey = @"ReadPostsKey";
 static NSString * const kAPCBlogUrlKey   = @"BlogUrlKey";
 
+static NSTimeInterval const kSaveReadPostsDelay = 2.0;
+
 @interface SBANewsFeedManager()
 
 @property (nonatomic, strong) SBANewsFeedParser *feedParser;
 
-@property (nonatomic, strong) NSArray *readPosts;
+@property (nonatomic, strong) NSUserDefaults *userDefaults;
+
+@property (nonatomic, strong) NSMutableSet<NSString *> *readPosts;
+@property (nonatomic, strong) NSSet<NSString *> *feedPostURLs;
+@property (nonatomic, assign) NSUInteger unreadCount;
+@property (nonatomic, assign) BOOL saveScheduled;
 
 @end
 
 @implementation SBANewsFeedManager
 
 - (instancetype)init
+{
+    id <SBAAppInfoDelegate> appDelegate = (id <SBAAppInfoDelegate>)[[UIApplication sharedApplication] delegate];
+    NSString *urlString = [[appDelegate bridgeInfo] newsfeedURLString];
+    SBANewsFeedParser *feedParser = [[SBANewsFeedParser alloc] initWithFeedURL:[NSURL URLWithString:urlString]];
+    
+    return [self initWithFeedParser:feedParser userDefaults:[NSUserDefaults standardUserDefaults]];
+}
+
+- (instancetype)initWithFeedParser:(SBANewsFeedParser *)feedParser userDefaults:(NSUserDefaults *)userDefaults
 {
     self = [super init];
     if (self) {
         
-        id <SBAAppInfoDelegate> appDelegate = (id <SBAAppInfoDelegate>)[[UIApplication sharedApplication] delegate];
-        NSString *urlString = [[appDelegate bridgeInfo] newsfeedURLString];
-        _feedParser = [[SBANewsFeedParser alloc] initWithFeedURL:[NSURL URLWithString:urlString]];
+        _feedParser = feedParser;
+        _userDefaults = userDefaults;
         
-        NSString *savedBlogUrl = [[NSUserDefaults standardUserDefaults] stringForKey:kAPCBlogUrlKey];
+        NSString *urlString = feedParser.feedURL.absoluteString;
+        NSString *savedBlogUrl = [userDefaults stringForKey:kAPCBlogUrlKey];
         
         //Clear read links if blog URL has changed.
         if (![savedBlogUrl isEqualToString:urlString]) {
-            [[NSUserDefaults standardUserDefaults] removeObjectForKey:kAPCReadPostsKey];
-            
-            [[NSUserDefaults standardUserDefaults] setObject:urlString forKey:kAPCBlogUrlKey];
-            [[NSUserDefaults standardUserDefaults] synchronize];
+            [userDefaults removeObjectForKey:kAPCReadPostsKey];
+            [userDefaults setObject:urlString forKey:kAPCBlogUrlKey];
         }
         
+        _readPosts = [NSMutableSet setWithArray:[userDefaults arrayForKey:kAPCReadPostsKey] ?: @[]];
+        _feedPostURLs = [NSSet set];
+        
+        // Show the stored posts until the next fetch
+        [feedParser.store resetForFeedURL:feedParser.feedURL];
+        self.feedPosts = feedParser.store.items;
+        
+        // Save any pending changes before the app is suspended
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(saveReadPosts) name:UIApplicationDidEnterBackgroundNotification object:nil];
+        [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(saveReadPosts) name:UIApplicationWillTerminateNotification object:nil];
     }
     return self;
 }
 
+- (void)dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    [self saveReadPosts];
+}
+
 /**********************************/
 #pragma mark - Public methods
 /**********************************/
@@ -88,7 +120,10 @@ static NSString * const kAPCBlogUrlKey   = @"BlogUrlKey";
         
         __strong typeof(self) strongSelf = weakSelf;
         
-        strongSelf.feedPosts = results;
+        // Keep showing the stored posts if the fetch failed
+        if (results != nil) {
+            strongSelf.feedPosts = results;
+        }
         
         SBALogError2(error);
         
@@ -109,36 +144,73 @@ static NSString * const kAPCBlogUrlKey   = @"BlogUrlKey";
 - (void)userDidReadPostWithURL:(NSString *)postURL
 {
     if (![self.readPosts containsObject:postURL]) {
-        NSMutableArray *readPosts = [[NSMutableArray alloc] initWithArray:self.readPosts];
-        [readPosts addObject:postURL];
-        self.readPosts = [NSArray arrayWithArray:readPosts];
+        [self.readPosts addObject:postURL];
+        if ([self.feedPostURLs containsObject:postURL]) {
+            self.unreadCount--;
+        }
+        [self scheduleSaveReadPosts];
         [[NSNotificationCenter defaultCenter] postNotificationName:SBANewsFeedUpdateNotificationKey object:self];
     }
 }
 
 - (NSUInteger)unreadPostsCount
 {
-    NSUInteger totalCount = (self.feedPosts) ? [self.feedPosts count] : 0;
-    NSUInteger readCount = (self.readPosts) ? MIN([self.readPosts count], totalCount)  : 0;
+    return self.unreadCount;
+}
+
+/**********************************/
+#pragma mark - Getter/Setter methods
+/**********************************/
+
+- (void)setFeedPosts:(NSArray<SBANewsFeedItem *> *)feedPosts
+{
+    _feedPosts = feedPosts;
+    
+    NSMutableSet *feedPostURLs = [NSMutableSet setWithCapacity:feedPosts.count];
+    for (SBANewsFeedItem *post in feedPosts) {
+        if (post.link.length > 0) {
+            [feedPostURLs addObject:post.link];
+        }
+    }
+    self.feedPostURLs = feedPostURLs;
     
-    NSUInteger unreadCount = totalCount - readCount;
+    // Forget posts that have dropped out of the feed. An empty feed is most likely a failed load
+    // so keep everything in that case.
+    if ((feedPostURLs.count > 0) && ![self.readPosts isSubsetOfSet:feedPostURLs]) {
+        [self.readPosts intersectSet:feedPostURLs];
+        [self scheduleSaveReadPosts];
+    }
     
-    return unreadCount;
+    NSMutableSet *unreadPosts = [feedPostURLs mutableCopy];
+    [unreadPosts minusSet:self.readPosts];
+    self.unreadCount = unreadPosts.count;
 }
 
 /**********************************/
-#pragma mark - Getter/Setter methods
+#pragma mark - Private methods
 /**********************************/
 
-- (NSArray *)readPosts
+- (void)scheduleSaveReadPosts
 {
-    return [[NSUserDefaults standardUserDefaults] arrayForKey:kAPCReadPostsKey];
+    // Coalesce the writes from reading several posts in a row
+    if (self.saveScheduled) {
+        return;
+    }
+    self.saveScheduled = YES;
+    
+    __weak typeof(self) weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kSaveReadPostsDelay * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        [weakSelf saveReadPosts];
+    });
 }
 
-- (void)setReadPosts:(NSArray *)readPosts
+- (void)saveReadPosts
 {
-    [[NSUserDefaults standardUserDefaults] setObject:readPosts forKey:kAPCReadPostsKey];
-    [[NSUserDefaults standardUserDefaults] synchronize];
+    if (!self.saveScheduled) {
+        return;
+    }
+    self.saveScheduled = NO;
+    [self.userDefaults setObject:[self.readPosts allObjects] forKey:kAPCReadPostsKey];
 }
 
 @end
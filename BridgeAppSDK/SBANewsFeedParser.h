@@ -33,13 +33,33 @@
 
 typedef void (^SBANewsFeedParserCompletionBlock)(NSArray* results, NSError *error);
 
+FOUNDATION_EXPORT NSString * const SBANewsFeedParserErrorDomain;
+
+@class SBANewsFeedStore;
+
+/**
+ `SBANewsFeedParser` fetches an RSS or Atom feed and merges it into an `SBANewsFeedStore`.
+ 
+ The request includes the `ETag` and `Last-Modified` values of the previous response so that an
+ unchanged feed returns `304 Not Modified` without a body. Otherwise, the response is parsed as it
+ is downloaded and parsing stops at the first item that is already in the store. This assumes the
+ feed lists the newest items first.
+ */
 @interface SBANewsFeedParser : NSObject
 
 @property (nonatomic, strong) NSURL *feedURL;
 
+@property (nonatomic, strong, readonly) SBANewsFeedStore *store;
+
 - (instancetype)initWithFeedURL:(NSURL *)feedURL;
 
+- (instancetype)initWithFeedURL:(NSURL *)feedURL
+                          store:(SBANewsFeedStore *)store
+           sessionConfiguration:(NSURLSessionConfiguration *)sessionConfiguration;
+
+/**
+ Fetch the feed. The completion is called on the main queue with all the stored items.
+ */
 - (void)fetchFeedWithCompletion:(SBANewsFeedParserCompletionBlock)completion;
 
 @end
-
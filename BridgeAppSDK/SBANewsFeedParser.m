@@ -31,24 +31,121 @@
 
 #import "SBANewsFeedParser.h"
 #import "SBANewsFeedItem.h"
+#import "SBANewsFeedStore.h"
+
+NSString * const SBANewsFeedParserErrorDomain = @"SBANewsFeedParserError";
 
 static NSString * const kAPCDateFormatLocale_EN_US_POSIX = @"en_US_POSIX";
 static NSString * const kAPCFeedDateFormat               = @"EEE, dd MMM yyyy HH:mm:ss Z";
 
+static NSUInteger const kFeedStreamBufferSize = 64 * 1024;
+
+static NSString * headerValue(NSHTTPURLResponse *response, NSString *field)
+{
+    // Header names are not case-sensitive and Foundation may change the case (ETag -> Etag)
+    for (NSString *key in response.allHeaderFields) {
+        if ([key caseInsensitiveCompare:field] == NSOrderedSame) {
+            return response.allHeaderFields[key];
+        }
+    }
+    return nil;
+}
+
+/**
+ The session delegate for a single fetch. The response body is written to a bound stream pair
+ so that the parser can read it as it arrives.
+ */
+@interface SBANewsFeedDownload : NSObject <NSURLSessionDataDelegate>
+
+@property (nonatomic, strong, readonly) NSOutputStream *outputStream;
+
+@property (atomic, assign) BOOL finished;
+@property (atomic, assign) BOOL notModified;
+@property (atomic, copy) NSString *entityTag;
+@property (atomic, copy) NSString *lastModified;
+@property (atomic, strong) NSError *error;
+
+- (instancetype)initWithOutputStream:(NSOutputStream *)outputStream;
+
+@end
+
+@implementation SBANewsFeedDownload
+
+- (instancetype)initWithOutputStream:(NSOutputStream *)outputStream
+{
+    self = [super init];
+    if (self) {
+        _outputStream = outputStream;
+    }
+    return self;
+}
+
+- (void)URLSession:(NSURLSession *)__unused session dataTask:(NSURLSessionDataTask *)__unused dataTask didReceiveResponse:(NSURLResponse *)response completionHandler:(void (^)(NSURLSessionResponseDisposition))completionHandler
+{
+    if ([response isKindOfClass:[NSHTTPURLResponse class]]) {
+        NSHTTPURLResponse *httpResponse = (NSHTTPURLResponse *)response;
+        if (httpResponse.statusCode == 304) {
+            self.notModified = YES;
+        } else if ((httpResponse.statusCode < 200) || (httpResponse.statusCode >= 300)) {
+            self.error = [NSError errorWithDomain:SBANewsFeedParserErrorDomain
+                                             code:httpResponse.statusCode
+                                         userInfo:@{NSLocalizedDescriptionKey : [NSHTTPURLResponse localizedStringForStatusCode:httpResponse.statusCode]}];
+        } else {
+            self.entityTag = headerValue(httpResponse, @"ETag");
+            self.lastModified = headerValue(httpResponse, @"Last-Modified");
+        }
+    }
+    
+    if (self.notModified || (self.error != nil)) {
+        // There is nothing to parse
+        [self.outputStream close];
+        completionHandler(NSURLSessionResponseCancel);
+    } else {
+        completionHandler(NSURLSessionResponseAllow);
+    }
+}
+
+- (void)URLSession:(NSURLSession *)__unused session dataTask:(NSURLSessionDataTask *)__unused dataTask didReceiveData:(NSData *)data
+{
+    [data enumerateByteRangesUsingBlock:^(const void *bytes, NSRange byteRange, BOOL *stop) {
+        NSUInteger offset = 0;
+        while ((offset < byteRange.length) && !self.finished) {
+            // This blocks until the parser has read enough to make room in the buffer
+            NSInteger written = [self.outputStream write:(const uint8_t *)bytes + offset maxLength:byteRange.length - offset];
+            if (written <= 0) {
+                *stop = YES;
+                return;
+            }
+            offset += (NSUInteger)written;
+        }
+        *stop = self.finished;
+    }];
+}
+
+- (void)URLSession:(NSURLSession *)__unused session task:(NSURLSessionTask *)__unused task didCompleteWithError:(NSError *)error
+{
+    if ((error != nil) && !self.finished && !self.notModified && (self.error == nil)) {
+        self.error = error;
+    }
+    [self.outputStream close];
+}
+
+@end
+
 @interface SBANewsFeedParser() <NSXMLParserDelegate>
 
-@property (nonatomic, copy) SBANewsFeedParserCompletionBlock completionBlock;
+@property (nonatomic, strong) NSURLSessionConfiguration *sessionConfiguration;
 
-@property (nonatomic, strong) NSMutableArray *results;
+@property (nonatomic, strong) NSMutableArray<SBANewsFeedItem *> *parsedItems;
+@property (nonatomic, assign) BOOL stoppedAtKnownItem;
 
-@property (nonatomic, strong) NSXMLParser *parser;
-@property (nonatomic, strong) NSString *currentElement;
 @property (nonatomic, strong) NSDictionary *attributeDict;
 @property (nonatomic, strong) NSMutableString *parsedString;
 
 @property (nonatomic, strong) SBANewsFeedItem *feedItem;
 
 @property (nonatomic, strong) NSDateFormatter *dateFormatter;
+@property (nonatomic, strong) NSISO8601DateFormatter *atomDateFormatter;
 
 @end
 
@@ -66,149 +163,198 @@ dispatch_queue_t feedDispatchQueue()
 @implementation SBANewsFeedParser
 
 - (instancetype)initWithFeedURL:(NSURL *)feedURL
+{
+    // The store keeps the items and validators, so the session does not also need to cache the response
+    NSURLSessionConfiguration *configuration = [NSURLSessionConfiguration defaultSessionConfiguration];
+    configuration.URLCache = nil;
+    
+    SBANewsFeedStore *store = [[SBANewsFeedStore alloc] initWithFileURL:[SBANewsFeedStore defaultFileURL]];
+    
+    return [self initWithFeedURL:feedURL store:store sessionConfiguration:configuration];
+}
+
+- (instancetype)initWithFeedURL:(NSURL *)feedURL store:(SBANewsFeedStore *)store sessionConfiguration:(NSURLSessionConfiguration *)sessionConfiguration
 {
     self = [super init];
     if (self) {
         _feedURL = feedURL;
+        _store = store;
+        _sessionConfiguration = [sessionConfiguration copy];
         
-        _completionBlock = nil;
-        
-        _results = [NSMutableArray new];
+        _parsedItems = [NSMutableArray new];
+        _parsedString = [NSMutableString new];
         
         _dateFormatter = [NSDateFormatter new];
         [_dateFormatter setLocale:[[NSLocale alloc] initWithLocaleIdentifier:kAPCDateFormatLocale_EN_US_POSIX]];
         _dateFormatter.dateFormat = kAPCFeedDateFormat;
+        
+        _atomDateFormatter = [NSISO8601DateFormatter new];
     }
     return self;
 }
 
-- (void)setupParser
-{
-    if (self.parser) {
-        self.parser = nil;
-    }
-    
-    self.parser = [[NSXMLParser alloc] initWithContentsOfURL:self.feedURL];
-    self.parser.delegate = self;
-    self.parser.shouldResolveExternalEntities = NO;
-}
-
 - (void)fetchFeedWithCompletion:(SBANewsFeedParserCompletionBlock)completion
 {
     dispatch_async(feedDispatchQueue(), ^{
-
-        [self setupParser];
-        
-        [self.results removeAllObjects];
         
-        self.completionBlock = completion;
+        NSError *error = nil;
+        NSArray *results = [self fetchFeedWithError:&error];
         
-        BOOL success = [self.parser parse];
-        
-        if (!success) {
-            dispatch_async(dispatch_get_main_queue(), ^{
-                if (self.completionBlock) {
-                    self.completionBlock(nil, self.parser.parserError);
-                }
-            });
-        }
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (completion) {
+                completion(results, error);
+            }
+        });
     });
 }
 
+- (NSArray *)fetchFeedWithError:(NSError **)error
+{
+    [self.store resetForFeedURL:self.feedURL];
+    
+    [self.parsedItems removeAllObjects];
+    self.stoppedAtKnownItem = NO;
+    self.feedItem = nil;
+    
+    NSInputStream *inputStream = nil;
+    NSOutputStream *outputStream = nil;
+    [NSStream getBoundStreamsWithBufferSize:kFeedStreamBufferSize inputStream:&inputStream outputStream:&outputStream];
+    [outputStream open];
+    
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:self.feedURL];
+    request.cachePolicy = NSURLRequestReloadIgnoringLocalCacheData;
+    [request setValue:self.store.entityTag forHTTPHeaderField:@"If-None-Match"];
+    [request setValue:self.store.lastModified forHTTPHeaderField:@"If-Modified-Since"];
+    
+    // Use a session for each fetch so that late callbacks cannot write to the stream of the next fetch
+    SBANewsFeedDownload *download = [[SBANewsFeedDownload alloc] initWithOutputStream:outputStream];
+    NSOperationQueue *delegateQueue = [NSOperationQueue new];
+    delegateQueue.maxConcurrentOperationCount = 1;
+    NSURLSession *session = [NSURLSession sessionWithConfiguration:self.sessionConfiguration delegate:download delegateQueue:delegateQueue];
+    NSURLSessionDataTask *task = [session dataTaskWithRequest:request];
+    [task resume];
+    
+    // Parse on this queue while the body is written to the stream on the delegate queue
+    NSXMLParser *parser = [[NSXMLParser alloc] initWithStream:inputStream];
+    parser.delegate = self;
+    parser.shouldResolveExternalEntities = NO;
+    BOOL success = [parser parse];
+    
+    // If parsing stopped early then the rest of the body is not needed. Closing the input stream
+    // releases a write that is waiting for space in the buffer.
+    download.finished = YES;
+    [task cancel];
+    [inputStream close];
+    [session finishTasksAndInvalidate];
+    
+    self.feedItem = nil;
+    
+    if (download.error != nil) {
+        if (error) {
+            *error = download.error;
+        }
+        return nil;
+    }
+    
+    if (download.notModified) {
+        return self.store.items;
+    }
+    
+    if (!success && !self.stoppedAtKnownItem) {
+        if (error) {
+            *error = parser.parserError;
+        }
+        return nil;
+    }
+    
+    NSArray *results = [self.store mergeItems:self.parsedItems entityTag:download.entityTag lastModified:download.lastModified];
+    [self.parsedItems removeAllObjects];
+    
+    return results;
+}
+
 #pragma mark - NSXMLParserDelegate methods
 
 - (void)parser:(NSXMLParser *)__unused parser didStartElement:(NSString *)elementName namespaceURI:(NSString *)__unused namespaceURI qualifiedName:(NSString *)__unused qName attributes:(NSDictionary *)attributeDict
 {
-    self.currentElement = elementName;
     self.attributeDict = attributeDict;
     
     if ([elementName isEqualToString:@"item"] || [elementName isEqualToString:@"entry"]) {
         self.feedItem = [SBANewsFeedItem new];
     }
     
-    self.parsedString = [NSMutableString new];
+    // Reuse the same buffer for every element. The item properties keep a copy.
+    [self.parsedString setString:@""];
 }
 
 - (void)parser:(NSXMLParser *)__unused parser foundCharacters:(NSString *)string
 {
-    [self.parsedString appendString:string];
+    if (self.feedItem != nil) {
+        [self.parsedString appendString:string];
+    }
 }
 
-- (void)parser:(NSXMLParser *)__unused parser didEndElement:(NSString *)elementName namespaceURI:(NSString *)__unused namespaceURI qualifiedName:(NSString *)__unused qName
+- (void)parser:(NSXMLParser *)__unused parser foundCDATA:(NSData *)CDATABlock
 {
-    if ([elementName isEqualToString:@"item"] || [elementName isEqualToString:@"entry"]) {
-        [self.results addObject:self.feedItem];
-    }
-    
-    if (self.feedItem != nil && self.parsedString != nil) {
-        if ([elementName isEqualToString:@"title"]) {
-            self.feedItem.title = self.parsedString;
-        } else if ([elementName isEqualToString:@"description"]) {
-            self.feedItem.itemDescription = self.parsedString;
-        } else if ([elementName isEqualToString:@"content:encoded"] || [elementName isEqualToString:@"content"]) {
-            self.feedItem.content = self.parsedString;
-        } else if ([elementName isEqualToString:@"link"]) {
-            self.feedItem.link = self.parsedString;
-        } else if ([elementName isEqualToString:@"pubDate"]) {
-            _dateFormatter.dateFormat = kAPCFeedDateFormat;
-            self.feedItem.pubDate = [self.dateFormatter dateFromString:self.parsedString];
-        } else if ([elementName isEqualToString:@"dc:creator"]) {
-            self.feedItem.author = self.parsedString;
-        } else if ([elementName isEqualToString:@"guid"]) {
-            self.feedItem.guid = self.parsedString;
-        }
-        
-        // sometimes the URL is inside enclosure element, not in link. Reference: http://www.w3schools.com/rss/rss_tag_enclosure.asp
-        if ([elementName isEqualToString:@"enclosure"] && self.attributeDict != nil) {
-            NSString *url = [self.attributeDict objectForKey:@"url"];
-            if(url) {
-                self.feedItem.link = url;
-            }
+    if (self.feedItem != nil) {
+        NSString *string = [[NSString alloc] initWithData:CDATABlock encoding:NSUTF8StringEncoding];
+        if (string != nil) {
+            [self.parsedString appendString:string];
         }
     }
 }
 
-- (void)parserDidEndDocument:(NSXMLParser *)__unused parser
+- (void)parser:(NSXMLParser *)parser didEndElement:(NSString *)elementName namespaceURI:(NSString *)__unused namespaceURI qualifiedName:(NSString *)__unused qName
 {
-    __weak typeof(self) weakSelf = self;
+    if (self.feedItem == nil) {
+        return;
+    }
     
-    dispatch_async(dispatch_get_main_queue(), ^{
-        
-        __strong typeof(self) strongSelf = weakSelf;
-        
-        if (strongSelf.completionBlock) {
-            strongSelf.completionBlock([NSArray arrayWithArray:strongSelf.results], nil);
+    if ([elementName isEqualToString:@"item"] || [elementName isEqualToString:@"entry"]) {
+        NSString *identifier = self.feedItem.identifier;
+        if ((identifier.length > 0) && [self.store containsItemWithIdentifier:identifier]) {
+            // Everything from here on has already been stored
+            self.stoppedAtKnownItem = YES;
+            [parser abortParsing];
+        } else {
+            [self.parsedItems addObject:self.feedItem];
         }
-    });
-}
-
-- (void)parser:(NSXMLParser *)parser parseErrorOccurred:(NSError *)parseError
-{
-    __weak typeof(self) weakSelf = self;
+        self.feedItem = nil;
+        return;
+    }
     
-    dispatch_async(dispatch_get_main_queue(), ^{
-        if (weakSelf.completionBlock) {
-            weakSelf.completionBlock(nil, parseError);
+    if ([elementName isEqualToString:@"title"]) {
+        self.feedItem.title = self.parsedString;
+    } else if ([elementName isEqualToString:@"description"] || [elementName isEqualToString:@"summary"]) {
+        self.feedItem.itemDescription = self.parsedString;
+    } else if ([elementName isEqualToString:@"content:encoded"] || [elementName isEqualToString:@"content"]) {
+        self.feedItem.content = self.parsedString;
+    } else if ([elementName isEqualToString:@"link"]) {
+        // Atom links are in the href attribute
+        NSString *href = self.attributeDict[@"href"];
+        NSString *rel = self.attributeDict[@"rel"];
+        if (href == nil) {
+            self.feedItem.link = self.parsedString;
+        } else if ((rel == nil) || [rel isEqualToString:@"alternate"]) {
+            self.feedItem.link = href;
         }
-    });
-    
-    [parser abortParsing];
-}
-
-- (void)parser:(NSXMLParser *)parser validationErrorOccurred:(NSError *)validationError
-{
-    __weak typeof(self) weakSelf = self;
+    } else if ([elementName isEqualToString:@"pubDate"]) {
+        self.feedItem.pubDate = [self.dateFormatter dateFromString:self.parsedString];
+    } else if ([elementName isEqualToString:@"published"] || ([elementName isEqualToString:@"updated"] && (self.feedItem.pubDate == nil))) {
+        self.feedItem.pubDate = [self.atomDateFormatter dateFromString:self.parsedString];
+    } else if ([elementName isEqualToString:@"dc:creator"] || [elementName isEqualToString:@"name"]) {
+        self.feedItem.author = self.parsedString;
+    } else if ([elementName isEqualToString:@"guid"] || [elementName isEqualToString:@"id"]) {
+        self.feedItem.guid = self.parsedString;
+    }
     
-    dispatch_async(dispatch_get_main_queue(), ^{
-        if (weakSelf.completionBlock) {
-            weakSelf.completionBlock(nil, validationError);
+    // sometimes the URL is inside enclosure element, not in link. Reference: http://www.w3schools.com/rss/rss_tag_enclosure.asp
+    if ([elementName isEqualToString:@"enclosure"] && self.attributeDict != nil) {
+        NSString *url = [self.attributeDict objectForKey:@"url"];
+        if(url) {
+            self.feedItem.link = url;
         }
-    });
-    
-    [parser abortParsing];
+    }
 }
                          
 @end
-
-
-
@@ -0,0 +1,118 @@
+//
+//  SBANewsFeedStore.h
+//  BridgeAppSDK
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class SBANewsFeedItem;
+
+/**
+ `SBANewsFeedStore` holds the items fetched from a news feed together with the `ETag` and
+ `Last-Modified` values from the response that last changed them. Items are ordered newest first
+ and are persisted to a JSON file so that a fetch only needs to parse the items that are new.
+ 
+ The store is thread-safe.
+ */
+@interface SBANewsFeedStore : NSObject
+
+/**
+ The default location of the store in the Application Support directory.
+ */
+@property (class, nonatomic, readonly) NSURL *defaultFileURL;
+
+/**
+ The file where the store is saved. If `nil`, the store is only held in memory.
+ */
+@property (nonatomic, readonly, nullable) NSURL *fileURL;
+
+/**
+ The maximum number of items to keep. Older items are dropped when new items are merged. Default = 200.
+ */
+@property (nonatomic) NSUInteger maximumItemCount;
+
+/**
+ The URL of the feed that the items were fetched from.
+ */
+@property (nonatomic, readonly, nullable) NSString *feedURLString;
+
+/**
+ The `ETag` header from the last response that changed the store.
+ */
+@property (nonatomic, readonly, nullable) NSString *entityTag;
+
+/**
+ The `Last-Modified` header from the last response that changed the store.
+ */
+@property (nonatomic, readonly, nullable) NSString *lastModified;
+
+/**
+ The stored items, newest first.
+ */
+@property (nonatomic, readonly) NSArray<SBANewsFeedItem *> *items;
+
+- (instancetype)initWithFileURL:(nullable NSURL *)fileURL NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Whether or not an item with the given `identifier` is in the store.
+ */
+- (BOOL)containsItemWithIdentifier:(NSString *)identifier;
+
+/**
+ Clear the store if it holds items from a different feed.
+ */
+- (void)resetForFeedURL:(NSURL *)feedURL;
+
+/**
+ Add items from a fetch to the front of the store and save it.
+ 
+ @param newItems        The items that are not yet stored, in feed order.
+ @param entityTag       The `ETag` header of the response.
+ @param lastModified    The `Last-Modified` header of the response.
+ @return                The stored items after the merge.
+ */
+- (NSArray<SBANewsFeedItem *> *)mergeItems:(NSArray<SBANewsFeedItem *> *)newItems
+                                 entityTag:(nullable NSString *)entityTag
+                              lastModified:(nullable NSString *)lastModified;
+
+/**
+ Remove all the items and response headers.
+ */
+- (void)removeAllItems;
+
+@end
+
+NS_ASSUME_NONNULL_END
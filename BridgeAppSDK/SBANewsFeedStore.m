@@ -0,0 +1,270 @@
+//
+//  SBANewsFeedStore.m
+//  BridgeAppSDK
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+#import "SBANewsFeedStore.h"
+#import "SBANewsFeedItem.h"
+
+static NSString * const kFeedURLKey      = @"feedURL";
+static NSString * const kEntityTagKey    = @"entityTag";
+static NSString * const kLastModifiedKey = @"lastModified";
+static NSString * const kItemsKey        = @"items";
+
+static NSUInteger const kDefaultMaximumItemCount = 200;
+
+@interface SBANewsFeedStore ()
+
+@property (nonatomic, strong) dispatch_queue_t queue;
+
+@property (nonatomic, assign) BOOL loaded;
+@property (nonatomic, copy) NSString *storedFeedURLString;
+@property (nonatomic, copy) NSString *storedEntityTag;
+@property (nonatomic, copy) NSString *storedLastModified;
+@property (nonatomic, copy) NSArray<SBANewsFeedItem *> *storedItems;
+@property (nonatomic, strong) NSMutableSet<NSString *> *identifiers;
+
+@end
+
+@implementation SBANewsFeedStore
+
++ (NSURL *)defaultFileURL
+{
+    NSURL *supportURL = [[[NSFileManager defaultManager] URLsForDirectory:NSApplicationSupportDirectory inDomains:NSUserDomainMask] firstObject];
+    return [supportURL URLByAppendingPathComponent:@"SBANewsFeedStore.json"];
+}
+
+- (instancetype)initWithFileURL:(NSURL *)fileURL
+{
+    self = [super init];
+    if (self) {
+        _fileURL = [fileURL copy];
+        _maximumItemCount = kDefaultMaximumItemCount;
+        _queue = dispatch_queue_create("org.sagebase.BridgeAppSDK.SBANewsFeedStore", DISPATCH_QUEUE_SERIAL);
+        _storedItems = @[];
+        _identifiers = [NSMutableSet new];
+    }
+    return self;
+}
+
+/**********************************/
+#pragma mark - Public methods
+/**********************************/
+
+- (NSString *)feedURLString
+{
+    __block NSString *result;
+    dispatch_sync(self.queue, ^{
+        [self loadIfNeeded];
+        result = self.storedFeedURLString;
+    });
+    return result;
+}
+
+- (NSString *)entityTag
+{
+    __block NSString *result;
+    dispatch_sync(self.queue, ^{
+        [self loadIfNeeded];
+        result = self.storedEntityTag;
+    });
+    return result;
+}
+
+- (NSString *)lastModified
+{
+    __block NSString *result;
+    dispatch_sync(self.queue, ^{
+        [self loadIfNeeded];
+        result = self.storedLastModified;
+    });
+    return result;
+}
+
+- (NSArray<SBANewsFeedItem *> *)items
+{
+    __block NSArray *result;
+    dispatch_sync(self.queue, ^{
+        [self loadIfNeeded];
+        result = self.storedItems;
+    });
+    return result;
+}
+
+- (BOOL)containsItemWithIdentifier:(NSString *)identifier
+{
+    __block BOOL result;
+    dispatch_sync(self.queue, ^{
+        [self loadIfNeeded];
+        result = [self.identifiers containsObject:identifier];
+    });
+    return result;
+}
+
+- (void)resetForFeedURL:(NSURL *)feedURL
+{
+    dispatch_sync(self.queue, ^{
+        [self loadIfNeeded];
+        NSString *urlString = feedURL.absoluteString;
+        if ((urlString == nil) || [urlString isEqualToString:self.storedFeedURLString]) {
+            return;
+        }
+        [self clearStoredItems];
+        self.storedFeedURLString = urlString;
+        [self save];
+    });
+}
+
+- (NSArray<SBANewsFeedItem *> *)mergeItems:(NSArray<SBANewsFeedItem *> *)newItems
+                                 entityTag:(NSString *)entityTag
+                              lastModified:(NSString *)lastModified
+{
+    __block NSArray *result;
+    dispatch_sync(self.queue, ^{
+        [self loadIfNeeded];
+        
+        // Keep the feed order of the new items and drop any that are repeated or already stored
+        NSMutableArray *items = [NSMutableArray arrayWithCapacity:newItems.count + self.storedItems.count];
+        for (SBANewsFeedItem *item in newItems) {
+            NSString *identifier = item.identifier;
+            if ((identifier.length > 0) && [self.identifiers containsObject:identifier]) {
+                continue;
+            }
+            if (identifier.length > 0) {
+                [self.identifiers addObject:identifier];
+            }
+            [items addObject:item];
+        }
+        [items addObjectsFromArray:self.storedItems];
+        
+        if (items.count > self.maximumItemCount) {
+            NSRange dropped = NSMakeRange(self.maximumItemCount, items.count - self.maximumItemCount);
+            for (SBANewsFeedItem *item in [items subarrayWithRange:dropped]) {
+                [self.identifiers removeObject:item.identifier];
+            }
+            [items removeObjectsInRange:dropped];
+        }
+        
+        self.storedItems = items;
+        self.storedEntityTag = entityTag;
+        self.storedLastModified = lastModified;
+        [self save];
+        
+        result = self.storedItems;
+    });
+    return result;
+}
+
+- (void)removeAllItems
+{
+    dispatch_sync(self.queue, ^{
+        [self loadIfNeeded];
+        [self clearStoredItems];
+        [self save];
+    });
+}
+
+/**********************************/
+#pragma mark - Private methods
+/**********************************/
+
+- (void)clearStoredItems
+{
+    self.storedEntityTag = nil;
+    self.storedLastModified = nil;
+    self.storedItems = @[];
+    [self.identifiers removeAllObjects];
+}
+
+- (void)loadIfNeeded
+{
+    if (self.loaded) {
+        return;
+    }
+    self.loaded = YES;
+    
+    if (self.fileURL == nil) {
+        return;
+    }
+    
+    NSData *data = [NSData dataWithContentsOfURL:self.fileURL];
+    if (data == nil) {
+        return;
+    }
+    
+    NSError *error;
+    NSDictionary *dictionary = [NSJSONSerialization JSONObjectWithData:data options:0 error:&error];
+    if (![dictionary isKindOfClass:[NSDictionary class]]) {
+        NSLog(@"Failed to load the news feed store: %@", error);
+        return;
+    }
+    
+    self.storedFeedURLString = dictionary[kFeedURLKey];
+    self.storedEntityTag = dictionary[kEntityTagKey];
+    self.storedLastModified = dictionary[kLastModifiedKey];
+    
+    NSArray *itemDictionaries = dictionary[kItemsKey];
+    NSMutableArray *items = [NSMutableArray arrayWithCapacity:itemDictionaries.count];
+    for (NSDictionary *itemDictionary in itemDictionaries) {
+        SBANewsFeedItem *item = [[SBANewsFeedItem alloc] initWithDictionaryRepresentation:itemDictionary];
+        if (item.identifier.length > 0) {
+            [self.identifiers addObject:item.identifier];
+        }
+        [items addObject:item];
+    }
+    self.storedItems = items;
+}
+
+- (void)save
+{
+    if (self.fileURL == nil) {
+        return;
+    }
+    
+    NSMutableDictionary *dictionary = [NSMutableDictionary new];
+    dictionary[kFeedURLKey] = self.storedFeedURLString;
+    dictionary[kEntityTagKey] = self.storedEntityTag;
+    dictionary[kLastModifiedKey] = self.storedLastModified;
+    dictionary[kItemsKey] = [self.storedItems valueForKey:NSStringFromSelector(@selector(dictionaryRepresentation))];
+    
+    NSError *error;
+    NSData *data = [NSJSONSerialization dataWithJSONObject:dictionary options:0 error:&error];
+    if (data != nil) {
+        [[NSFileManager defaultManager] createDirectoryAtURL:[self.fileURL URLByDeletingLastPathComponent] withIntermediateDirectories:YES attributes:nil error:nil];
+        [data writeToURL:self.fileURL options:NSDataWritingAtomic | NSDataWritingFileProtectionCompleteUntilFirstUserAuthentication error:&error];
+    }
+    if (error != nil) {
+        NSLog(@"Failed to save the news feed store: %@", error);
+    }
+}
+
+@end
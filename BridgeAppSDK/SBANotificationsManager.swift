@@ -37,10 +37,24 @@ enum SBAScheduledNotificationType: String {
     case scheduledActivity
 }
 
+/**
+ The calls used to schedule local notifications. `UIApplication` conforms to this protocol.
+ */
+public protocol SBALocalNotificationScheduler: class {
+    var scheduledLocalNotifications: [UILocalNotification]? { get set }
+    func scheduleLocalNotification(_ notification: UILocalNotification)
+    func cancelLocalNotification(_ notification: UILocalNotification)
+}
+
+extension UIApplication: SBALocalNotificationScheduler {
+}
+
 open class SBANotificationsManager: NSObject, SBASharedInfoController {
     
     static let notificationType = "notificationType"
     static let identifier = "identifier"
+    static let scheduleGuid = "scheduleGuid"
+    static let fingerprintsKey = "SBANotificationsManager.scheduledActivityFingerprints"
     
     @objc(sharedManager)
     public static let shared = SBANotificationsManager()
@@ -57,45 +71,131 @@ open class SBANotificationsManager: NSObject, SBASharedInfoController {
         return SBAPermissionsManager.shared
     }()
     
+    /**
+     The scheduler used to add and remove the local notifications. By default, this is the shared application.
+     */
+    lazy open var notificationScheduler: SBALocalNotificationScheduler = {
+        return self.sharedApplication
+    }()
+    
+    /**
+     The user defaults used to store the fingerprint of the notifications that are currently scheduled.
+     */
+    lazy open var userDefaults: UserDefaults = {
+        return self.sharedBridgeInfo.userDefaults
+    }()
+    
+    /**
+     If more than this number of notifications are added or removed, then the scheduled notifications
+     are replaced with a single call rather than one call per notification.
+     */
+    open var batchUpdateThreshold: Int = 8
+    
     @objc(setupNotificationsForScheduledActivities:)
     open func setupNotifications(for scheduledActivities: [SBBScheduledActivity]) {
         permissionsManager.requestPermission(for: SBANotificationPermissionObjectType.localNotifications()) { [weak self] (granted, _) in
             if granted {
-                self?.scheduleNotifications(scheduledActivities: scheduledActivities)
+                self?.updateNotifications(for: scheduledActivities)
             }
         }
     }
     
-    fileprivate func scheduleNotifications(scheduledActivities activities: [SBBScheduledActivity]) {
+    /**
+     Update the scheduled notifications for the given scheduled activities. Only the notifications for
+     schedules that were added, removed or where the fire date, label or expiration has changed are
+     cancelled and rescheduled. The pending notifications are read from the notification scheduler each
+     time so that a future notification that was dropped by the system (only the soonest 64 are kept)
+     or cancelled elsewhere is scheduled again.
+     
+     @param     scheduledActivities     The scheduled activities for which to schedule notifications.
+     */
+    @objc(updateNotificationsForScheduledActivities:)
+    open func updateNotifications(for scheduledActivities: [SBBScheduledActivity]) {
+        
+        // Get the fingerprint for the scheduled activities that should include a notification
+        var schedules: [String : SBBScheduledActivity] = [:]
+        var fingerprints: [String : String] = [:]
+        for sa in scheduledActivities {
+            guard let guid = sa.guid, fingerprints[guid] == nil,
+                let taskRef = self.sharedBridgeInfo.taskReferenceForSchedule(sa), taskRef.scheduleNotification
+                else {
+                    continue
+            }
+            schedules[guid] = sa
+            fingerprints[guid] = notificationFingerprint(for: sa)
+        }
+        let previousFingerprints = userDefaults.dictionary(forKey: SBANotificationsManager.fingerprintsKey) as? [String : String] ?? [:]
+        
+        // Cancel the notifications that have changed or were scheduled without a fingerprint
+        let scheduler = notificationScheduler
+        let scheduledNotifications = scheduler.scheduledLocalNotifications ?? []
+        var keptNotifications: [UILocalNotification] = []
+        var keptGuids = Set<String>()
+        var cancelledNotifications: [UILocalNotification] = []
+        for notif in scheduledNotifications {
+            guard let type = notif.userInfo?[SBANotificationsManager.notificationType] as? String,
+                SBAScheduledNotificationType(rawValue: type) == .scheduledActivity
+                else {
+                    keptNotifications.append(notif)
+                    continue
+            }
+            if let guid = notif.userInfo?[SBANotificationsManager.scheduleGuid] as? String, !keptGuids.contains(guid),
+                let fingerprint = fingerprints[guid], fingerprint == previousFingerprints[guid] {
+                keptNotifications.append(notif)
+                keptGuids.insert(guid)
+            }
+            else {
+                cancelledNotifications.append(notif)
+            }
+        }
         
-        // Cancel previous notifications
-        cancelNotifications(notificationType: .scheduledActivity)
+        // Add a notification for the scheduled activities that have changed, and for the unchanged
+        // ones that are no longer pending and have not yet fired
+        let now = Date()
+        let addedNotifications = fingerprints.compactMap({ (entry) -> UILocalNotification? in
+            guard !keptGuids.contains(entry.key), let sa = schedules[entry.key] else { return nil }
+            let scheduledOn: Date? = sa.scheduledOn
+            guard entry.value != previousFingerprints[entry.key] || (scheduledOn.map({ $0 > now }) ?? false) else { return nil }
+            return createNotification(for: sa)
+        })
         
-        // Add a notification for the scheduled activities that should include one
-        let app = sharedApplication
-        for sa in activities {
-            if let taskRef = self.sharedBridgeInfo.taskReferenceForSchedule(sa)
-                , taskRef.scheduleNotification  {
-                let notif = UILocalNotification()
-                notif.fireDate = sa.scheduledOn
-                notif.soundName = UILocalNotificationDefaultSoundName
-                notif.alertBody = Localization.localizedStringWithFormatKey("SBA_TIME_FOR_%@", sa.activity.label)
-                notif.userInfo = [ SBANotificationsManager.notificationType: SBAScheduledNotificationType.scheduledActivity.rawValue,
-                                   SBANotificationsManager.identifier: sa.activity.guid ]
-                app.scheduleLocalNotification(notif)
+        // Exit early if there are no changes
+        guard cancelledNotifications.count > 0 || addedNotifications.count > 0 || fingerprints != previousFingerprints
+            else {
+                return
+        }
+        
+        if cancelledNotifications.count + addedNotifications.count > batchUpdateThreshold {
+            scheduler.scheduledLocalNotifications = keptNotifications + addedNotifications
+        }
+        else {
+            for notif in cancelledNotifications {
+                scheduler.cancelLocalNotification(notif)
+            }
+            for notif in addedNotifications {
+                scheduler.scheduleLocalNotification(notif)
             }
         }
+        
+        userDefaults.set(fingerprints, forKey: SBANotificationsManager.fingerprintsKey)
     }
     
-    fileprivate func cancelNotifications(notificationType: SBAScheduledNotificationType) {
-        let app = sharedApplication
-        if let scheduledNotifications = app.scheduledLocalNotifications {
-            for notif in scheduledNotifications {
-                if let type = notif.userInfo?[SBANotificationsManager.notificationType] as? String,
-                    let notifType = SBAScheduledNotificationType(rawValue: type) , notifType == notificationType {
-                    app.cancelLocalNotification(notif)
-                }
-            }
-        }
+    fileprivate func notificationFingerprint(for sa: SBBScheduledActivity) -> String {
+        // Bridging from Obj-C does not guarantee that the values are non-nil
+        let scheduledOn: Date? = sa.scheduledOn
+        let fireDate = scheduledOn?.timeIntervalSinceReferenceDate ?? 0
+        let expiresOn = sa.expiresOn?.timeIntervalSinceReferenceDate ?? 0
+        return "\(fireDate)|\(expiresOn)|\(sa.activity?.guid ?? "")|\(sa.activity?.label ?? "")"
+    }
+    
+    fileprivate func createNotification(for sa: SBBScheduledActivity) -> UILocalNotification {
+        let notif = UILocalNotification()
+        notif.fireDate = sa.scheduledOn
+        notif.soundName = UILocalNotificationDefaultSoundName
+        notif.alertBody = Localization.localizedStringWithFormatKey("SBA_TIME_FOR_%@", sa.activity.label)
+        notif.userInfo = [ SBANotificationsManager.notificationType: SBAScheduledNotificationType.scheduledActivity.rawValue,
+                           SBANotificationsManager.identifier: sa.activity.guid,
+                           SBANotificationsManager.scheduleGuid: sa.guid ]
+        return notif
     }
 }
@@ -794,7 +794,23 @@ open class SBAClientDataProfileItem: SBAProfileItemBase {
     // they can be written to an SBBScheduledActivity.
     static var cachedItemsKey: String = "SBAClientDataProfileItemCachedItems"
     private static var toBeUpdatedToBridge: Set<SBBScheduledActivity> = Set<SBBScheduledActivity>()
-    static var keychain: SBAKeychainWrapperProtocol = SBAProfileManager.keychain
+    static var keychain: SBAKeychainWrapperProtocol = SBAProfileManager.keychain {
+        willSet {
+            // write any pending changes to the keychain that they were read from
+            flushCurrentValues()
+        }
+        didSet {
+            invalidateCurrentValues()
+        }
+    }
+    
+    // The keychain cache is decoded once and then kept in memory. Changes are written back to the
+    // keychain in a single write after `flushDelay`, or when `flushCurrentValues()` is called.
+    private static let cacheQueue = DispatchQueue(label: "org.sagebase.BridgeAppSDK.SBAClientDataProfileItem.cache")
+    private static var _currentValues: [String: [[String: SBBJSONValue]]]?
+    private static var _hasUnsavedChanges = false
+    private static var _pendingFlush: DispatchWorkItem?
+    static var flushDelay: TimeInterval = 1.0
     
     // In the normal case (all values have been written to an SBBScheduledActivity instance), the
     // array of values for a given profile item will consist of one element, the latest. They are
@@ -804,44 +820,119 @@ open class SBAClientDataProfileItem: SBAProfileItemBase {
     // say, your app allows adding or editing events in the past.
     static var currentValues: [String: [[String: SBBJSONValue]]] {
         get {
-            var error: NSError?
-            let dict = keychain.object(forKey: cachedItemsKey, error: &error)
-            var values = [String: [[String: SBBJSONValue]]]()
-            if error != nil {
-                if error!.code == Int(errSecItemNotFound) {
-                    self.currentValues = values
-                }
-                else {
-                    print("Error accessing keychain \(cachedItemsKey): \(error!.code) \(error!)")
-                }
-            }
-            else {
-                values = dict as! [String : [[String : SBBJSONValue]]]
-            }
-            
-            return values
+            return cacheQueue.sync { loadCurrentValues() }
         }
         
         set {
-            do {
-                try keychain.setObject(newValue as NSSecureCoding, forKey: cachedItemsKey)
-            }
-            catch let error {
-                assert(false, "Failed to set \(cachedItemsKey): \(String(describing: error))")
+            cacheQueue.sync {
+                _currentValues = newValue
+                _hasUnsavedChanges = true
+                
+                // coalesce the changes into one keychain write
+                _pendingFlush?.cancel()
+                let flush = DispatchWorkItem { SBAClientDataProfileItem.saveCurrentValues() }
+                _pendingFlush = flush
+                cacheQueue.asyncAfter(deadline: .now() + flushDelay, execute: flush)
             }
         }
     }
     
+    /**
+     Write any changes to the cached values to the keychain. This is called when the app enters the
+     background and can be called whenever the changes must be saved immediately.
+     */
+    public static func flushCurrentValues() {
+        cacheQueue.sync { saveCurrentValues() }
+    }
+    
+    /**
+     Drop the in-memory values so that they are read from the keychain the next time that they are
+     used. Any changes that have not been written to the keychain are discarded.
+     */
+    static func invalidateCurrentValues() {
+        cacheQueue.sync {
+            _pendingFlush?.cancel()
+            _pendingFlush = nil
+            _currentValues = nil
+            _hasUnsavedChanges = false
+        }
+    }
+    
+    /** Called on the cache queue. */
+    private static func loadCurrentValues() -> [String: [[String: SBBJSONValue]]] {
+        if let values = _currentValues {
+            return values
+        }
+        
+        var error: NSError?
+        let dict = keychain.object(forKey: cachedItemsKey, error: &error)
+        var values = [String: [[String: SBBJSONValue]]]()
+        if let error = error, error.code != Int(errSecItemNotFound) {
+            print("Error accessing keychain \(cachedItemsKey): \(error.code) \(error)")
+            return values
+        }
+        else if error == nil, let storedValues = dict as? [String : [[String : SBBJSONValue]]] {
+            values = storedValues
+        }
+        
+        _currentValues = values
+        return values
+    }
+    
+    /** Called on the cache queue. */
+    private static func saveCurrentValues() {
+        _pendingFlush?.cancel()
+        _pendingFlush = nil
+        guard _hasUnsavedChanges, let values = _currentValues else { return }
+        do {
+            try keychain.setObject(values as NSSecureCoding, forKey: cachedItemsKey)
+            _hasUnsavedChanges = false
+        }
+        catch let error {
+            assert(false, "Failed to set \(cachedItemsKey): \(String(describing: error))")
+        }
+    }
+    
     static func addToCurrentValues(_ jsonWhatAndWhen: [String: SBBJSONValue], forProfileKey key: String) {
         var currentValuesForKey = currentValues[key] ?? [[String: SBBJSONValue]]()
         currentValuesForKey.append(jsonWhatAndWhen)
         currentValues[key] = jsonWhatsAndWhensSortedByWhen(currentValuesForKey)
     }
     
+    // Index of the scheduled activities and the values stored on them, built when first needed.
+    // The scheduled activities are set on the BridgeSDK completion queue and the index is read
+    // from the main queue, so both are only accessed on the cache queue.
+    private static var _scheduledActivities: [SBBScheduledActivity]?
+    private static var _timeSeriesIndex: SBAClientDataTimeSeriesIndex?
+    
+    /**
+     Call the block with the index of the `scheduledActivities` on the cache queue.
+     
+     @return    The value returned by the block, or `nil` if there are no scheduled activities.
+     */
+    @discardableResult
+    static func withTimeSeriesIndex<T>(_ block: (SBAClientDataTimeSeriesIndex) -> T?) -> T? {
+        return cacheQueue.sync {
+            if _timeSeriesIndex == nil, let activities = _scheduledActivities {
+                _timeSeriesIndex = SBAClientDataTimeSeriesIndex(scheduledActivities: activities)
+            }
+            guard let index = _timeSeriesIndex else { return nil }
+            return block(index)
+        }
+    }
+    
     public static var scheduledActivities: [SBBScheduledActivity]? {
-        didSet {
+        get {
+            return cacheQueue.sync { _scheduledActivities }
+        }
+        set {
+            cacheQueue.sync {
+                _scheduledActivities = newValue
+                _timeSeriesIndex = nil
+            }
+            
             // get all the SBAClientDataProfileItem instances from SBAProfileManager
-            guard scheduledActivities != nil && scheduledActivities!.count > 0,
+            guard let scheduledActivities = newValue, scheduledActivities.count > 0,
                     let clientDataItems: [SBAClientDataProfileItem] = SBAProfileManager.shared?.profileItems().values.sba_mapAndFilter({ return $0 as? SBAClientDataProfileItem })
                 else {
                     return
@@ -898,7 +989,7 @@ open class SBAClientDataProfileItem: SBAProfileItemBase {
             guard toBeUpdatedToBridge.count > 0 else { return }
             let updatesArray = Array(toBeUpdatedToBridge)
             toBeUpdatedToBridge.removeAll()
-            SBABridgeManager.updateScheduledActivities(updatesArray)
+            SBAScheduleUpdateQueue.shared.enqueue(updatesArray)
             
             // if there were any updates to demographic data items, upload demographic data
             guard updatedDemographicData,
@@ -932,31 +1023,19 @@ open class SBAClientDataProfileItem: SBAProfileItemBase {
     }
     
     static func jsonWhatsAndWhensSortedByWhen(_ jsonWhatsAndWhens: [[String: SBBJSONValue]]) -> [[String: SBBJSONValue]] {
-        return jsonWhatsAndWhens.sorted(by: {
-            return SBAWhatAndWhen(dictionaryRepresentation: $0) < SBAWhatAndWhen(dictionaryRepresentation: $1)
-        })
+        // parse each date once rather than on every comparison
+        return jsonWhatsAndWhens.map({ SBAClientDataTimeSeriesIndex.Entry(json: $0) })
+            .sorted(by: <)
+            .map({ $0.json })
     }
     
     func jsonWhatsAndWhensFromBridge() -> [[String: SBBJSONValue]] {
-        // pull out all the non-empty lists of date/value instances for this activityIdentifier and key into one non-empty list
-        guard let valueArrays = SBAClientDataProfileItem.scheduledActivities?.sba_mapAndFilter({ (scheduledActivity) -> [[String: SBBJSONValue]]? in
-                    guard scheduledActivity.activityIdentifier == activityIdentifier,
-                            let clientData = scheduledActivity.clientData as? NSDictionary,
-                            let valueArray = clientData[sourceKey] as? [[String : SBBJSONValue]],
-                            valueArray.count > 0
-                        else { return nil }
-                    
-                    return valueArray
-                }),
-                valueArrays.count > 0
-            else { return [] }
-        
-        // consolidate them all into one list, sort by date, and return that
-        var whatsAndWhens = [[String: SBBJSONValue]]();
-        for valueArray in valueArrays {
-            whatsAndWhens.append(contentsOf: valueArray)
-        }
-        return SBAClientDataProfileItem.jsonWhatsAndWhensSortedByWhen(whatsAndWhens)
+        return whatsAndWhensFromBridge().map({ $0.json })
+    }
+    
+    private func whatsAndWhensFromBridge() -> [SBAClientDataTimeSeriesIndex.Entry] {
+        // all the date/value instances for this activityIdentifier and key, sorted by date
+        return SBAClientDataProfileItem.withTimeSeriesIndex({ $0.entries(for: self.activityIdentifier, sourceKey: self.sourceKey) }) ?? []
     }
     
     func dateAndJsonValuesFromCachedItems() -> [SBAWhatAndWhen]? {
@@ -986,24 +1065,11 @@ open class SBAClientDataProfileItem: SBAProfileItemBase {
     func setToAppropriateScheduledActivity(_ jsonWhatAndWhen: [String: SBBJSONValue]) {
         // potential SBBScheduledActivity instances to update will have the right activityIdentifier and will expire after, if at all
         let when = SBAWhatAndWhen(dictionaryRepresentation: jsonWhatAndWhen).date as Date
-        guard let activities = SBAClientDataProfileItem.scheduledActivities?.sba_mapAndFilter({ (scheduledActivity) -> SBBScheduledActivity? in
-                    if scheduledActivity.activityIdentifier == activityIdentifier {
-                        return scheduledActivity
-                    }
-                    return nil
-                }),
-                activities.count > 0
-            else { return }
         
         // the appropriate activity is either the most recent one scheduled before our asOf date, or the oldest one if none
         // were scheduled before (e.g. if the value was set during onboarding before the account was created).
-        var bestActivity: SBBScheduledActivity = activities.first!
-        for activity in activities.reversed() {
-            if activity.scheduledOn <= when {
-                bestActivity = activity
-                break
-            }
-        }
+        guard let bestActivity = SBAClientDataProfileItem.withTimeSeriesIndex({ $0.bestScheduledActivity(for: self.activityIdentifier, on: when) })
+            else { return }
         
         if bestActivity.startedOn == nil {
             bestActivity.startedOn = when
@@ -1022,6 +1088,7 @@ open class SBAClientDataProfileItem: SBAProfileItemBase {
         jsonWhatsAndWhens = SBAClientDataProfileItem.jsonWhatsAndWhensSortedByWhen(jsonWhatsAndWhens)
         clientData[sourceKey] = jsonWhatsAndWhens
         scheduledActivity.clientData = clientData
+        SBAClientDataProfileItem.withTimeSeriesIndex({ $0.insert(jsonWhatAndWhen, to: scheduledActivity, sourceKey: self.sourceKey) })
         
         if  scheduledActivity.finishedOn == nil || when > scheduledActivity.finishedOn! {
             scheduledActivity.finishedOn = when
@@ -1050,7 +1117,7 @@ open class SBAClientDataProfileItem: SBAProfileItemBase {
     }
     
     open func valuesAndDates() -> [SBAWhatAndWhen] {
-        let fromBridge = self.jsonWhatsAndWhensFromBridge().map({ return SBAWhatAndWhen(dictionaryRepresentation: $0) })
+        let fromBridge = self.whatsAndWhensFromBridge().map({ return $0.whatAndWhen })
         let fromCache = SBAClientDataProfileItem.currentValues[profileKey]?.map({ return SBAWhatAndWhen(dictionaryRepresentation: $0) }) ?? [SBAWhatAndWhen]()
         let setOfAll = Set(fromBridge).union(fromCache)
         return Array(setOfAll).sorted()
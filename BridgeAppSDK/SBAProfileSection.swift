@@ -160,28 +160,23 @@ open class SBAProfileItemProfileTableItem: SBAProfileTableItemBase {
     }()
     
     func itemDetailFor(_ date: Date, format: String) -> String {
-        let formatter = DateFormatter()
-        formatter.dateFormat = format
-        formatter.calendar = Calendar.current
-        return formatter.string(from: date)
+        return SBAFormatterCache.shared.dateFormatter(format: format).string(from: date)
+    }
+    
+    func itemDetailFor(_ date: Date, template: String) -> String {
+        return SBAFormatterCache.shared.dateFormatter(template: template).string(from: date)
     }
     
     open func dateAsItemDetail(_ date: Date) -> String {
-        guard let format = DateFormatter.dateFormat(fromTemplate: "Mdy", options: 0, locale: Locale.current)
-            else { return String(describing: date) }
-        return self.itemDetailFor(date, format: format)
+        return self.itemDetailFor(date, template: "Mdy")
     }
     
     open func dateTimeAsItemDetail(_ dateTime: Date) -> String {
-        guard let format = DateFormatter.dateFormat(fromTemplate: "yEMdhma", options: 0, locale: Locale.current)
-            else { return String(describing: dateTime) }
-        return self.itemDetailFor(dateTime, format: format)
+        return self.itemDetailFor(dateTime, template: "yEMdhma")
     }
     
     open func timeOfDayAsItemDetail(_ timeOfDay: Date) -> String {
-        guard let format = DateFormatter.dateFormat(fromTemplate: "hma", options: 0, locale: Locale.current)
-            else { return String(describing: timeOfDay) }
-        return self.itemDetailFor(timeOfDay, format: format)
+        return self.itemDetailFor(timeOfDay, template: "hma")
     }
     
     public func centimetersToFeetAndInches(_ centimeters: Double) -> (feet: Double, inches: Double) {
@@ -196,10 +191,8 @@ open class SBAProfileItemProfileTableItem: SBAProfileTableItemBase {
     }
     
     open func heightAsItemDetail(_ height: NSNumber) -> String {
-        let formatter = LengthFormatter()
-        formatter.isForPersonHeightUse = true
         let meters = height.doubleValue / 100.0 // cm -> m
-        return formatter.string(fromMeters: meters)
+        return SBAFormatterCache.shared.personHeightFormatter().string(fromMeters: meters)
     }
     
     @objc(hkQuantityWeightAsItemDetail:)
@@ -209,9 +202,7 @@ open class SBAProfileItemProfileTableItem: SBAProfileTableItemBase {
     }
     
     open func weightAsItemDetail(_ weight: NSNumber) -> String {
-        let formatter = MassFormatter()
-        formatter.isForPersonMassUse = true
-        return formatter.string(fromKilograms: weight.doubleValue)
+        return SBAFormatterCache.shared.personMassFormatter().string(fromKilograms: weight.doubleValue)
     }
     
     override open var detail: String? {
@@ -0,0 +1,279 @@
+//
+//  SBAScheduleUpdateQueue.swift
+//  BridgeAppSDK
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+import Foundation
+import BridgeSDK
+
+/**
+ `SBAScheduleUpdateQueue` is an outbound queue of the scheduled activities that need to be updated
+ on the Bridge server.
+ 
+ Changes to the same schedule (by `guid`) are merged and the queued schedules are sent in a single
+ request once per `batchInterval`. The queue is written to disk whenever it changes so that updates
+ that have not been sent when the app is terminated are sent the next time the queue is used.
+ 
+ The values of each schedule are copied when it is added to the queue, so changes made to the
+ schedule afterwards are not sent unless the schedule is added again. Call `removeAll()` when the
+ participant signs out so that their updates are not sent with the next participant's session.
+ 
+ When a batch has been sent, `didSendUpdatesNotification` is posted on the main queue.
+ */
+public final class SBAScheduleUpdateQueue {
+    
+    /**
+     Posted on the main queue when a batch of updates has been sent to the server.
+     */
+    public static let didSendUpdatesNotification = Notification.Name("SBAScheduleUpdateQueueDidSendUpdates")
+    
+    /**
+     The shared queue.
+     */
+    public static let shared = SBAScheduleUpdateQueue()
+    
+    /**
+     The default location of the file where the queue is stored.
+     */
+    public static var defaultURL: URL {
+        let supportURL = FileManager.default.urls(for: .applicationSupportDirectory, in: .userDomainMask).first!
+        return supportURL.appendingPathComponent("SBAScheduleUpdateQueue.json")
+    }
+    
+    /**
+     The file where the queue is stored.
+     */
+    public let fileURL: URL
+    
+    /**
+     The time to wait after a schedule is added to the queue before sending the batch. Default = 2 seconds.
+     */
+    public var batchInterval: TimeInterval
+    
+    private typealias Update = [AnyHashable : Any]
+    
+    private let lockQueue = DispatchQueue(label: "org.sagebase.BridgeAppSDK.SBAScheduleUpdateQueue")
+    private var _pending: [String : Update]?
+    private var _order: [String] = []
+    private var _changeCounts: [String : Int] = [:]
+    private var _isSending = false
+    private var _pendingFlush: DispatchWorkItem?
+    private var _failureCount = 0
+    
+    public init(fileURL: URL = SBAScheduleUpdateQueue.defaultURL, batchInterval: TimeInterval = 2.0) {
+        self.fileURL = fileURL
+        self.batchInterval = batchInterval
+    }
+    
+    /**
+     The number of schedules waiting to be sent.
+     */
+    public var pendingCount: Int {
+        return lockQueue.sync { pending().count }
+    }
+    
+    /**
+     Add the schedules to the queue. If a schedule with the same `guid` is already queued, then the
+     changes are merged. This should be called on the thread where the schedules are changed since
+     their values are copied before this method returns.
+     */
+    public func enqueue(_ scheduledActivities: [SBBScheduledActivity]) {
+        // Copy the values on the calling thread rather than holding on to the live objects
+        let updates = scheduledActivities.compactMap { (scheduledActivity) -> (String, Update)? in
+            guard let guid = scheduledActivity.guid else { return nil }
+            return (guid, scheduledActivity.dictionaryRepresentation())
+        }
+        guard updates.count > 0 else { return }
+        lockQueue.sync {
+            var pending = self.pending()
+            for (guid, update) in updates {
+                if let queued = pending[guid] {
+                    pending[guid] = merge(queued, update)
+                } else {
+                    pending[guid] = update
+                    _order.append(guid)
+                }
+                _changeCounts[guid, default: 0] += 1
+            }
+            _pending = pending
+            save()
+            scheduleFlush(after: batchInterval)
+        }
+    }
+    
+    /**
+     Remove all the queued schedules without sending them and delete the file where the queue is
+     stored. This should be called when the participant signs out.
+     */
+    public func removeAll() {
+        lockQueue.sync {
+            _pendingFlush?.cancel()
+            _pendingFlush = nil
+            _pending = [:]
+            _order = []
+            _changeCounts = [:]
+            _failureCount = 0
+            save()
+        }
+    }
+    
+    /**
+     Send the queued schedules now rather than waiting for the batch interval.
+     */
+    public func flush() {
+        lockQueue.async {
+            self.send()
+        }
+    }
+    
+    // MARK: Called on the lock queue
+    
+    private func pending() -> [String : Update] {
+        if let pending = _pending {
+            return pending
+        }
+        
+        // Load the updates that were not sent before the app was last terminated
+        var pending: [String : Update] = [:]
+        if let data = try? Data(contentsOf: fileURL),
+            let json = (try? JSONSerialization.jsonObject(with: data, options: [])) as? [Update] {
+            for dictionary in json {
+                guard let guid = dictionary[Key.guid] as? String, pending[guid] == nil
+                    else {
+                        continue
+                }
+                pending[guid] = dictionary
+                _order.append(guid)
+                _changeCounts[guid] = 1
+            }
+        }
+        _pending = pending
+        if pending.count > 0 {
+            scheduleFlush(after: batchInterval)
+        }
+        return pending
+    }
+    
+    private enum Key {
+        static let guid = #keyPath(SBBScheduledActivity.guid)
+        static let mergedKeys = [#keyPath(SBBScheduledActivity.startedOn),
+                                 #keyPath(SBBScheduledActivity.finishedOn),
+                                 #keyPath(SBBScheduledActivity.clientData)]
+    }
+    
+    private func merge(_ queued: Update, _ update: Update) -> Update {
+        // Keep any values from the queued update that are not set on the newer one
+        var merged = update
+        for key in Key.mergedKeys where merged[key] == nil || merged[key] is NSNull {
+            merged[key] = queued[key]
+        }
+        return merged
+    }
+    
+    private func save() {
+        let pending = _pending ?? [:]
+        do {
+            guard pending.count > 0 else {
+                if FileManager.default.fileExists(atPath: fileURL.path) {
+                    try FileManager.default.removeItem(at: fileURL)
+                }
+                return
+            }
+            let json = _order.compactMap { pending[$0] }
+            let data = try JSONSerialization.data(withJSONObject: json, options: [])
+            try FileManager.default.createDirectory(at: fileURL.deletingLastPathComponent(), withIntermediateDirectories: true, attributes: nil)
+            try data.write(to: fileURL, options: [.atomic, .completeFileProtectionUntilFirstUserAuthentication])
+        } catch let err {
+            debugPrint("Failed to save the schedule update queue: \(err)")
+        }
+    }
+    
+    private func scheduleFlush(after interval: TimeInterval) {
+        guard _pendingFlush == nil else { return }
+        let flush = DispatchWorkItem { [weak self] in
+            self?._pendingFlush = nil
+            self?.send()
+        }
+        _pendingFlush = flush
+        lockQueue.asyncAfter(deadline: .now() + interval, execute: flush)
+    }
+    
+    private func send() {
+        // Only one request at a time. Anything queued while sending is sent when the request finishes.
+        guard !_isSending else { return }
+        let pending = self.pending()
+        guard pending.count > 0 else { return }
+        
+        let batch = _order.compactMap { pending[$0] }.compactMap { SBBScheduledActivity(dictionaryRepresentation: $0) }
+        let sentChangeCounts = _changeCounts
+        
+        // The schedules stay on disk until the server has accepted them
+        _isSending = true
+        SBABridgeManager.updateScheduledActivities(batch) { [weak self] (_, error) in
+            guard let strongSelf = self else { return }
+            strongSelf.lockQueue.async {
+                strongSelf.didSend(changeCounts: sentChangeCounts, error: error)
+            }
+        }
+    }
+    
+    private func didSend(changeCounts sentChangeCounts: [String : Int], error: Error?) {
+        _isSending = false
+        
+        if let error = error {
+            // Back off before trying again, up to 5 minutes
+            debugPrint("Failed to update scheduled activities: \(error)")
+            _failureCount += 1
+            scheduleFlush(after: min(batchInterval * pow(2, Double(_failureCount)), 300))
+            return
+        }
+        _failureCount = 0
+        
+        // Remove the schedules that were sent unless they were changed again while sending
+        var pending = self.pending()
+        for (guid, count) in sentChangeCounts where _changeCounts[guid] == count {
+            pending[guid] = nil
+            _changeCounts[guid] = nil
+        }
+        _pending = pending
+        _order = _order.filter { pending[$0] != nil }
+        save()
+        
+        if pending.count > 0 {
+            scheduleFlush(after: batchInterval)
+        }
+        
+        DispatchQueue.main.async {
+            NotificationCenter.default.post(name: SBAScheduleUpdateQueue.didSendUpdatesNotification, object: self)
+        }
+    }
+}
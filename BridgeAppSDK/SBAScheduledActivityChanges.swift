@@ -0,0 +1,178 @@
+//
+//  SBAScheduledActivityChanges.swift
+//  BridgeAppSDK
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+
+import BridgeSDK
+
+/**
+ `SBAScheduledActivityChanges` describes the changes to the scheduled activities that are applied
+ when the schedules are reloaded or a schedule is updated in place. The schedules are matched by
+ `guid` so that only the schedules that were inserted, removed or changed are included.
+ */
+public struct SBAScheduledActivityChanges {
+    
+    /**
+     The `guid` of the schedules that were added.
+     */
+    public let insertedGuids: Set<String>
+    
+    /**
+     The `guid` of the schedules that were removed.
+     */
+    public let removedGuids: Set<String>
+    
+    /**
+     The `guid` of the schedules that are included in both the old and new schedules, but where
+     the values displayed or used to filter the schedule have changed.
+     */
+    public let updatedGuids: Set<String>
+    
+    /**
+     The index paths of the table rows to delete. These index paths refer to the rows *before* the
+     changes are applied.
+     */
+    public internal(set) var deletedIndexPaths: [IndexPath] = []
+    
+    /**
+     The index paths of the table rows to insert. These index paths refer to the rows *after* the
+     changes are applied.
+     */
+    public internal(set) var insertedIndexPaths: [IndexPath] = []
+    
+    /**
+     Whether or not the row changes could be calculated. If `true`, then the table should be reloaded.
+     */
+    public internal(set) var requiresReload: Bool = true
+    
+    /**
+     Whether or not there are any changes to the schedules.
+     */
+    public var isEmpty: Bool {
+        return insertedGuids.count == 0 && removedGuids.count == 0 && updatedGuids.count == 0
+    }
+    
+    public init(insertedGuids: Set<String> = [], removedGuids: Set<String> = [], updatedGuids: Set<String> = []) {
+        self.insertedGuids = insertedGuids
+        self.removedGuids = removedGuids
+        self.updatedGuids = updatedGuids
+    }
+    
+    /**
+     Calculate the row changes for a table from the `guid` of the schedules in each section before
+     and after the changes. If the sections do not match or the unchanged rows have been reordered,
+     then `requiresReload` is set to `true`.
+     
+     @param oldRows     The `guid` of the schedules in each table section before the changes.
+     @param newRows     The `guid` of the schedules in each table section after the changes.
+     */
+    public mutating func calculateRowChanges(from oldRows: [[String]]?, to newRows: [[String]]) {
+        deletedIndexPaths = []
+        insertedIndexPaths = []
+        guard let oldRows = oldRows, oldRows.count == newRows.count else {
+            requiresReload = true
+            return
+        }
+        
+        for (section, (oldSection, newSection)) in zip(oldRows, newRows).enumerated() {
+            let oldSet = Set(oldSection)
+            let newSet = Set(newSection)
+            
+            // A changed schedule is deleted and inserted so that it is moved if needed.
+            var oldKept: [String] = []
+            for (row, guid) in oldSection.enumerated() {
+                if newSet.contains(guid) && !updatedGuids.contains(guid) {
+                    oldKept.append(guid)
+                }
+                else {
+                    deletedIndexPaths.append(IndexPath(row: row, section: section))
+                }
+            }
+            var newKept: [String] = []
+            for (row, guid) in newSection.enumerated() {
+                if oldSet.contains(guid) && !updatedGuids.contains(guid) {
+                    newKept.append(guid)
+                }
+                else {
+                    insertedIndexPaths.append(IndexPath(row: row, section: section))
+                }
+            }
+            
+            // Batch updates cannot describe a reordering of the rows that are kept.
+            guard oldKept == newKept else {
+                deletedIndexPaths = []
+                insertedIndexPaths = []
+                requiresReload = true
+                return
+            }
+        }
+        requiresReload = false
+    }
+}
+
+/**
+ Snapshot of the values of a scheduled activity that are used to determine whether or not the
+ schedule has changed. The schedules returned by Bridge may be the same instances that are
+ updated in place, so the values are copied rather than comparing the objects.
+ */
+struct SBAScheduledActivityFingerprint: Equatable {
+    
+    let scheduledOn: Date?
+    let expiresOn: Date?
+    let startedOn: Date?
+    let finishedOn: Date?
+    let persistent: Bool
+    let scheduleIdentifier: String?
+    let label: String?
+    let labelDetail: String?
+    
+    init(_ schedule: SBBScheduledActivity) {
+        // Bridging from Obj-C does not guarantee that the values are non-nil
+        let scheduledOn: Date? = schedule.scheduledOn
+        self.scheduledOn = scheduledOn
+        self.expiresOn = schedule.expiresOn
+        self.startedOn = schedule.startedOn
+        self.finishedOn = schedule.finishedOn
+        self.persistent = schedule.persistent?.boolValue ?? false
+        self.scheduleIdentifier = schedule.activity?.guid
+        self.label = schedule.activity?.label
+        self.labelDetail = schedule.activity?.labelDetail
+    }
+    
+    /**
+     The values that are used to schedule a local notification.
+     */
+    var notificationKey: String {
+        return "\(scheduleIdentifier ?? "")|\(scheduledOn?.timeIntervalSinceReferenceDate ?? 0)|\(label ?? "")"
+    }
+}
@@ -63,6 +63,20 @@ public protocol SBAScheduledActivityManagerDelegate: SBAAlertPresenter {
      Callback that a reload of the scheduled activities has finished.
     */
     func reloadFinished(_ sender: Any?)
+    
+    /**
+     Callback that the scheduled activities have been reloaded or updated. The changes include the
+     schedules that were inserted, removed or changed and (if available) the table rows to delete and
+     insert. By default, this calls `reloadFinished()`.
+     */
+    func scheduledActivitiesDidChange(_ sender: Any?, changes: SBAScheduledActivityChanges)
+}
+
+extension SBAScheduledActivityManagerDelegate {
+    
+    public func scheduledActivitiesDidChange(_ sender: Any?, changes: SBAScheduledActivityChanges) {
+        reloadFinished(sender)
+    }
 }
 
 /**
@@ -106,7 +120,18 @@ open class SBABaseScheduledActivityManager: NSObject, ORKTaskViewControllerDeleg
         commonInit()
     }
     
+    deinit {
+        if let observer = scheduleUpdateObserver {
+            NotificationCenter.default.removeObserver(observer)
+        }
+    }
+    
     func commonInit() {
+        // Reload once for each batch of updates that is sent to the server
+        scheduleUpdateObserver = NotificationCenter.default.addObserver(forName: SBAScheduleUpdateQueue.didSendUpdatesNotification, object: nil, queue: OperationQueue.main) { [weak self] (_) in
+            self?.reloadData()
+        }
+        
         guard let appDelegate = UIApplication.shared.delegate as? SBAAppInfoDelegate else { return }
         _bridgeInfo = appDelegate.bridgeInfo
         _user = appDelegate.currentUser
@@ -119,7 +144,47 @@ open class SBABaseScheduledActivityManager: NSObject, ORKTaskViewControllerDeleg
     /**
      By default, this is an array of the activities fetched by the call to the server in `reloadData`.
     */
-    open var activities: [SBBScheduledActivity] = []
+    open var activities: [SBBScheduledActivity] = [] {
+        didSet {
+            _loadGeneration = _loadGeneration &+ 1
+            // The indexes are built off the main thread when applying a snapshot
+            guard !_isApplyingSnapshot else { return }
+            _isLoadedFromSnapshotCache = false
+            _activityStore = SBAScheduledActivityStore(activities: activities)
+            _fingerprints = SBAScheduledActivitySnapshot.fingerprints(for: activities)
+        }
+    }
+    
+    /**
+     Indexed store of the `activities`. This is rebuilt when the activities are set and can be
+     used to look up a schedule without walking the full list of activities.
+     */
+    public var activityStore: SBAScheduledActivityStore {
+        return _activityStore
+    }
+    fileprivate var _activityStore = SBAScheduledActivityStore()
+    
+    // Snapshot of the schedule values when last loaded, used to find the schedules that have changed.
+    fileprivate var _fingerprints: [String : SBAScheduledActivityFingerprint] = [:]
+    fileprivate var _notificationKeys: [String]?
+    
+    // Incremented whenever the activities are changed so that a snapshot built from stale state is not applied.
+    fileprivate var _loadGeneration: Int = 0
+    fileprivate var _isApplyingSnapshot = false
+    
+    // The activities were rebuilt from the `snapshotCache` and have not yet been replaced by the
+    // schedules loaded by BridgeSDK.
+    fileprivate var _isLoadedFromSnapshotCache = false
+    
+    /**
+     Timing for each stage of the most recent schedule load.
+     */
+    public fileprivate(set) var lastLoadMetrics: SBAScheduleLoadMetrics?
+    
+    /**
+     Serial queue used to sort, filter and section the schedules when they are loaded.
+     */
+    public let scheduleLoadQueue = DispatchQueue(label: "org.sagebase.BridgeAppSDK.SBAScheduledActivityManager.scheduleLoad", qos: .userInitiated)
     
     /**
      Number of days ahead to fetch
@@ -131,12 +196,59 @@ open class SBABaseScheduledActivityManager: NSObject, ORKTaskViewControllerDeleg
     */
     open var daysBehind: Int!
     
+    /**
+     On-disk snapshot of the filtered activities that is used to display the activities at launch
+     before the BridgeSDK cache is fetched. If `nil`, then a snapshot is not used.
+     */
+    open var snapshotCache: SBAScheduledActivitySnapshotCache?
+    
+    /**
+     The prefetcher used to download the surveys for the scheduled activities after the full date
+     range has been loaded from the server. Default = `SBASurveyPrefetcher.shared`.
+     */
+    open var surveyPrefetcher: SBASurveyPrefetcher = SBASurveyPrefetcher.shared
+    
+    /**
+     The queue used to send the updated schedules to the server. Updates are batched and the
+     schedules are reloaded when a batch has been sent. Default = `SBAScheduleUpdateQueue.shared`.
+     */
+    open var scheduleUpdateQueue: SBAScheduleUpdateQueue = SBAScheduleUpdateQueue.shared
+    
+    /**
+     The budget used to limit the disk space used by the task output directories and the archives
+     that are waiting to be uploaded. Default = `SBADiskBudget.shared`.
+     */
+    open var diskBudget: SBADiskBudget = SBADiskBudget.shared
+    fileprivate var scheduleUpdateObserver: NSObjectProtocol?
+    
+    /**
+     The version of the snapshot. This includes the app build and the values used to filter the
+     schedules. A snapshot with a different version is ignored.
+     */
+    open var snapshotVersion: String {
+        return "\(SBAScheduledActivitySnapshotCache.appVersion)|\(daysAhead ?? 0)|\(daysBehind ?? 0)"
+    }
+    
+    /**
+     A filter that can be used to evaluate whether or not a schedule should be included.
+     Default == `SBAScheduleFilter.all`
+     */
+    open var scheduleFilter: SBAScheduleFilter = .all
+    
     /**
      A predicate that can be used to evaluate whether or not a schedule should be included.
      This can include block predicates and is evaluated on a `SBBScheduledActivity` object.
+     Setting the predicate will replace the `scheduleFilter` with a filter that evaluates the predicate.
      Default == `true`
      */
-    open var scheduleFilterPredicate: NSPredicate = NSPredicate(value: true)
+    open var scheduleFilterPredicate: NSPredicate {
+        get {
+            return scheduleFilter.predicate
+        }
+        set {
+            scheduleFilter = SBAScheduleFilter(predicate: newValue)
+        }
+    }
 
     // MARK: SBAScheduledActivityDataSource
     
@@ -159,6 +271,8 @@ open class SBABaseScheduledActivityManager: NSObject, ORKTaskViewControllerDeleg
     open func resetData() {
         _loadingState = .firstLoad
         _loadingBlocked = false
+        _notificationKeys = nil
+        snapshotCache?.remove()
         self.activities.removeAll()
     }
     
@@ -183,6 +297,7 @@ open class SBABaseScheduledActivityManager: NSObject, ORKTaskViewControllerDeleg
             // added schedules or whatnot. Note: for this project, this is not expected
             // to yeild any different info, but the project could change. syoung 07/17/2017
             _loadingState = .cachedLoad
+            loadSnapshotCache()
             SBABridgeManager.fetchAllCachedScheduledActivities() { [weak self] (obj, _) in
                 self?.handleLoadedActivities(obj as? [SBBScheduledActivity], from: fromDate, to: toDate)
             }
@@ -224,16 +339,39 @@ open class SBABaseScheduledActivityManager: NSObject, ORKTaskViewControllerDeleg
         }
         
         DispatchQueue.main.async {
-            if let scheduledActivities = self.sortActivities(scheduledActivities) {
-                self.load(scheduledActivities: scheduledActivities)
-            }
-            if self._loadingState == .fromServerForFullDateRange {
-                // If the loading state is for the full range, then we are done.
-                self._reloading = false
-            }
-            else {
-                // Otherwise, load more range from the server
-                self.loadFromServer(from: fromDate, to: toDate)
+            // Sort, filter and section the schedules on a background queue and then apply the
+            // snapshot on the main queue.
+            let context = self.createLoadContext()
+            self.scheduleLoadQueue.async {
+                var sortDuration: TimeInterval = 0
+                let sortedActivities = SBAScheduleLoadMetrics.measure("Sort", &sortDuration) {
+                    return self.sortActivities(scheduledActivities)
+                }
+                var snapshot: SBAScheduledActivitySnapshot?
+                if let sortedActivities = sortedActivities {
+                    snapshot = self.createSnapshot(for: sortedActivities, context: context)
+                    snapshot?.metrics.sortDuration = sortDuration
+                }
+                DispatchQueue.main.async {
+                    if let snapshot = snapshot {
+                        // Load the schedules through `load(scheduledActivities:)` so that subclass
+                        // overrides are called. The default implementation applies the snapshot.
+                        self._prebuiltSnapshot = snapshot
+                        self.load(scheduledActivities: snapshot.scheduledActivities)
+                        self._prebuiltSnapshot = nil
+                        if context.loadingState != .cachedLoad && snapshot.hasChanges {
+                            self.writeSnapshotCache()
+                        }
+                    }
+                    if self._loadingState == .fromServerForFullDateRange {
+                        // If the loading state is for the full range, then we are done.
+                        self._reloading = false
+                    }
+                    else {
+                        // Otherwise, load more range from the server
+                        self.loadFromServer(from: fromDate, to: toDate)
+                    }
+                }
             }
         }
     }
@@ -244,11 +382,20 @@ open class SBABaseScheduledActivityManager: NSObject, ORKTaskViewControllerDeleg
         }
     }
     
+    /**
+     Sort the scheduled activities returned by the service. When the schedules are loaded from the
+     service, this method is called on the `scheduleLoadQueue` rather than the main thread, so an
+     override should not read properties of the manager that are changed on the main thread.
+     */
     open func sortActivities(_ scheduledActivities: [SBBScheduledActivity]?) -> [SBBScheduledActivity]? {
-        guard (scheduledActivities?.count ?? 0) > 0 else { return nil }
-        return scheduledActivities!.sorted(by: { (scheduleA, scheduleB) -> Bool in
+        guard let scheduledActivities = scheduledActivities, scheduledActivities.count > 0 else { return nil }
+        let isOrderedBefore: (SBBScheduledActivity, SBBScheduledActivity) -> Bool = { (scheduleA, scheduleB) in
             return scheduleA.scheduledOn.compare(scheduleB.scheduledOn) == .orderedAscending
-        })
+        }
+        
+        // The schedules returned by Bridge are typically already sorted, so check before sorting.
+        let isSorted = zip(scheduledActivities, scheduledActivities.dropFirst()).first(where: { isOrderedBefore($1, $0) }) == nil
+        return isSorted ? scheduledActivities : scheduledActivities.sorted(by: isOrderedBefore)
     }
     
     /**
@@ -281,32 +428,217 @@ open class SBABaseScheduledActivityManager: NSObject, ORKTaskViewControllerDeleg
     // MARK: Data handling
     
     /**
-     Called once the response from the server returns the scheduled activities.
+     Called on the main thread once the response from the server returns the scheduled activities.
+     
+     When the schedules are loaded from the service, the snapshot is built on the `scheduleLoadQueue`
+     before this method is called and the default implementation applies that snapshot. Otherwise,
+     or if an override calls `super` with different schedules, the snapshot is built and applied on
+     the current thread.
      
      @param     scheduledActivities     The list of activities returned by the service.
      */
     open func load(scheduledActivities: [SBBScheduledActivity]) {
+        if let snapshot = _prebuiltSnapshot,
+            snapshot.scheduledActivities.count == scheduledActivities.count,
+            !zip(snapshot.scheduledActivities, scheduledActivities).contains(where: { $0 !== $1 }) {
+            apply(snapshot: snapshot)
+        }
+        else {
+            apply(snapshot: createSnapshot(for: scheduledActivities, context: createLoadContext()))
+        }
+    }
+    fileprivate var _prebuiltSnapshot: SBAScheduledActivitySnapshot?
+    
+    /**
+     Load the activities from the `snapshotCache`. This is called on the main thread when the
+     activities are first loaded so that the activities can be displayed before the BridgeSDK
+     cache is fetched.
+     
+     @return    `true` if the activities were loaded from the snapshot.
+     */
+    @discardableResult
+    open func loadSnapshotCache() -> Bool {
+        guard self.activities.count == 0,
+            let contents = snapshotCache?.read(version: snapshotVersion), contents.activities.count > 0
+            else {
+                return false
+        }
         
-        // schedule notifications
-        setupNotifications(for: scheduledActivities)
+        self.activities = contents.activities
+        _isLoadedFromSnapshotCache = true
+        if let sectionRows = contents.sectionRows, contents.day == Date().startOfDay() {
+            let count = contents.activities.count
+            apply(sectionRows: sectionRows.map({ $0.filter({ $0 < count }).map({ contents.activities[$0] }) }), day: contents.day)
+        }
+        
+        let changes = SBAScheduledActivityChanges(insertedGuids: Set(contents.activities.compactMap({ $0.guid })))
+        self.delegate?.scheduledActivitiesDidChange(self, changes: changes)
+        return true
+    }
+    
+    /**
+     Write the current activities to the `snapshotCache`. The file is written on the `scheduleLoadQueue`.
+     */
+    open func writeSnapshotCache() {
+        guard let snapshotCache = self.snapshotCache else { return }
+        let activities = self.activities
+        let sectionGuids = displayedRowIdentifiers(cachedOnly: true)
+        let day = Date().startOfDay()
+        let version = self.snapshotVersion
+        scheduleLoadQueue.async {
+            do {
+                try snapshotCache.write(activities: activities, sectionGuids: sectionGuids, day: day, version: version)
+            } catch let err {
+                debugPrint("Failed to write schedule snapshot: \(err)")
+            }
+        }
+    }
+    
+    /**
+     Copy the state of the manager that is needed to build a snapshot. This should be called on the
+     main thread.
+     */
+    public final func createLoadContext() -> SBAScheduleLoadContext {
+        let sectionFilters = self.sectionFilters()
+        return SBAScheduleLoadContext(generation: _loadGeneration,
+                                      loadingState: _loadingState,
+                                      day: Date().startOfDay(),
+                                      activities: self.activities,
+                                      scheduleFilter: self.scheduleFilter,
+                                      isLoadedFromSnapshotCache: _isLoadedFromSnapshotCache,
+                                      fingerprints: _fingerprints,
+                                      notificationKeys: _notificationKeys,
+                                      sectionFilters: sectionFilters,
+                                      displayedRows: (sectionFilters != nil) ? displayedRowIdentifiers(cachedOnly: true) : nil)
+    }
+    
+    /**
+     Build a snapshot of the schedules. This can be called on any thread.
+     
+     @param     scheduledActivities     The sorted list of activities returned by the service.
+     @param     context                 The state of the manager when the load was started.
+     @return                            The snapshot to apply.
+     */
+    public final func createSnapshot(for scheduledActivities: [SBBScheduledActivity], context: SBAScheduleLoadContext) -> SBAScheduledActivitySnapshot {
+        var metrics = SBAScheduleLoadMetrics()
+        metrics.scheduleCount = scheduledActivities.count
         
         // Filter the scheduled activities to only include those that *this* version of the app is designed
         // to be able to handle. Currently, that means only taskReference activities with an identifier that
         // maps to a known task.
-        self.activities = filteredSchedules(scheduledActivities: scheduledActivities)
+        let filteredActivities = SBAScheduleLoadMetrics.measure("Filter", &metrics.filterDuration) {
+            return filteredSchedules(scheduledActivities: scheduledActivities, context: context)
+        }
+        
+        // Merge the schedules by guid so that only the schedules that were inserted, removed or
+        // changed are sent to the delegate.
+        var changes = SBAScheduledActivityChanges()
+        var hasChanges = false
+        var store = SBAScheduledActivityStore()
+        var fingerprints: [String : SBAScheduledActivityFingerprint] = [:]
+        var notificationKeys: [String] = []
+        SBAScheduleLoadMetrics.measure("Merge", &metrics.mergeDuration) {
+            fingerprints = SBAScheduledActivitySnapshot.fingerprints(for: filteredActivities)
+            var insertedGuids = Set<String>()
+            var updatedGuids = Set<String>()
+            for (guid, fingerprint) in fingerprints {
+                if let previous = context.fingerprints[guid] {
+                    if previous != fingerprint {
+                        updatedGuids.insert(guid)
+                    }
+                }
+                else {
+                    insertedGuids.insert(guid)
+                }
+            }
+            let removedGuids = Set(context.fingerprints.keys.filter({ fingerprints[$0] == nil }))
+            changes = SBAScheduledActivityChanges(insertedGuids: insertedGuids, removedGuids: removedGuids, updatedGuids: updatedGuids)
+            // The activities rebuilt from the snapshot cache are always replaced by the schedules
+            // loaded by BridgeSDK, even if they have not changed.
+            hasChanges = context.isLoadedFromSnapshotCache || !changes.isEmpty ||
+                filteredActivities.count != context.activities.count ||
+                zip(filteredActivities, context.activities).contains(where: { $0.guid != $1.guid })
+            if hasChanges {
+                store = SBAScheduledActivityStore(activities: filteredActivities)
+            }
+            notificationKeys = scheduledActivities.map({ SBAScheduledActivityFingerprint($0).notificationKey })
+        }
         
-        // reload table
-        self.delegate?.reloadFinished(self)
+        // Split the schedules into table sections and calculate the rows that changed
+        var sectionRows: [[SBBScheduledActivity]]?
+        if let filters = context.sectionFilters {
+            SBAScheduleLoadMetrics.measure("Section", &metrics.sectionDuration) {
+                let rows = SBAScheduledActivitySnapshot.sectionRows(for: filteredActivities, filters: filters)
+                changes.calculateRowChanges(from: context.displayedRows, to: rows.map({ $0.compactMap({ $0.guid }) }))
+                sectionRows = rows
+            }
+        }
         
-        // preload all the surveys so that they can be accessed offline
-        if _loadingState == .fromServerForFullDateRange {
-            for schedule in scheduledActivities {
-                if schedule.activity.survey != nil {
-                    SBABridgeManager.loadSurvey(schedule.activity.survey!, completion:{ (_, _) in
-                    })
+        return SBAScheduledActivitySnapshot(scheduledActivities: scheduledActivities,
+                                            activities: filteredActivities,
+                                            activityStore: store,
+                                            sectionRows: sectionRows,
+                                            changes: changes,
+                                            hasChanges: hasChanges,
+                                            metrics: metrics,
+                                            context: context,
+                                            fingerprints: fingerprints,
+                                            notificationKeys: notificationKeys)
+    }
+    
+    /**
+     Apply a snapshot of the schedules. This should be called on the main thread.
+     
+     @param     snapshot    The snapshot built from the schedules returned by the service.
+     */
+    open func apply(snapshot: SBAScheduledActivitySnapshot) {
+        var metrics = snapshot.metrics
+        SBAScheduleLoadMetrics.measure("Apply", &metrics.applyDuration) {
+            
+            // schedule notifications if the schedules that they are built from have changed
+            if _notificationKeys != snapshot.notificationKeys {
+                _notificationKeys = snapshot.notificationKeys
+                setupNotifications(for: snapshot.scheduledActivities)
+            }
+            
+            var changes = snapshot.changes
+            if snapshot.context.generation != _loadGeneration {
+                // The activities were changed while the snapshot was built so rebuild the indexes
+                // and reload the table.
+                self.activities = snapshot.activities
+                changes.calculateRowChanges(from: nil, to: [])
+            }
+            else if snapshot.hasChanges {
+                // Swap in the indexes that were built with the snapshot
+                _isApplyingSnapshot = true
+                self.activities = snapshot.activities
+                _isApplyingSnapshot = false
+                if snapshot.context.loadingState != .fromServerWithFutureOnly {
+                    // A future-only load may still include activities from the snapshot cache
+                    _isLoadedFromSnapshotCache = false
+                }
+                _activityStore = snapshot.activityStore
+                _fingerprints = snapshot.fingerprints
+                if let sectionRows = snapshot.sectionRows {
+                    apply(sectionRows: sectionRows, day: snapshot.context.day)
                 }
             }
+            
+            // update table
+            self.delegate?.scheduledActivitiesDidChange(self, changes: changes)
         }
+        self.lastLoadMetrics = metrics
+        
+        // preload all the surveys so that they can be accessed offline
+        if snapshot.context.loadingState == .fromServerForFullDateRange {
+            let surveyReferences = snapshot.scheduledActivities.compactMap { $0.activity.survey }
+            surveyPrefetcher.prefetch(surveyReferences, removeUnreferenced: true)
+        }
+    }
+    
+    @available(*, unavailable, message:"Use `filteredSchedules(scheduledActivities:context:)` instead.")
+    open func filteredSchedules(scheduledActivities: [SBBScheduledActivity]) -> [SBBScheduledActivity] {
+        return []
     }
     
     /**
@@ -314,23 +646,39 @@ open class SBABaseScheduledActivityManager: NSObject, ORKTaskViewControllerDeleg
      to be able to handle. Currently, that means only taskReference activities with an identifier that
      maps to a known task.
      
+     When the schedules are loaded from the service, this method is called on the `scheduleLoadQueue`
+     rather than the main thread. An override should use the state of the manager copied into the
+     `context` rather than reading properties of the manager that are changed on the main thread.
+     
      @param     scheduledActivities     The list of activities returned by the service.
+     @param     context                 The state of the manager when the load was started.
      @return                            The filtered list of activities
      */
-    open func filteredSchedules(scheduledActivities: [SBBScheduledActivity]) -> [SBBScheduledActivity] {
-        if _loadingState == .fromServerWithFutureOnly {
+    open func filteredSchedules(scheduledActivities: [SBBScheduledActivity], context: SBAScheduleLoadContext) -> [SBBScheduledActivity] {
+        if context.loadingState == .fromServerWithFutureOnly {
             // The future only will be in a state where we already have the cached data,
-            // And we will probably just be appending new data onto the cached data
+            // And we will probably just be appending new data onto the cached data. Existing
+            // activities are replaced by the loaded schedule with the same guid so that any
+            // activities rebuilt from the snapshot cache are swapped for the BridgeSDK objects.
+            var loadedActivities: [String : SBBScheduledActivity] = [:]
+            for activity in scheduledActivities {
+                guard let guid = activity.guid else { continue }
+                loadedActivities[guid] = activity
+            }
+            let existingActivities = context.activities.map({ (activity) -> SBBScheduledActivity in
+                guard let guid = activity.guid else { return activity }
+                return loadedActivities.removeValue(forKey: guid) ?? activity
+            })
             let filteredActivities = scheduledActivities.filter({ (activity) in
-                return !self.activities.contains(where: { (existingActivity) -> Bool in
-                    return existingActivity.guid == activity.guid
-                })
+                guard let guid = activity.guid else { return true }
+                return loadedActivities[guid] != nil
             })
-            return self.activities.sba_appending(contentsOf: filteredActivities)
+            return existingActivities.sba_appending(contentsOf: filteredActivities)
         }
+        let scheduleFilter = context.scheduleFilter
         return scheduledActivities.filter({ (schedule) -> Bool in
             return bridgeInfo.taskReferenceForSchedule(schedule) != nil &&
-                self.scheduleFilterPredicate.evaluate(with: schedule)
+                scheduleFilter.evaluate(with: schedule)
         })
     }
     
@@ -373,7 +721,7 @@ open class SBABaseScheduledActivityManager: NSObject, ORKTaskViewControllerDeleg
             scheduledTime = Localization.localizedString("SBA_ACTIVITY_TOMORROW")
         }
         else {
-            scheduledTime = DateFormatter.localizedString(from: schedule.scheduledOn, dateStyle: .medium, timeStyle: .none)
+            scheduledTime = SBAFormatterCache.shared.dateFormatter(dateStyle: .medium, timeStyle: .none).string(from: schedule.scheduledOn)
         }
         return Localization.localizedStringWithFormatKey("SBA_ACTIVITY_SCHEDULE_MESSAGE", scheduledTime)
     }
@@ -408,7 +756,7 @@ open class SBABaseScheduledActivityManager: NSObject, ORKTaskViewControllerDeleg
             else {
                 return nil
         }
-        return activities.sba_find({ $0.activity.guid == scheduleIdentifier })
+        return activityStore.activity(withScheduleIdentifier: scheduleIdentifier)
     }
     
     /**
@@ -419,7 +767,70 @@ open class SBABaseScheduledActivityManager: NSObject, ORKTaskViewControllerDeleg
      */
     @objc(scheduledActivityForTaskIdentifier:)
     open func scheduledActivity(for taskIdentifier: String) -> SBBScheduledActivity? {
-        return activities.sba_find({ $0.activityIdentifier == taskIdentifier })
+        return activityStore.firstActivity(withActivityIdentifier: taskIdentifier)
+    }
+    
+    /**
+     Called on the main thread when schedules included in `activities` have been changed in place
+     (for example, when a task is finished) so that the indexes can be updated without rebuilding
+     them.
+     
+     @param     scheduledActivities     The schedules that were changed.
+     */
+    @objc(didUpdateScheduledActivities:)
+    open func didUpdate(scheduledActivities: [SBBScheduledActivity]) {
+        _loadGeneration = _loadGeneration &+ 1
+        let oldRows = displayedRowIdentifiers(cachedOnly: true)
+        var updatedGuids = Set<String>()
+        for schedule in scheduledActivities {
+            guard _activityStore.update(schedule) != nil, let guid = schedule.guid else { continue }
+            let fingerprint = SBAScheduledActivityFingerprint(schedule)
+            if _fingerprints[guid] != fingerprint {
+                _fingerprints[guid] = fingerprint
+                updatedGuids.insert(guid)
+            }
+        }
+        guard updatedGuids.count > 0 else { return }
+        updateDisplayedRows(for: scheduledActivities)
+        sendChanges(SBAScheduledActivityChanges(updatedGuids: updatedGuids), from: oldRows)
+        writeSnapshotCache()
+    }
+    
+    /**
+     The `guid` of the schedules displayed in each table section or `nil` if this manager does not
+     display the schedules in a table.
+     
+     @param     cachedOnly  Only return the rows if they have already been calculated.
+     */
+    func displayedRowIdentifiers(cachedOnly: Bool) -> [[String]]? {
+        return nil
+    }
+    
+    /**
+     Update the displayed rows for schedules that have been changed in place.
+     */
+    func updateDisplayedRows(for scheduledActivities: [SBBScheduledActivity]) {
+    }
+    
+    /**
+     The filters for each table section or `nil` if this manager does not display the schedules in a table.
+     */
+    func sectionFilters() -> [SBAScheduleFilter?]? {
+        return nil
+    }
+    
+    /**
+     Set the rows for each table section that were calculated when building a snapshot.
+     */
+    func apply(sectionRows: [[SBBScheduledActivity]], day: Date) {
+    }
+    
+    fileprivate func sendChanges(_ changes: SBAScheduledActivityChanges, from oldRows: [[String]]?) {
+        var changes = changes
+        if let newRows = displayedRowIdentifiers(cachedOnly: false) {
+            changes.calculateRowChanges(from: oldRows, to: newRows)
+        }
+        self.delegate?.scheduledActivitiesDidChange(self, changes: changes)
     }
 
     
@@ -446,6 +857,7 @@ open class SBABaseScheduledActivityManager: NSObject, ORKTaskViewControllerDeleg
         taskViewController.dismiss(animated: true) {
             self.offMainQueue.async {
                 self.deleteOutputDirectory(for: taskViewController)
+                self.diskBudget.enforce()
                 self.debugPrintSandboxFiles()
             }
         }
@@ -453,6 +865,11 @@ open class SBABaseScheduledActivityManager: NSObject, ORKTaskViewControllerDeleg
     
     open func taskViewController(_ taskViewController: ORKTaskViewController, stepViewControllerWillAppear stepViewController: ORKStepViewController) {
         
+        // Track the output directory so that it is deleted if the task is interrupted
+        if let outputDirectory = taskViewController.outputDirectory {
+            diskBudget.registerOutputDirectory(outputDirectory)
+        }
+        
         // If cancel is disabled then hide on all but the first step
         if let step = stepViewController.step, shouldHideCancel(for: step, taskViewController: taskViewController) {
             stepViewController.cancelButtonItem = UIBarButtonItem(title: nil, style: .plain, target: nil, action: nil)
@@ -533,6 +950,9 @@ open class SBABaseScheduledActivityManager: NSObject, ORKTaskViewControllerDeleg
     @objc(deleteOutputDirectoryForTaskViewController:)
     open func deleteOutputDirectory(for taskViewController: ORKTaskViewController) {
         guard let outputDirectory = taskViewController.outputDirectory else { return }
+        defer {
+            diskBudget.unregisterOutputDirectory(outputDirectory)
+        }
         do {
             try FileManager.default.removeItem(at: outputDirectory)
         } catch let error {
@@ -676,10 +1096,12 @@ open class SBABaseScheduledActivityManager: NSObject, ORKTaskViewControllerDeleg
         let factory = createFactory(for: schedule, taskRef: taskRef)
         SBAInfoManager.shared.defaultSurveyFactory = factory
         
-        // transform the task reference into a task using the given factory
-        let task = taskRef.transformToTask(with: factory, isLastStep: true)
+        // transform the task reference into a task using the given factory, reusing the
+        // cached template for this task if there is one
+        let task = factory.cachedTask(for: taskRef, isLastStep: true)
         if let surveyTask = task as? SBASurveyTask {
             surveyTask.title = schedule.activity.label
+            surveyTask.surveyPrefetcher = self.surveyPrefetcher
         }
         
         return (task, taskRef)
@@ -744,6 +1166,12 @@ open class SBABaseScheduledActivityManager: NSObject, ORKTaskViewControllerDeleg
      Create a factory to use when creating a survey or active task. Override to create a custom
      survey factory that can be used to vend custom steps.
      
+     The tasks built by the factory are cached in its `taskTemplateCache` using its `taskTemplateKey`,
+     which by default only includes the factory class and the data groups. If an override configures
+     the factory differently for the same task (for example, based on the schedule), then it should
+     use a factory subclass that overrides `taskTemplateKey`, or set `taskTemplateCache` to `nil`.
+     If the resources used to build the tasks change, call `SBATaskTemplateCache.shared.removeAll()`.
+     
      @param     schedule    The schedule associated with this task
      @param     taskRef     The task reference associated with this task
      @return                The factory to use for creating the task
@@ -842,8 +1270,7 @@ open class SBABaseScheduledActivityManager: NSObject, ORKTaskViewControllerDeleg
         
         // Archive the results
         let results = activityResults(for: schedule, task: task, result:result)
-        let archives = results.sba_mapAndFilter({ archive(for: $0) })
-        SBBDataArchive.encryptAndUploadArchives(archives)
+        archiveAndUpload(activityResults: results)
         
         // Update the schedule on the server but only if the survey was not ended early
         if !didEndSurveyEarly(schedule: schedule, task: task, result: result) {
@@ -888,6 +1315,11 @@ open class SBABaseScheduledActivityManager: NSObject, ORKTaskViewControllerDeleg
             }
         }
         
+        // Update the indexes for the changed schedules
+        DispatchQueue.main.async {
+            self.didUpdate(scheduledActivities: scheduledActivities)
+        }
+        
         // Send message to server
         sendUpdated(scheduledActivities: scheduledActivities)
     }
@@ -917,25 +1349,114 @@ open class SBABaseScheduledActivityManager: NSObject, ORKTaskViewControllerDeleg
      Send message to Bridge server to update the given schedules. This includes both the task
      that was completed and any tasks that were performed as a requirement of completion of the
      primary task (such as a required one-time survey).
+     
+     The schedules are added to the `scheduleUpdateQueue` and sent with any other updates in the
+     next batch.
     */
     open func sendUpdated(scheduledActivities: [SBBScheduledActivity]) {
-        SBABridgeManager.updateScheduledActivities(scheduledActivities) {[weak self] (_, _) in
-            DispatchQueue.main.async {
-                self?.reloadData()
+        scheduleUpdateQueue.enqueue(scheduledActivities)
+    }
+    
+    /**
+     Maximum number of archives to build at the same time when a task is finished. When this is
+     greater than 1, `archive(for:)` and `jsonValidationMapping(activityResult:)` are called
+     concurrently from a background queue, so a subclass that overrides either method and sets
+     this value must make its overrides thread-safe.
+     Default = 1
+     */
+    open var maxConcurrentArchiveCount: Int = 1
+    
+    fileprivate let archiveQueue = DispatchQueue(label: "org.sagebase.BridgeAppSDK.SBAScheduledActivityManager.archive", attributes: .concurrent)
+    
+    /**
+     Build the archives for the given activity results and hand each one off to be encrypted and
+     uploaded. The archives are built on a background queue (up to `maxConcurrentArchiveCount` at a
+     time) and each archive is uploaded as soon as it *and* all the archives before it are built, so
+     that the upload order matches the order of the activity results.
+     
+     This method blocks until all the archives have been handed off for upload.
+     
+     @param     activityResults     The `SBAActivityResult` objects to archive
+     @return                        The archives that were built, in the same order as the results.
+     */
+    @discardableResult
+    @objc(archiveAndUploadActivityResults:)
+    open func archiveAndUpload(activityResults: [SBAActivityResult]) -> [SBAActivityArchive] {
+        let count = activityResults.count
+        guard count > 0 else { return [] }
+        
+        // Each slot is `nil` until the archive for that index has been built. The built archive
+        // may itself be `nil` if there was nothing to archive.
+        var built = [SBAActivityArchive??](repeating: nil, count: count)
+        var nextIndex = 0
+        var archives: [SBAActivityArchive] = []
+        
+        let uploadQueue = DispatchQueue(label: "org.sagebase.BridgeAppSDK.SBAScheduledActivityManager.upload")
+        let semaphore = DispatchSemaphore(value: max(1, maxConcurrentArchiveCount))
+        let group = DispatchGroup()
+        
+        for (index, activityResult) in activityResults.enumerated() {
+            
+            // Wait for a free slot before starting to build the next archive
+            semaphore.wait()
+            group.enter()
+            
+            archiveQueue.async {
+                let archive = self.archive(for: activityResult)
+                semaphore.signal()
+                
+                uploadQueue.async {
+                    built[index] = .some(archive)
+                    
+                    // Hand off any archives that are ready and next in line
+                    while nextIndex < count, let ready = built[nextIndex] {
+                        built[nextIndex] = nil
+                        if let archive = ready {
+                            self.upload(archive: archive)
+                            archives.append(archive)
+                        }
+                        nextIndex += 1
+                    }
+                    group.leave()
+                }
             }
         }
+        
+        group.wait()
+        return archives
+    }
+    
+    /**
+     Encrypt and upload a completed archive. Exposed to allow for testing and subclass override.
+     
+     @param     archive     The archive to upload.
+     */
+    @objc(uploadArchive:)
+    open func upload(archive: SBAActivityArchive) {
+        archive.encryptAndUploadArchive()
     }
     
+    /**
+     Size of the buffer used to stream each archive entry to disk as it is built. Set to `nil`
+     to build the archives in memory. Default = `SBAActivityArchive.defaultStreamBufferSize`
+     */
+    open var archiveStreamBufferSize: Int? = SBAActivityArchive.defaultStreamBufferSize
+    
     /**
      Expose method for building archive to allow for testing and subclass override. This method is 
      called during task finish to archive the result for each activity result included in this task.
+     
+     This method is called from a background queue. If `maxConcurrentArchiveCount` is greater than 1,
+     it may be called for several activity results at the same time.
+     
      @param     activityResult      The `SBAActivityResult` to archive
      @return                        The `SBAActivityArchive` object created with the results for this activity.
     */
     @objc(archiveForActivityResult:)
     open func archive(for activityResult: SBAActivityResult) -> SBAActivityArchive? {
         if let archive = SBAActivityArchive(result: activityResult,
-                                            jsonValidationMapping: jsonValidationMapping(activityResult: activityResult)) {
+                                            jsonValidationMapping: jsonValidationMapping(activityResult: activityResult),
+                                            streamBufferSize: archiveStreamBufferSize) {
             do {
                 try archive.complete()
                 return archive
@@ -948,6 +1469,9 @@ open class SBABaseScheduledActivityManager: NSObject, ORKTaskViewControllerDeleg
     
     /**
      Optional method for inserting json prevalidation for a given activity result.
+     
+     This method is called from `archive(for:)` on a background queue. If `maxConcurrentArchiveCount`
+     is greater than 1, it may be called for several activity results at the same time.
     */
     @objc(jsonValidationMappingForActivityResult:)
     open func jsonValidationMapping(activityResult: SBAActivityResult) -> [String: NSPredicate]?{
@@ -1145,15 +1669,116 @@ open class SBAScheduledActivityManager: SBABaseScheduledActivityManager, SBASche
     open var sections: [SBAScheduledActivitySection]! {
         didSet {
             // Filter out any sections that aren't shown
-            let filters = sections.sba_mapAndFilter({ filterPredicate(for: $0) })
-            self.scheduleFilterPredicate = NSCompoundPredicate(orPredicateWithSubpredicates: filters)
+            let filters = sections.sba_mapAndFilter({ filter(for: $0) })
+            self.scheduleFilter = .or(filters)
+            invalidateSections()
+        }
+    }
+    
+    open override var activities: [SBBScheduledActivity] {
+        didSet {
+            invalidateSections()
+        }
+    }
+    
+    open override var daysAhead: Int! {
+        didSet {
+            invalidateSections()
+        }
+    }
+    
+    /**
+     The activities for each table section. This is calculated once for a given day when the
+     activities are loaded and is updated incrementally when a schedule is changed.
+     */
+    fileprivate var _sectionCache: (day: Date, rows: [[SBBScheduledActivity]])?
+    
+    /**
+     Invalidate the activities cached for each table section. This should be called by a subclass
+     if the filter used for a table section is changed.
+     */
+    open func invalidateSections() {
+        _sectionCache = nil
+    }
+    
+    fileprivate func sectionRows() -> [[SBBScheduledActivity]] {
+        let today = Date().startOfDay()
+        if let cache = _sectionCache, cache.day == today {
+            return cache.rows
+        }
+        
+        // Evaluate each filter once per schedule rather than once per table cell
+        let rows = SBAScheduledActivitySnapshot.sectionRows(for: activities, filters: sectionFilters()!)
+        _sectionCache = (today, rows)
+        return rows
+    }
+    
+    override func sectionFilters() -> [SBAScheduleFilter?]? {
+        return (0..<numberOfSections()).map({ filter(for: $0) })
+    }
+    
+    override func apply(sectionRows: [[SBBScheduledActivity]], day: Date) {
+        _sectionCache = (day, sectionRows)
+    }
+    
+    override func displayedRowIdentifiers(cachedOnly: Bool) -> [[String]]? {
+        if cachedOnly {
+            guard let cache = _sectionCache, cache.day == Date().startOfDay() else { return nil }
+            return cache.rows.map({ $0.compactMap({ $0.guid }) })
+        }
+        return sectionRows().map({ $0.compactMap({ $0.guid }) })
+    }
+    
+    override func updateDisplayedRows(for scheduledActivities: [SBBScheduledActivity]) {
+        guard var cache = _sectionCache, cache.day == Date().startOfDay() else {
+            _sectionCache = nil
+            return
+        }
+        
+        // Only reevaluate the section membership of the schedules that were changed
+        let store = self.activityStore
+        for (section, rows) in cache.rows.enumerated() {
+            guard let filter = self.filter(for: section) else { continue }
+            var sectionRows = rows
+            for schedule in scheduledActivities {
+                guard let index = store.index(ofGuid: schedule.guid) else { continue }
+                
+                // Binary search for the position of the schedule using the store order
+                var lower = 0
+                var upper = sectionRows.count
+                while lower < upper {
+                    let mid = (lower + upper) / 2
+                    if (store.index(ofGuid: sectionRows[mid].guid) ?? Int.max) < index {
+                        lower = mid + 1
+                    }
+                    else {
+                        upper = mid
+                    }
+                }
+                let isIncluded = lower < sectionRows.count && sectionRows[lower].guid == schedule.guid
+                let shouldInclude = filter.evaluate(with: schedule)
+                if isIncluded && !shouldInclude {
+                    sectionRows.remove(at: lower)
+                }
+                else if !isIncluded && shouldInclude {
+                    sectionRows.insert(schedule, at: lower)
+                }
+            }
+            cache.rows[section] = sectionRows
         }
+        _sectionCache = cache
+    }
+    
+    open override var snapshotVersion: String {
+        let sectionNames = sections?.map({ "\($0)" }).joined(separator: ",") ?? ""
+        return "\(super.snapshotVersion)|\(sectionNames)"
     }
     
     override func commonInit() {
         super.commonInit()
         // Set the default sections
         self.sections = [.today, .keepGoing]
+        self.snapshotCache = SBAScheduledActivitySnapshotCache()
     }
     
     open func numberOfSections() -> Int {
@@ -1228,7 +1853,30 @@ open class SBAScheduledActivityManager: SBABaseScheduledActivityManager, SBASche
     }
     
     /**
-     Predicate to use to filter the activities for a given table section.
+     Filter to use to filter the activities for a given table section. Override to customize the
+     activities included in a table section.
+     
+     If a subclass overrides `filterPredicate(for:)` then, by default, this method wraps the
+     predicate returned by that method so that the override is still used to build the sections.
+     
+     @param     tableSection    The section index into the table (maps to IndexPath).
+     @return                    The filter to use for the table section.
+     */
+    open func filter(for tableSection: Int) -> SBAScheduleFilter? {
+        if overridesFilterPredicate {
+            guard let predicate = filterPredicate(for: tableSection) else { return nil }
+            return SBAScheduleFilter(predicate: predicate)
+        }
+        guard let section = scheduledActivitySection(for: tableSection) else { return nil }
+        return filter(for: section)
+    }
+    
+    /**
+     Predicate to use to filter the activities for a given table section. Override to customize the
+     activities included in a table section.
+     
+     A predicate is evaluated using key-value coding for each schedule, which is slower than a
+     compiled filter, so new subclasses should override `filter(for:)` instead.
      
      @param     tableSection    The section index into the table (maps to IndexPath).
      @return                    The predicate to use to filter the table section.
@@ -1236,34 +1884,37 @@ open class SBAScheduledActivityManager: SBABaseScheduledActivityManager, SBASche
     @objc(filterPredicateForTableSection:)
     open func filterPredicate(for tableSection: Int) -> NSPredicate? {
         guard let section = scheduledActivitySection(for: tableSection) else { return nil }
-        return filterPredicate(for: section)
+        return filter(for: section)?.predicate
+    }
+    
+    /**
+     Whether or not a subclass overrides `filterPredicate(for:)`.
+     */
+    private var overridesFilterPredicate: Bool {
+        let selector = #selector(SBAScheduledActivityManager.filterPredicate(for:))
+        return type(of: self).instanceMethod(for: selector) != SBAScheduledActivityManager.instanceMethod(for: selector)
     }
     
-    private func filterPredicate(for section: SBAScheduledActivitySection) -> NSPredicate? {
+    private func filter(for section: SBAScheduledActivitySection) -> SBAScheduleFilter? {
         switch section {
             
         case .expiredYesterday:
             // expired yesterday section only showns those expired tasks that are also unfinished
-            return SBBScheduledActivity.expiredYesterdayPredicate()
+            return .expiredYesterday()
             
         case .today:
-            return NSCompoundPredicate(andPredicateWithSubpredicates: [
-                NSCompoundPredicate(notPredicateWithSubpredicate: SBBScheduledActivity.optionalPredicate()),
-                SBBScheduledActivity.availableTodayPredicate()])
+            return .and([.not(.optional), .availableToday()])
             
         case .keepGoing:
             // Keep going section includes optional tasks that are either unfinished or were finished today
-            return NSCompoundPredicate(andPredicateWithSubpredicates: [
-                SBBScheduledActivity.optionalPredicate(),
-                SBBScheduledActivity.unfinishedPredicate(),
-                SBBScheduledActivity.availableTodayPredicate()])
+            return .and([.optional, .unfinished, .availableToday()])
             
         case .tomorrow:
             // scheduled for tomorrow only
-            return SBBScheduledActivity.scheduledTomorrowPredicate()
+            return .scheduledTomorrow()
             
         case .comingUp:
-            return SBBScheduledActivity.scheduledComingUpPredicate(numberOfDays: self.daysAhead)
+            return .scheduledComingUp(numberOfDays: self.daysAhead)
             
         case .none:
             return nil
@@ -1278,8 +1929,9 @@ open class SBAScheduledActivityManager: SBABaseScheduledActivityManager, SBASche
      */
     @objc(scheduledActivitiesForTableSection:)
     open func scheduledActivities(for tableSection: Int) -> [SBBScheduledActivity] {
-        guard let predicate = filterPredicate(for: tableSection) else { return [] }
-        return activities.filter({ predicate.evaluate(with: $0) })
+        let rows = sectionRows()
+        guard tableSection < rows.count else { return [] }
+        return rows[tableSection]
     }
     
     private func scheduledActivitySection(for tableSection: Int) -> SBAScheduledActivitySection? {
@@ -0,0 +1,206 @@
+//
+//  SBAScheduledActivitySnapshot.swift
+//  BridgeAppSDK
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+
+import BridgeSDK
+import os
+
+/**
+ `SBAScheduleLoadMetrics` records the time spent in each stage of loading the scheduled activities.
+ Each stage is also marked with a signpost (iOS 12 and later) using the `ScheduleLoad` category so
+ that the cost of a load can be viewed in Instruments.
+ */
+public struct SBAScheduleLoadMetrics {
+    
+    /**
+     The log used for the schedule load signposts.
+     */
+    public static let log = OSLog(subsystem: "org.sagebase.BridgeAppSDK", category: "ScheduleLoad")
+    
+    /**
+     The number of schedules returned by the service.
+     */
+    public internal(set) var scheduleCount: Int = 0
+    
+    /**
+     Time spent sorting the schedules (background queue).
+     */
+    public internal(set) var sortDuration: TimeInterval = 0
+    
+    /**
+     Time spent filtering the schedules (background queue).
+     */
+    public internal(set) var filterDuration: TimeInterval = 0
+    
+    /**
+     Time spent comparing the schedules to the current schedules and building the indexes
+     (background queue).
+     */
+    public internal(set) var mergeDuration: TimeInterval = 0
+    
+    /**
+     Time spent splitting the schedules into table sections (background queue).
+     */
+    public internal(set) var sectionDuration: TimeInterval = 0
+    
+    /**
+     Time spent applying the snapshot (main queue).
+     */
+    public internal(set) var applyDuration: TimeInterval = 0
+    
+    /**
+     Total time spent loading the schedules.
+     */
+    public var totalDuration: TimeInterval {
+        return sortDuration + filterDuration + mergeDuration + sectionDuration + applyDuration
+    }
+    
+    static func measure<T>(_ name: StaticString, _ duration: inout TimeInterval, _ block: () throws -> T) rethrows -> T {
+        if #available(iOS 12.0, *) {
+            os_signpost(.begin, log: log, name: name)
+        }
+        let start = CFAbsoluteTimeGetCurrent()
+        defer {
+            duration += CFAbsoluteTimeGetCurrent() - start
+            if #available(iOS 12.0, *) {
+                os_signpost(.end, log: log, name: name)
+            }
+        }
+        return try block()
+    }
+}
+
+/**
+ `SBAScheduleLoadContext` is a copy of the state of a `SBABaseScheduledActivityManager` that is
+ used to build a `SBAScheduledActivitySnapshot` off the main thread. It should be created on the
+ main thread.
+ */
+public struct SBAScheduleLoadContext {
+    
+    let generation: Int
+    
+    /**
+     The loading state of the manager when the load was started.
+     */
+    public let loadingState: SBAScheduleLoadState
+    
+    let day: Date
+    
+    /**
+     The activities that were loaded when the load was started.
+     */
+    public let activities: [SBBScheduledActivity]
+    
+    /**
+     The `scheduleFilter` of the manager when the load was started.
+     */
+    public let scheduleFilter: SBAScheduleFilter
+    
+    let isLoadedFromSnapshotCache: Bool
+    let fingerprints: [String : SBAScheduledActivityFingerprint]
+    let notificationKeys: [String]?
+    let sectionFilters: [SBAScheduleFilter?]?
+    let displayedRows: [[String]]?
+}
+
+/**
+ `SBAScheduledActivitySnapshot` is an immutable, sorted and filtered set of scheduled activities
+ that is built on a background queue and then applied to the manager on the main thread.
+ */
+public struct SBAScheduledActivitySnapshot {
+    
+    /**
+     The schedules returned by the service, sorted by `scheduledOn`.
+     */
+    public let scheduledActivities: [SBBScheduledActivity]
+    
+    /**
+     The filtered schedules to include in the manager `activities`.
+     */
+    public let activities: [SBBScheduledActivity]
+    
+    /**
+     Indexed store of the `activities`.
+     */
+    public let activityStore: SBAScheduledActivityStore
+    
+    /**
+     The activities in each table section or `nil` if the manager does not use table sections.
+     */
+    public let sectionRows: [[SBBScheduledActivity]]?
+    
+    /**
+     The changes from the schedules that were loaded when the snapshot was started.
+     */
+    public let changes: SBAScheduledActivityChanges
+    
+    /**
+     Whether or not the `activities` are different from the activities that were loaded when the
+     snapshot was started.
+     */
+    public let hasChanges: Bool
+    
+    /**
+     The time spent building the snapshot.
+     */
+    public internal(set) var metrics: SBAScheduleLoadMetrics
+    
+    let context: SBAScheduleLoadContext
+    let fingerprints: [String : SBAScheduledActivityFingerprint]
+    let notificationKeys: [String]
+    
+    /**
+     Split the activities into table sections. The filters are evaluated once per schedule.
+     */
+    static func sectionRows(for activities: [SBBScheduledActivity], filters: [SBAScheduleFilter?]) -> [[SBBScheduledActivity]] {
+        var rows = [[SBBScheduledActivity]](repeating: [], count: filters.count)
+        for schedule in activities {
+            for (section, filter) in filters.enumerated() {
+                if let filter = filter, filter.evaluate(with: schedule) {
+                    rows[section].append(schedule)
+                }
+            }
+        }
+        return rows
+    }
+    
+    static func fingerprints(for activities: [SBBScheduledActivity]) -> [String : SBAScheduledActivityFingerprint] {
+        var fingerprints: [String : SBAScheduledActivityFingerprint] = [:]
+        for schedule in activities {
+            guard let guid = schedule.guid, fingerprints[guid] == nil else { continue }
+            fingerprints[guid] = SBAScheduledActivityFingerprint(schedule)
+        }
+        return fingerprints
+    }
+}
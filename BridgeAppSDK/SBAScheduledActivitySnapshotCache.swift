@@ -0,0 +1,241 @@
+//
+//  SBAScheduledActivitySnapshotCache.swift
+//  BridgeAppSDK
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+
+import BridgeSDK
+
+/**
+ `SBAScheduledActivitySnapshotCache` is a compact on-disk copy of the filtered and sectioned scheduled
+ activities. It is written after each load from the server and read at launch so that the activity
+ list can be displayed before the BridgeSDK cache is fetched.
+ 
+ The file is a binary property list that is read using a memory-mapped `Data`. The contents are
+ versioned by the app build and the schedule filter so that a snapshot written by a different
+ version of the app (or with different table sections) is ignored.
+ */
+public struct SBAScheduledActivitySnapshotCache {
+    
+    /**
+     The version of the file format. This should be incremented if the encoded records are changed.
+     */
+    public static let formatVersion = 1
+    
+    /**
+     The default location of the snapshot in the caches directory.
+     */
+    public static var defaultURL: URL {
+        let cachesURL = FileManager.default.urls(for: .cachesDirectory, in: .userDomainMask).first ?? URL(fileURLWithPath: NSTemporaryDirectory())
+        return cachesURL.appendingPathComponent("SBAScheduledActivitySnapshot.plist")
+    }
+    
+    /**
+     The version of the app that is used to version the snapshot.
+     */
+    public static var appVersion: String {
+        let info = Bundle.main.infoDictionary
+        let shortVersion = info?["CFBundleShortVersionString"] as? String ?? ""
+        let build = info?["CFBundleVersion"] as? String ?? ""
+        return "\(formatVersion)|\(shortVersion)|\(build)"
+    }
+    
+    /**
+     The contents of the snapshot.
+     */
+    public struct Contents {
+        
+        /**
+         The filtered activities.
+         */
+        public let activities: [SBBScheduledActivity]
+        
+        /**
+         The index into `activities` of the schedules in each table section (if applicable).
+         */
+        public let sectionRows: [[Int]]?
+        
+        /**
+         The day for which the table sections were calculated.
+         */
+        public let day: Date
+    }
+    
+    /**
+     Location of the file.
+     */
+    public let url: URL
+    
+    public init(url: URL = SBAScheduledActivitySnapshotCache.defaultURL) {
+        self.url = url
+    }
+    
+    /**
+     Read the snapshot.
+     
+     @param     version     The version of the snapshot to read.
+     @return                The contents or `nil` if the file does not exist or was written for a different version.
+     */
+    public func read(version: String) -> Contents? {
+        guard let data = try? Data(contentsOf: url, options: .alwaysMapped),
+            let file = try? PropertyListDecoder().decode(File.self, from: data),
+            file.version == version
+            else {
+                return nil
+        }
+        return Contents(activities: file.records.map({ $0.scheduledActivity() }), sectionRows: file.sectionRows, day: file.day)
+    }
+    
+    /**
+     Write the snapshot. If any of the activities cannot be represented by the snapshot (for example,
+     a compound activity) then the snapshot is removed.
+     
+     @param     activities      The filtered activities.
+     @param     sectionGuids    The `guid` of the activities in each table section (if applicable).
+     @param     day             The day for which the table sections were calculated.
+     @param     version         The version of the snapshot.
+     */
+    public func write(activities: [SBBScheduledActivity], sectionGuids: [[String]]?, day: Date, version: String) throws {
+        var records: [Record] = []
+        records.reserveCapacity(activities.count)
+        var indexes: [String : Int] = [:]
+        for (index, schedule) in activities.enumerated() {
+            guard let record = Record(schedule) else {
+                remove()
+                return
+            }
+            records.append(record)
+            if let guid = schedule.guid {
+                indexes[guid] = index
+            }
+        }
+        let rows = sectionGuids?.map({ $0.compactMap({ indexes[$0] }) })
+        let file = File(version: version, day: day, records: records, sectionRows: rows)
+        
+        let encoder = PropertyListEncoder()
+        encoder.outputFormat = .binary
+        let data = try encoder.encode(file)
+        try FileManager.default.createDirectory(at: url.deletingLastPathComponent(), withIntermediateDirectories: true, attributes: nil)
+        try data.write(to: url, options: [.atomic, .completeFileProtectionUntilFirstUserAuthentication])
+    }
+    
+    /**
+     Remove the snapshot.
+     */
+    public func remove() {
+        try? FileManager.default.removeItem(at: url)
+    }
+    
+    fileprivate struct File: Codable {
+        let version: String
+        let day: Date
+        let records: [Record]
+        let sectionRows: [[Int]]?
+    }
+    
+    /**
+     The values of a scheduled activity that are needed to display the schedule and start the task.
+     */
+    fileprivate struct Record: Codable {
+        let guid: String
+        let scheduledOn: Date?
+        let expiresOn: Date?
+        let startedOn: Date?
+        let finishedOn: Date?
+        let persistent: Bool
+        let activityGuid: String?
+        let activityType: String?
+        let label: String?
+        let labelDetail: String?
+        let taskIdentifier: String?
+        let surveyIdentifier: String?
+        let surveyGuid: String?
+        let surveyCreatedOn: Date?
+        let surveyHref: String?
+        
+        init?(_ schedule: SBBScheduledActivity) {
+            // Bridging from Obj-C does not guarantee that the values are non-nil
+            guard let guid = schedule.guid, let activity: SBBActivity = schedule.activity,
+                activity.compoundActivity == nil
+                else {
+                    return nil
+            }
+            let scheduledOn: Date? = schedule.scheduledOn
+            self.guid = guid
+            self.scheduledOn = scheduledOn
+            self.expiresOn = schedule.expiresOn
+            self.startedOn = schedule.startedOn
+            self.finishedOn = schedule.finishedOn
+            self.persistent = schedule.persistent?.boolValue ?? false
+            self.activityGuid = activity.guid
+            self.activityType = activity.activityType
+            self.label = activity.label
+            self.labelDetail = activity.labelDetail
+            self.taskIdentifier = activity.task?.identifier
+            self.surveyIdentifier = activity.survey?.identifier
+            self.surveyGuid = activity.survey?.guid
+            self.surveyCreatedOn = activity.survey?.createdOn
+            self.surveyHref = activity.survey?.href
+        }
+        
+        func scheduledActivity() -> SBBScheduledActivity {
+            let schedule = SBBScheduledActivity()
+            schedule.guid = guid
+            schedule.scheduledOn = scheduledOn
+            schedule.expiresOn = expiresOn
+            schedule.startedOn = startedOn
+            schedule.finishedOn = finishedOn
+            schedule.persistentValue = persistent
+            
+            let activity = SBBActivity()
+            activity.guid = activityGuid
+            activity.activityType = activityType
+            activity.label = label
+            activity.labelDetail = labelDetail
+            if let taskIdentifier = taskIdentifier {
+                let task = SBBTaskReference()
+                task.identifier = taskIdentifier
+                activity.task = task
+            }
+            if surveyIdentifier != nil || surveyGuid != nil {
+                let survey = SBBSurveyReference()
+                survey.identifier = surveyIdentifier
+                survey.guid = surveyGuid
+                survey.createdOn = surveyCreatedOn
+                survey.href = surveyHref
+                activity.survey = survey
+            }
+            schedule.activity = activity
+            return schedule
+        }
+    }
+}
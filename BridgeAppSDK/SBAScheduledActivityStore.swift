@@ -0,0 +1,224 @@
+//
+//  SBAScheduledActivityStore.swift
+//  BridgeAppSDK
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+import BridgeSDK
+
+/**
+ `SBAScheduledActivityStore` is an indexed collection of scheduled activities. The activities are
+ indexed by `guid`, by schedule identifier (the `activity.guid`), by `activityIdentifier` and by
+ the day on which each activity is scheduled, expires and is finished so that lookups do not need
+ to walk the full list of activities.
+ 
+ The store is a value type. Changes to a schedule that is already in the store should be applied
+ using `update(_:)` so that the day indexes are kept in sync with the schedule.
+ */
+public struct SBAScheduledActivityStore {
+    
+    /**
+     The activities included in this store, in the order in which they were added.
+     */
+    public fileprivate(set) var activities: [SBBScheduledActivity]
+    
+    fileprivate var guidIndex: [String : Int] = [:]
+    fileprivate var scheduleIdentifierIndex: [String : Int] = [:]
+    fileprivate var activityIdentifierIndex: [String : [Int]] = [:]
+    fileprivate var scheduledOnIndex: [Date : [Int]] = [:]
+    fileprivate var expiresOnIndex: [Date : [Int]] = [:]
+    fileprivate var finishedOnIndex: [Date : [Int]] = [:]
+    
+    // The day keys used to index each activity. These are stored so that the
+    // indexes can be updated when the dates on a schedule are changed.
+    fileprivate var dayKeys: [DayKeys] = []
+    
+    fileprivate struct DayKeys {
+        let scheduledOn: Date?
+        let expiresOn: Date?
+        let finishedOn: Date?
+        
+        init(_ schedule: SBBScheduledActivity) {
+            // Bridging from Obj-C does not guarantee that the dates are non-nil
+            let scheduledOn: Date? = schedule.scheduledOn
+            self.scheduledOn = scheduledOn?.startOfDay()
+            self.expiresOn = schedule.expiresOn?.startOfDay()
+            self.finishedOn = schedule.finishedOn?.startOfDay()
+        }
+    }
+    
+    public init(activities: [SBBScheduledActivity] = []) {
+        self.activities = activities
+        self.dayKeys.reserveCapacity(activities.count)
+        for (index, schedule) in activities.enumerated() {
+            addIndexes(for: schedule, at: index)
+        }
+    }
+    
+    /**
+     Number of activities in the store.
+     */
+    public var count: Int {
+        return activities.count
+    }
+    
+    /**
+     Index of the activity in `activities` with the given `guid`.
+     */
+    public func index(ofGuid guid: String) -> Int? {
+        return guidIndex[guid]
+    }
+    
+    /**
+     The activity with the given `guid`.
+     */
+    public func activity(withGuid guid: String) -> SBBScheduledActivity? {
+        guard let index = guidIndex[guid] else { return nil }
+        return activities[index]
+    }
+    
+    /**
+     The first activity with the given schedule identifier (`activity.guid`).
+     */
+    public func activity(withScheduleIdentifier scheduleIdentifier: String) -> SBBScheduledActivity? {
+        guard let index = scheduleIdentifierIndex[scheduleIdentifier] else { return nil }
+        return activities[index]
+    }
+    
+    /**
+     All the activities with the given activity identifier (task or survey identifier).
+     */
+    public func activities(withActivityIdentifier activityIdentifier: String) -> [SBBScheduledActivity] {
+        return activities(at: activityIdentifierIndex[activityIdentifier])
+    }
+    
+    /**
+     The first activity with the given activity identifier (task or survey identifier).
+     */
+    public func firstActivity(withActivityIdentifier activityIdentifier: String) -> SBBScheduledActivity? {
+        guard let index = activityIdentifierIndex[activityIdentifier]?.first else { return nil }
+        return activities[index]
+    }
+    
+    /**
+     The activities that are scheduled on the same day as the given date.
+     */
+    public func activities(scheduledOn date: Date) -> [SBBScheduledActivity] {
+        return activities(at: scheduledOnIndex[date.startOfDay()])
+    }
+    
+    /**
+     The activities that expire on the same day as the given date.
+     */
+    public func activities(expiringOn date: Date) -> [SBBScheduledActivity] {
+        return activities(at: expiresOnIndex[date.startOfDay()])
+    }
+    
+    /**
+     The activities that were finished on the same day as the given date.
+     */
+    public func activities(finishedOn date: Date) -> [SBBScheduledActivity] {
+        return activities(at: finishedOnIndex[date.startOfDay()])
+    }
+    
+    /**
+     Update the indexes for a schedule that is already in the store. This should be called
+     when the dates on a schedule are changed.
+     
+     @param     schedule    The schedule that was changed.
+     @return                The index of the schedule or `nil` if not found.
+     */
+    @discardableResult
+    public mutating func update(_ schedule: SBBScheduledActivity) -> Int? {
+        guard let index = guidIndex[schedule.guid] else { return nil }
+        
+        let oldKeys = dayKeys[index]
+        let newKeys = DayKeys(schedule)
+        activities[index] = schedule
+        dayKeys[index] = newKeys
+        
+        if oldKeys.scheduledOn != newKeys.scheduledOn {
+            SBAScheduledActivityStore.move(index, from: oldKeys.scheduledOn, to: newKeys.scheduledOn, in: &scheduledOnIndex)
+        }
+        if oldKeys.expiresOn != newKeys.expiresOn {
+            SBAScheduledActivityStore.move(index, from: oldKeys.expiresOn, to: newKeys.expiresOn, in: &expiresOnIndex)
+        }
+        if oldKeys.finishedOn != newKeys.finishedOn {
+            SBAScheduledActivityStore.move(index, from: oldKeys.finishedOn, to: newKeys.finishedOn, in: &finishedOnIndex)
+        }
+        
+        return index
+    }
+    
+    // MARK: Private
+    
+    fileprivate func activities(at indexes: [Int]?) -> [SBBScheduledActivity] {
+        guard let indexes = indexes else { return [] }
+        return indexes.map({ activities[$0] })
+    }
+    
+    fileprivate mutating func addIndexes(for schedule: SBBScheduledActivity, at index: Int) {
+        let keys = DayKeys(schedule)
+        dayKeys.append(keys)
+        
+        if let guid: String = schedule.guid, guidIndex[guid] == nil {
+            guidIndex[guid] = index
+        }
+        if let scheduleIdentifier = schedule.activity?.guid, scheduleIdentifierIndex[scheduleIdentifier] == nil {
+            scheduleIdentifierIndex[scheduleIdentifier] = index
+        }
+        if let activityIdentifier = schedule.activityIdentifier {
+            activityIdentifierIndex[activityIdentifier, default: []].append(index)
+        }
+        if let day = keys.scheduledOn {
+            scheduledOnIndex[day, default: []].append(index)
+        }
+        if let day = keys.expiresOn {
+            expiresOnIndex[day, default: []].append(index)
+        }
+        if let day = keys.finishedOn {
+            finishedOnIndex[day, default: []].append(index)
+        }
+    }
+    
+    fileprivate static func move(_ index: Int, from oldDay: Date?, to newDay: Date?, in dayIndex: inout [Date : [Int]]) {
+        if let day = oldDay, var indexes = dayIndex[day], let idx = indexes.firstIndex(of: index) {
+            indexes.remove(at: idx)
+            dayIndex[day] = indexes.count > 0 ? indexes : nil
+        }
+        if let day = newDay {
+            var indexes = dayIndex[day] ?? []
+            let insertAt = indexes.firstIndex(where: { $0 > index }) ?? indexes.count
+            indexes.insert(index, at: insertAt)
+            dayIndex[day] = indexes
+        }
+    }
+}
@@ -141,8 +141,7 @@ open class SBASignUpViewController : UIViewController, SBASharedInfoController,
         
         // Set up the number of steps
         let numSteps = self.onboardingManager.numberOfSteps(for: row)
-        let formatter = NumberFormatter()
-        formatter.numberStyle = .none
+        let formatter = SBAFormatterCache.shared.numberFormatter(style: .none)
         if (signupState != .completed), numSteps > 0, let numStepsString = formatter.string(for: numSteps) {
             let format = Localization.localizedString("SBA_SHORT_NUMBER_OF_STEPS_%@")
             cell.numberOfStepsLabel?.text = String.localizedStringWithFormat(format, numStepsString)
@@ -92,8 +92,7 @@ open class SBAStepProgressView: UIView {
     open func stringForLabel() -> String? {
 
         if currentStep > 0 && totalSteps > 0 {
-            let formatter = NumberFormatter()
-            formatter.numberStyle = .none
+            let formatter = SBAFormatterCache.shared.numberFormatter(style: .none)
             let currentString = formatter.string(for: currentStep)
             let totalString = formatter.string(for: totalSteps)
             let format = Localization.localizedString("SBA_CURRENT_STEP_%@_OF_TOTAL_STEPS_%@")
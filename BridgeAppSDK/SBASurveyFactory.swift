@@ -73,6 +73,53 @@ open class SBASurveyFactory : SBABaseSurveyFactory {
             Set((UIApplication.shared.delegate as? SBAAppDelegate)?.currentUser.dataGroups ?? [])
     }()
     
+    /**
+     The cache used to reuse the tasks built by this factory. Set to `nil` to always build a new task.
+     Default = `SBATaskTemplateCache.shared`
+     */
+    open var taskTemplateCache: SBATaskTemplateCache? = SBATaskTemplateCache.shared
+    
+    /**
+     The part of the template cache key that describes this factory. By default, this is the factory
+     class and the current data groups. Override if a subclass builds different tasks for the same
+     survey or task reference in some other case.
+     */
+    open var taskTemplateKey: String {
+        return "\(type(of: self))|\(currentDataGroups.sorted().joined(separator: ","))"
+    }
+    
+    /**
+     Return a copy of the cached task for this survey, or create the task using `createTaskWithSurvey()`.
+     @param survey      An `SBBSurvey` bridge model object
+     @return            Task created with this survey
+     */
+    open func cachedTaskWithSurvey(_ survey: SBBSurvey) -> SBANavigableOrderedTask {
+        guard let cache = taskTemplateCache, let guid = survey.guid, let createdOn = survey.createdOn else {
+            return createTaskWithSurvey(survey)
+        }
+        let key = "survey|\(guid)|\(createdOn.timeIntervalSince1970)|\(taskTemplateKey)"
+        let task = cache.task(forKey: key) { self.createTaskWithSurvey(survey) }
+        return task as? SBANavigableOrderedTask ?? createTaskWithSurvey(survey)
+    }
+    
+    /**
+     Return a copy of the cached task for this task reference, or transform the task reference into a
+     task. Survey references are not cached since the survey is loaded by the task.
+     @param taskRef     The task reference
+     @param isLastStep  Whether or not this is the last step in the task
+     @return            Task created with this task reference
+     */
+    open func cachedTask(for taskRef: SBATaskReference, isLastStep: Bool) -> ORKTask? {
+        guard let cache = taskTemplateCache,
+            !(taskRef is SBBSurveyReference),
+            let taskIdentifier = (taskRef as? SBABridgeTask)?.taskIdentifier
+            else {
+                return taskRef.transformToTask(with: self, isLastStep: isLastStep)
+        }
+        let key = "task|\(taskIdentifier)|\(isLastStep)|\(taskTemplateKey)"
+        return cache.task(forKey: key) { taskRef.transformToTask(with: self, isLastStep: isLastStep) }
+    }
+    
     /**
      Factory method for creating an ORKTask from an SBBSurvey
      @param survey      An `SBBSurvey` bridge model object
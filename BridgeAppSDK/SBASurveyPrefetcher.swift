@@ -0,0 +1,232 @@
+//
+//  SBASurveyPrefetcher.swift
+//  BridgeAppSDK
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+import Foundation
+import BridgeSDK
+
+/**
+ Loads a survey from the server. This protocol allows the prefetcher to be tested without calling
+ the Bridge services.
+ */
+public protocol SBASurveyLoader: class {
+    
+    /**
+     Load the survey for the given reference.
+     @param surveyReference     The survey to load.
+     @param completion          Called with the survey or an error. This may be called on any queue.
+     */
+    func loadSurvey(_ surveyReference: SBBSurveyReference, completion: @escaping (SBBSurvey?, Error?) -> Void)
+}
+
+/**
+ The default survey loader. This loads the survey using `SBABridgeManager`.
+ */
+public final class SBABridgeSurveyLoader: SBASurveyLoader {
+    
+    public init() {
+    }
+    
+    public func loadSurvey(_ surveyReference: SBBSurveyReference, completion: @escaping (SBBSurvey?, Error?) -> Void) {
+        SBABridgeManager.loadSurvey(surveyReference) { (object, error) in
+            completion(object as? SBBSurvey, error)
+        }
+    }
+}
+
+/**
+ `SBASurveyPrefetcher` downloads the surveys that are referenced by the scheduled activities so that
+ they can be accessed offline.
+ 
+ - Requests are deduplicated by survey guid and `createdOn` date, including requests that are
+   already in flight.
+ - At most `maxConcurrentRequests` prefetch requests are in flight at a time.
+ - Surveys that are already in the `store` are not downloaded again.
+ */
+open class SBASurveyPrefetcher {
+    
+    public static let shared = SBASurveyPrefetcher()
+    
+    public let store: SBASurveyStore
+    public let loader: SBASurveyLoader
+    
+    /**
+     The maximum number of prefetch requests that are in flight at a time. Surveys that are loaded
+     with `loadSurvey(_:completion:)` are requested immediately. Default = `2`.
+     */
+    public var maxConcurrentRequests: Int {
+        get { return queue.sync { _maxConcurrentRequests } }
+        set { queue.sync { _maxConcurrentRequests = max(newValue, 1) } }
+    }
+    
+    /**
+     A token that can be used to cancel the callback for a survey that is being loaded.
+     */
+    public final class Request {
+        fileprivate weak var prefetcher: SBASurveyPrefetcher?
+        fileprivate let key: SBASurveyKey
+        fileprivate let id = UUID()
+        
+        fileprivate init(prefetcher: SBASurveyPrefetcher, key: SBASurveyKey) {
+            self.prefetcher = prefetcher
+            self.key = key
+        }
+        
+        /**
+         Cancel the completion handler. The survey is still downloaded and stored so that it is
+         available the next time it is requested.
+         */
+        public func cancel() {
+            prefetcher?.removeCompletion(self)
+        }
+    }
+    
+    fileprivate typealias Completion = (SBBSurvey?, Error?) -> Void
+    
+    private let queue = DispatchQueue(label: "org.sagebase.BridgeAppSDK.SBASurveyPrefetcher")
+    private var _maxConcurrentRequests = 2
+    private var inFlight: [SBASurveyKey : [(UUID, Completion)]] = [:]
+    private var pending: [(SBASurveyKey, SBBSurveyReference)] = []
+    private var pendingKeys = Set<SBASurveyKey>()
+    private var prefetchCount = 0
+    
+    public init(store: SBASurveyStore = SBASurveyStore(), loader: SBASurveyLoader = SBABridgeSurveyLoader()) {
+        self.store = store
+        self.loader = loader
+    }
+    
+    /**
+     Download the given surveys if they are not already stored or being downloaded.
+     @param surveyReferences    The surveys to download.
+     @param removeUnreferenced  Whether or not to remove the stored surveys that are not in this list.
+     */
+    open func prefetch(_ surveyReferences: [SBBSurveyReference], removeUnreferenced: Bool = false) {
+        var references: [SBASurveyKey : SBBSurveyReference] = [:]
+        for surveyReference in surveyReferences {
+            guard let key = SBASurveyKey(surveyReference: surveyReference), references[key] == nil else { continue }
+            references[key] = surveyReference
+        }
+        
+        queue.async {
+            if removeUnreferenced {
+                let keep = Set(references.keys).union(self.inFlight.keys)
+                self.store.removeSurveys(notIn: keep)
+            }
+            for (key, surveyReference) in references {
+                guard self.inFlight[key] == nil, !self.pendingKeys.contains(key), !self.store.contains(key) else { continue }
+                self.pending.append((key, surveyReference))
+                self.pendingKeys.insert(key)
+            }
+            self.startPending()
+        }
+    }
+    
+    /**
+     Load a survey. If the survey is stored, then the stored survey is used. Otherwise, the survey is
+     downloaded, or joins the request that is already in flight.
+     @param surveyReference     The survey to load.
+     @param completion          Called on the main queue with the survey or an error.
+     @return                    A token that can be used to cancel the completion handler.
+     */
+    @discardableResult
+    open func loadSurvey(_ surveyReference: SBBSurveyReference, completion: @escaping (SBBSurvey?, Error?) -> Void) -> Request? {
+        guard let key = SBASurveyKey(surveyReference: surveyReference) else {
+            loader.loadSurvey(surveyReference) { (survey, error) in
+                DispatchQueue.main.async {
+                    completion(survey, error)
+                }
+            }
+            return nil
+        }
+        
+        let request = Request(prefetcher: self, key: key)
+        queue.async {
+            if let survey = self.store.survey(for: key) {
+                DispatchQueue.main.async {
+                    completion(survey, nil)
+                }
+                return
+            }
+            
+            let isInFlight = (self.inFlight[key] != nil)
+            self.inFlight[key, default: []].append((request.id, completion))
+            guard !isInFlight else { return }
+            
+            // If this survey was waiting to be prefetched then request it now instead
+            if self.pendingKeys.remove(key) != nil {
+                self.pending.removeAll(where: { $0.0 == key })
+            }
+            self.load(surveyReference, key: key, isPrefetch: false)
+        }
+        return request
+    }
+    
+    /** Called on the queue. */
+    private func startPending() {
+        while prefetchCount < _maxConcurrentRequests, pending.count > 0 {
+            let (key, surveyReference) = pending.removeFirst()
+            pendingKeys.remove(key)
+            inFlight[key] = []
+            prefetchCount += 1
+            load(surveyReference, key: key, isPrefetch: true)
+        }
+    }
+    
+    /** Called on the queue. */
+    private func load(_ surveyReference: SBBSurveyReference, key: SBASurveyKey, isPrefetch: Bool) {
+        loader.loadSurvey(surveyReference) { [weak self] (survey, error) in
+            guard let strongSelf = self else { return }
+            strongSelf.queue.async {
+                if let survey = survey, survey.elements.count > 0 {
+                    strongSelf.store.store(survey)
+                }
+                let completions = strongSelf.inFlight.removeValue(forKey: key) ?? []
+                if isPrefetch {
+                    strongSelf.prefetchCount -= 1
+                }
+                strongSelf.startPending()
+                if completions.count > 0 {
+                    DispatchQueue.main.async {
+                        completions.forEach { $0.1(survey, error) }
+                    }
+                }
+            }
+        }
+    }
+    
+    fileprivate func removeCompletion(_ request: Request) {
+        queue.async {
+            self.inFlight[request.key]?.removeAll(where: { $0.0 == request.id })
+        }
+    }
+}
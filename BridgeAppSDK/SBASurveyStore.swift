@@ -0,0 +1,187 @@
+//
+//  SBASurveyStore.swift
+//  BridgeAppSDK
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+import Foundation
+import BridgeSDK
+
+/**
+ The key used to identify a version of a survey.
+ */
+public struct SBASurveyKey: Hashable {
+    
+    public let guid: String
+    
+    /**
+     The version of the survey. If `nil`, this is a reference to the most recently published version.
+     */
+    public let createdOn: Date?
+    
+    public init(guid: String, createdOn: Date?) {
+        self.guid = guid
+        self.createdOn = createdOn
+    }
+    
+    public init?(surveyReference: SBBSurveyReference) {
+        guard let guid = surveyReference.guid else { return nil }
+        self.init(guid: guid, createdOn: surveyReference.createdOn)
+    }
+    
+    public init?(survey: SBBSurvey) {
+        guard let guid = survey.guid else { return nil }
+        self.init(guid: guid, createdOn: survey.createdOn)
+    }
+    
+    var filename: String? {
+        guard let createdOn = createdOn else { return nil }
+        return "\(guid)_\(Int64(createdOn.timeIntervalSince1970 * 1000)).plist"
+    }
+}
+
+/**
+ `SBASurveyStore` is an on-disk store of the surveys that have been downloaded. Each survey is
+ keyed by its guid and `createdOn` date and is stored as a binary property list, or as JSON if it
+ includes values that cannot be stored in a property list. A survey that is read from the store
+ does not need to be downloaded.
+ 
+ Only versioned surveys (those with a `createdOn` date) are stored. The methods of this class are
+ thread safe.
+ */
+public final class SBASurveyStore {
+    
+    /**
+     The default directory for the store.
+     */
+    public static var defaultURL: URL {
+        let cachesURL = FileManager.default.urls(for: .cachesDirectory, in: .userDomainMask).first!
+        return cachesURL.appendingPathComponent("SBASurveyStore", isDirectory: true)
+    }
+    
+    public let directoryURL: URL
+    
+    private let lockQueue = DispatchQueue(label: "org.sagebase.BridgeAppSDK.SBASurveyStore")
+    private var _filenames: Set<String>?
+    
+    public init(directoryURL: URL = SBASurveyStore.defaultURL) {
+        self.directoryURL = directoryURL
+    }
+    
+    /**
+     Whether or not the store has the survey for this key.
+     */
+    public func contains(_ key: SBASurveyKey) -> Bool {
+        guard let filename = key.filename else { return false }
+        return lockQueue.sync { filenames().contains(filename) }
+    }
+    
+    /**
+     The stored survey for this key, or `nil` if it is not in the store.
+     */
+    public func survey(for key: SBASurveyKey) -> SBBSurvey? {
+        guard let filename = key.filename else { return nil }
+        return lockQueue.sync {
+            guard filenames().contains(filename),
+                let data = try? Data(contentsOf: directoryURL.appendingPathComponent(filename), options: .mappedIfSafe),
+                let dictionary = ((try? PropertyListSerialization.propertyList(from: data, options: [], format: nil)) ??
+                    (try? JSONSerialization.jsonObject(with: data, options: []))) as? [AnyHashable : Any]
+                else {
+                    return nil
+            }
+            return SBBSurvey(dictionaryRepresentation: dictionary)
+        }
+    }
+    
+    /**
+     Add a survey to the store. The survey is stored as a binary property list or, if the survey
+     includes values that cannot be stored in a property list (such as `NSNull`), as JSON.
+     */
+    public func store(_ survey: SBBSurvey) {
+        guard let filename = SBASurveyKey(survey: survey)?.filename else { return }
+        let dictionary = survey.dictionaryRepresentation()
+        let data: Data
+        do {
+            data = try PropertyListSerialization.data(fromPropertyList: dictionary, format: .binary, options: 0)
+        } catch let plistError {
+            do {
+                data = try JSONSerialization.data(withJSONObject: dictionary, options: [])
+            } catch let err {
+                debugPrint("Failed to serialize survey: \(plistError), \(err)")
+                return
+            }
+        }
+        lockQueue.sync {
+            do {
+                try FileManager.default.createDirectory(at: directoryURL, withIntermediateDirectories: true, attributes: nil)
+                try data.write(to: directoryURL.appendingPathComponent(filename), options: .atomic)
+                _filenames?.insert(filename)
+            } catch let err {
+                debugPrint("Failed to store survey: \(err)")
+            }
+        }
+    }
+    
+    /**
+     Remove the stored surveys that are not in the given set of keys. This is used to drop the
+     surveys that are no longer scheduled.
+     */
+    public func removeSurveys(notIn keys: Set<SBASurveyKey>) {
+        let keep = Set(keys.compactMap { $0.filename })
+        lockQueue.sync {
+            for filename in filenames().subtracting(keep) {
+                try? FileManager.default.removeItem(at: directoryURL.appendingPathComponent(filename))
+                _filenames?.remove(filename)
+            }
+        }
+    }
+    
+    /**
+     Remove all the stored surveys.
+     */
+    public func removeAll() {
+        lockQueue.sync {
+            try? FileManager.default.removeItem(at: directoryURL)
+            _filenames = []
+        }
+    }
+    
+    /** Called on the lock queue. The directory is only listed once. */
+    private func filenames() -> Set<String> {
+        if let filenames = _filenames {
+            return filenames
+        }
+        let contents = (try? FileManager.default.contentsOfDirectory(atPath: directoryURL.path)) ?? []
+        let filenames = Set(contents.filter { $0.hasSuffix(".plist") })
+        _filenames = filenames
+        return filenames
+    }
+}
@@ -43,6 +43,12 @@ open class SBASurveyTask: NSObject, ORKTask, NSCopying, NSSecureCoding, SBACondi
     open var title: String?
     open var schemaRevision: NSNumber?
     
+    /**
+     The prefetcher used to load the survey when the task is run. This is set by the
+     `SBAScheduledActivityManager` that created the task. Default = `SBASurveyPrefetcher.shared`.
+     */
+    open var surveyPrefetcher: SBASurveyPrefetcher = SBASurveyPrefetcher.shared
+    
     public private(set) var survey: ORKOrderedTask?
     
     public var error: Error? {
@@ -59,7 +65,7 @@ open class SBASurveyTask: NSObject, ORKTask, NSCopying, NSSecureCoding, SBACondi
     open func load(survey: SBBSurvey?, error: Error?) {
         // If there was an error or the survey is nil
         if let bridgeSurvey = survey, bridgeSurvey.elements.count > 0  {
-            self.survey = self.factory.createTaskWithSurvey(bridgeSurvey)
+            self.survey = self.factory.cachedTaskWithSurvey(bridgeSurvey)
             self.schemaRevision = bridgeSurvey.schemaRevision
             if surveyReference.createdOn == nil {
                 surveyReference.createdOn = bridgeSurvey.createdOn
@@ -140,6 +146,7 @@ open class SBASurveyTask: NSObject, ORKTask, NSCopying, NSSecureCoding, SBACondi
         copy.survey = self.survey
         copy.title = self.title
         copy.schemaRevision = self.schemaRevision
+        copy.surveyPrefetcher = self.surveyPrefetcher
         return copy
     }
     
@@ -212,7 +219,7 @@ class SBASurveyLoadingStep: ORKWaitStep {
 
 class SBASurveyLoadingStepViewController: ORKWaitStepViewController {
     
-    var urlSessionTask: URLSessionTask?
+    var surveyRequest: SBASurveyPrefetcher.Request?
     
     override func viewWillAppear(_ animated: Bool) {
         super.viewWillAppear(animated)
@@ -221,7 +228,7 @@ class SBASurveyLoadingStepViewController: ORKWaitStepViewController {
     
     override func viewWillDisappear(_ animated: Bool) {
         super.viewWillDisappear(animated)
-        self.urlSessionTask?.cancel()
+        self.surveyRequest?.cancel()
     }
     
     var surveyTask: SBASurveyTask? {
@@ -234,16 +241,16 @@ class SBASurveyLoadingStepViewController: ORKWaitStepViewController {
     }
     
     func loadSurvey() {
-        self.urlSessionTask = SBABridgeManager.loadSurvey(surveyTask!.surveyReference, completion: { [weak self] (object, error) in
-            let survey = object as? SBBSurvey
+        // Use the stored survey if it was prefetched, otherwise download it
+        self.surveyRequest = surveyTask!.surveyPrefetcher.loadSurvey(surveyTask!.surveyReference, completion: { [weak self] (survey, error) in
             self?.handleSurveyLoaded(survey: survey, error: error)
         })
     }
     
     func handleSurveyLoaded(survey: SBBSurvey?, error: Error?) {
 
-        // Nil out the pointer to the url session
-        self.urlSessionTask = nil
+        // Nil out the pointer to the request
+        self.surveyRequest = nil
         let surveyTask = self.surveyTask!
         let bridgeSurvey = survey
         let bridgeError = error
@@ -0,0 +1,124 @@
+//
+//  SBATaskSchemaRegistry.swift
+//  BridgeAppSDK
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+import Foundation
+
+/**
+ `SBATaskSchemaRegistry` is an immutable lookup table for the task and schema references defined by
+ an `SBABridgeInfo`. It is built once from the `taskMap` and `schemaMap` and then maps identifiers
+ to references using hash lookups rather than by searching the mapping arrays.
+ 
+ The registry for a given bridge info is cached. If the task or schema mapping of a bridge info
+ changes after the registry has been built, call `invalidate(for:)` to rebuild it.
+ */
+public final class SBATaskSchemaRegistry: NSObject {
+    
+    /**
+     The task references keyed by task identifier.
+     */
+    public let taskReferences: [String : SBATaskReference]
+    
+    /**
+     The schema references keyed by schema identifier.
+     */
+    public let schemaReferences: [String : SBASchemaReference]
+    
+    public init(taskMap: [NSDictionary]?, schemaMap: [NSDictionary]?) {
+        // If an identifier is mapped more than once, then the first mapping is used.
+        var taskReferences: [String : SBATaskReference] = [:]
+        for taskRef in taskMap ?? [] {
+            guard let identifier = taskRef.taskIdentifier, taskReferences[identifier] == nil else { continue }
+            taskReferences[identifier] = taskRef
+        }
+        var schemaReferences: [String : SBASchemaReference] = [:]
+        for schemaRef in schemaMap ?? [] {
+            guard let identifier = schemaRef.schemaIdentifier, schemaReferences[identifier] == nil else { continue }
+            schemaReferences[identifier] = schemaRef
+        }
+        self.taskReferences = taskReferences
+        self.schemaReferences = schemaReferences
+        super.init()
+    }
+    
+    public convenience init(bridgeInfo: SBABridgeInfo) {
+        self.init(taskMap: bridgeInfo.taskMap, schemaMap: bridgeInfo.schemaMap)
+    }
+    
+    public func taskReference(with taskIdentifier: String) -> SBATaskReference? {
+        return taskReferences[taskIdentifier]
+    }
+    
+    public func schemaReference(with schemaIdentifier: String) -> SBASchemaReference? {
+        return schemaReferences[schemaIdentifier]
+    }
+    
+    // MARK: Cache
+    
+    private static let lockQueue = DispatchQueue(label: "org.sagebase.BridgeAppSDK.SBATaskSchemaRegistry")
+    private static let registries = NSMapTable<AnyObject, SBATaskSchemaRegistry>(keyOptions: [.weakMemory, .objectPointerPersonality], valueOptions: .strongMemory)
+    
+    /**
+     The registry for the given bridge info. The registry is built the first time this is called
+     for a bridge info and then reused. This is safe to call from any thread.
+     */
+    @objc(registryForBridgeInfo:)
+    public static func registry(for bridgeInfo: SBABridgeInfo) -> SBATaskSchemaRegistry {
+        return lockQueue.sync {
+            if let registry = registries.object(forKey: bridgeInfo) {
+                return registry
+            }
+            let registry = SBATaskSchemaRegistry(bridgeInfo: bridgeInfo)
+            registries.setObject(registry, forKey: bridgeInfo)
+            return registry
+        }
+    }
+    
+    /**
+     Remove the cached registry for the given bridge info, or for all bridge infos if `nil`.
+     The registry is rebuilt the next time that it is used. Since the tasks built from the old
+     task references may be out of date, this also empties `SBATaskTemplateCache.shared`.
+     */
+    @objc(invalidateRegistryForBridgeInfo:)
+    public static func invalidate(for bridgeInfo: SBABridgeInfo? = nil) {
+        SBATaskTemplateCache.shared.removeAll()
+        lockQueue.sync {
+            if let bridgeInfo = bridgeInfo {
+                registries.removeObject(forKey: bridgeInfo)
+            }
+            else {
+                registries.removeAllObjects()
+            }
+        }
+    }
+}
@@ -0,0 +1,98 @@
+//
+//  SBATaskTemplateCache.swift
+//  BridgeAppSDK
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+import UIKit
+import ResearchKit
+import ResearchUXFactory
+
+/**
+ `SBATaskTemplateCache` is an in-memory cache of the tasks built by an `SBASurveyFactory`. Building a
+ task from a survey or a task reference creates each step, which is slow for large surveys. Instead,
+ the first task that is built for a key is kept as a template and later requests return a copy.
+ 
+ The key includes the survey version (or task identifier), the factory class and the current data
+ groups, so changing the data groups does not return a stale task. Call `removeAll()` if the
+ resources used to build the tasks change. The shared cache is emptied when the task and schema
+ registry is invalidated and when the stored user data is reset. The cache is also emptied on a
+ memory warning.
+ */
+public final class SBATaskTemplateCache {
+    
+    public static let shared = SBATaskTemplateCache()
+    
+    private let cache = NSCache<NSString, AnyObject>()
+    private var memoryWarningObserver: NSObjectProtocol?
+    
+    public init(countLimit: Int = 20) {
+        cache.countLimit = countLimit
+        memoryWarningObserver = NotificationCenter.default.addObserver(forName: UIApplication.didReceiveMemoryWarningNotification, object: nil, queue: nil) { [weak self] _ in
+            self?.removeAll()
+        }
+    }
+    
+    deinit {
+        if let observer = memoryWarningObserver {
+            NotificationCenter.default.removeObserver(observer)
+        }
+    }
+    
+    /**
+     Return a copy of the cached task for this key, or build the task and cache a copy of it.
+     Tasks that cannot be copied or that have a conditional rule (which may hold state while the task
+     is running) are not cached.
+     
+     @param key     The key for the task.
+     @param build   Builds the task if it is not cached.
+     @return        The task.
+     */
+    public func task(forKey key: String, build: () -> ORKTask?) -> ORKTask? {
+        if let template = cache.object(forKey: key as NSString) as? NSCopying,
+            let task = template.copy(with: nil) as? ORKTask {
+            return task
+        }
+        
+        guard let task = build() else { return nil }
+        if let copyable = task as? NSCopying, (task as? SBANavigableOrderedTask)?.conditionalRule == nil {
+            cache.setObject(copyable.copy(with: nil) as AnyObject, forKey: key as NSString)
+        }
+        return task
+    }
+    
+    /**
+     Remove all the cached tasks.
+     */
+    public func removeAll() {
+        cache.removeAllObjects()
+    }
+}
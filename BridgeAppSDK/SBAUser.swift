@@ -69,11 +69,22 @@ public final class SBAUser: NSObject, SBAUserWrapper, SBANameDataSource {
     }
 
     public func resetStoredUserData() {
-        lockQueue.async {
+        // The clientData profile item values are cached in memory and written back after a delay.
+        // Drop them first so that a pending write cannot restore them after the keychain is reset.
+        SBAClientDataProfileItem.invalidateCurrentValues()
+        
+        _username = nil
+        // The keychain is reset before returning. Profile items write to the same keychain without
+        // going through this object, so a deferred reset could erase the values of the next user.
+        lockQueue.sync {
             self.resetUserDefaults()
             self.resetKeychain()
         }
         self.resetLocalNotifications()
+        SBATaskTemplateCache.shared.removeAll()
+        SBAScheduleUpdateQueue.shared.removeAll()
+        SBAUploadLedger.shared.removeAll()
+        SBAScheduledActivitySnapshotCache().remove()
         SBABridgeManager.resetUserSessionInfo()
     }
     
@@ -91,7 +102,12 @@ public final class SBAUser: NSObject, SBAUserWrapper, SBANameDataSource {
             try profileManager?.setValue(storedAnswer, forProfileKey: key);
         }
         catch {
-            if self.keychainPropertyKeys.contains(key) {
+            if key == kProfileImagePropertyKey {
+                // The image is kept in the blob store. The keychain only has a reference to it.
+                let imageData = (storedAnswer as? Data) ?? (storedAnswer as? UIImage)?.jpegData(compressionQuality: 1.0)
+                setProfileImageData(imageData)
+            }
+            else if self.keychainPropertyKeys.contains(key) {
                 setKeychainObject(storedAnswer as? NSSecureCoding, key: key)
             }
             else {
@@ -104,6 +120,10 @@ public final class SBAUser: NSObject, SBAUserWrapper, SBANameDataSource {
         if let storedAnswer = profileManager?.value(forProfileKey: key) {
             return storedAnswer
         }
+        else if key == kProfileImagePropertyKey {
+            guard let reference = profileImageReference else { return nil }
+            return blobStore.data(for: reference)
+        }
         else if self.keychainPropertyKeys.contains(key) {
             return getKeychainObject(key)
         }
@@ -116,10 +136,22 @@ public final class SBAUser: NSObject, SBAUserWrapper, SBANameDataSource {
     // MARK: Keychain storage
     // --------------------------------------------------
     
-    fileprivate var keychain: SBAKeychainWrapper {
-        return SBAProfileManager.keychain
+    var keychain: SBAKeychainWrapperProtocol = SBAProfileManager.keychain {
+        didSet {
+            lockQueue.async {
+                self._keychainCache.removeAll()
+            }
+        }
     }
     
+    // Keychain values are read once and then kept in memory. The cache is only accessed on the
+    // `lockQueue`. Reads and writes of the keychain itself are done in order on the `keychainQueue`
+    // so that a write does not block the getters and a read that misses the cache cannot jump ahead
+    // of a pending write. Values that are changed directly in the keychain, without going through
+    // this object, are not seen until the cache is reset.
+    let keychainQueue = DispatchQueue(label: "org.sagebase.UserKeychainQueue")
+    fileprivate var _keychainCache = [String : NSSecureCoding?]()
+    
     let kSessionTokenKey = "sessionToken"
     let kNamePropertyKey = "name"
     let kFamilyNamePropertyKey = "familyName"
@@ -131,7 +163,8 @@ public final class SBAUser: NSObject, SBAUserWrapper, SBANameDataSource {
     let kGenderKey = "gender"
     let kBirthdateKey = "birthdate"
     let kProfileImagePropertyKey = "profileImage"
-    let keychainPropertyKeys = ["externalId", "gender", "birthdate", "profileImage"]
+    let kProfileImageReferenceKey = "profileImageReference"
+    let keychainPropertyKeys = ["externalId", "gender", "birthdate"]
     
     let kDeprecatedUsernamePropertyKey = "email"
     
@@ -243,7 +276,19 @@ public final class SBAUser: NSObject, SBAUserWrapper, SBANameDataSource {
 
     public var consentSignature: SBAConsentSignatureWrapper? {
         get {
-            return getKeychainObject(kConsentSignatureKey) as? SBAConsentSignature
+            guard let signature = getKeychainObject(kConsentSignatureKey) as? SBAConsentSignature else { return nil }
+            if signature.signatureImageReference == nil, signature.signatureImage != nil {
+                // Move a signature image that was saved in the keychain by an older version to the blob store
+                do {
+                    try signature.storeSignatureImage(in: blobStore)
+                    setKeychainObject(signature, key: kConsentSignatureKey)
+                }
+                catch let error {
+                    print("Failed to move the consent signature image to the blob store: \(error)")
+                }
+            }
+            signature.blobStore = blobStore
+            return signature
         }
         set (newValue) {
             var signature = newValue as? SBAConsentSignature
@@ -253,27 +298,81 @@ public final class SBAUser: NSObject, SBAUserWrapper, SBANameDataSource {
                 signature!.signatureImage = newValue!.signatureImage
                 signature!.signatureName = newValue!.signatureName
             }
+            
+            // Keep the image in the blob store and only the reference in the keychain
+            do {
+                try signature?.storeSignatureImage(in: blobStore)
+            }
+            catch let error {
+                print("Failed to store the consent signature image: \(error)")
+            }
+            
+            let oldReference = (getKeychainObject(kConsentSignatureKey) as? SBAConsentSignature)?.signatureImageReference
             setKeychainObject(signature, key: kConsentSignatureKey)
+            if let reference = oldReference, reference != signature?.signatureImageReference {
+                blobStore.remove(reference)
+            }
         }
     }
     
     @available(*, deprecated)
     public var profileImage: UIImage? {
         get {
-            if let profileImageData = getKeychainObject(kProfileImagePropertyKey) as? Data {
-                return UIImage(data: profileImageData)
-            } else {
-                return nil
-            }
+            guard let reference = profileImageReference else { return nil }
+            return blobStore.image(for: reference)
         }
         set (newValue) {
-            if let newValueUnwrapped = newValue {
-                let dataValue = newValueUnwrapped.jpegData(compressionQuality: 1.0)
-                setKeychainObject(dataValue as NSSecureCoding?, key: kProfileImagePropertyKey)
-            } else {  // remove the item from the keychain
-                setKeychainObject(nil, key: kProfileImagePropertyKey)
+            setProfileImageData(newValue?.jpegData(compressionQuality: 1.0))
+        }
+    }
+    
+    fileprivate func setProfileImageData(_ imageData: Data?) {
+        let oldReference = profileImageReference
+        var reference: String?
+        if let dataValue = imageData {
+            do {
+                reference = try blobStore.store(dataValue)
+            }
+            catch let error {
+                print("Failed to store the profile image: \(error)")
             }
         }
+        setKeychainObject(reference as NSSecureCoding?, key: kProfileImageReferenceKey)
+        if let old = oldReference, old != reference {
+            blobStore.remove(old)
+        }
+    }
+    
+    /**
+     A thumbnail of the profile image that is no larger than `maxPixelSize` in either dimension.
+     */
+    public func profileImageThumbnail(maxPixelSize: Int) -> UIImage? {
+        guard let reference = profileImageReference else { return nil }
+        return blobStore.thumbnail(for: reference, maxPixelSize: maxPixelSize)
+    }
+    
+    /**
+     Large binary values are kept in the blob store with only a reference in the keychain.
+     */
+    var blobStore: SBABlobStore = SBABlobStore.shared
+    
+    fileprivate var profileImageReference: String? {
+        if let reference = getKeychainObject(kProfileImageReferenceKey) as? String {
+            return reference
+        }
+        
+        // Move an image that was saved in the keychain by an older version to the blob store
+        guard let profileImageData = getKeychainObject(kProfileImagePropertyKey) as? Data else { return nil }
+        do {
+            let reference = try blobStore.store(profileImageData)
+            setKeychainObject(reference as NSSecureCoding, key: kProfileImageReferenceKey)
+            setKeychainObject(nil, key: kProfileImagePropertyKey)
+            return reference
+        }
+        catch let error {
+            print("Failed to move the profile image to the blob store: \(error)")
+            return nil
+        }
     }
     
     /**
@@ -311,14 +410,36 @@ public final class SBAUser: NSObject, SBAUserWrapper, SBANameDataSource {
     }
     
     fileprivate func _getKeychainObject_NoLock(_ key: String) -> NSSecureCoding? {
+        if let cached = _keychainCache[key] {
+            return copiedKeychainObject(cached)
+        }
+        
         var err: NSError?
-        let obj: NSSecureCoding? = keychain.object(forKey: key, error: &err)
+        var obj: NSSecureCoding?
+        let keychain = self.keychain
+        keychainQueue.sync {
+            obj = keychain.object(forKey: key, error: &err)
+        }
         if let error = err {
             print("Error accessing keychain \(key): \(error.code) \(error)")
+            // Only remember a missing value. Any other error may be temporary (the device is locked).
+            if error.code == Int(errSecItemNotFound) {
+                _keychainCache[key] = .some(nil)
+            }
+        }
+        else {
+            _keychainCache[key] = .some(copiedKeychainObject(obj))
         }
         return obj
     }
     
+    // Decoding the keychain used to return a new object each time. Keep it that way so that changing
+    // a mutable value (such as a consent signature) does not change the cached value.
+    fileprivate func copiedKeychainObject(_ object: NSSecureCoding?) -> NSSecureCoding? {
+        guard let copyable = object as? NSCopying else { return object }
+        return (copyable.copy(with: nil) as? NSSecureCoding) ?? object
+    }
+    
     public func setKeychainObject(_ object: NSSecureCoding?, key: String) {
         lockQueue.async {
             self._setKeychainObject_NoLock(object, key: key)
@@ -326,26 +447,44 @@ public final class SBAUser: NSObject, SBAUserWrapper, SBANameDataSource {
     }
     
     fileprivate func _setKeychainObject_NoLock(_ object: NSSecureCoding?, key: String) {
-        do {
-            if let obj = object {
-                try keychain.setObject(obj, forKey: key)
+        _keychainCache[key] = .some(copiedKeychainObject(object))
+        
+        let keychain = self.keychain
+        keychainQueue.async {
+            do {
+                if let obj = object {
+                    try keychain.setObject(obj, forKey: key)
+                }
+                else {
+                    try keychain.removeObject(forKey: key)
+                }
             }
-            else {
-                try keychain.removeObject(forKey: key)
+            catch let error as NSError {
+                print("Failed to set \(key): \(error.code) \(error.localizedDescription)")
+                // Read the value back from the keychain the next time it is used
+                self.lockQueue.async {
+                    self._keychainCache.removeValue(forKey: key)
+                }
             }
         }
-        catch let error as NSError {
-            print("Failed to set \(key): \(error.code) \(error.localizedDescription)")
-        }
     }
     
+    /** Called on the `lockQueue`. Any pending keychain writes are done before the reset. */
     fileprivate func resetKeychain() {
-        do {
-            try keychain.resetKeychain()
-        }
-        catch let error as NSError {
-            print(error.localizedDescription)
+        _keychainCache.removeAll()
+        
+        let keychain = self.keychain
+        keychainQueue.sync {
+            do {
+                try keychain.resetKeychain()
+            }
+            catch let error as NSError {
+                print(error.localizedDescription)
+            }
         }
+        
+        // The profile and signature images are only referenced from the keychain
+        blobStore.removeAll()
     }
     
     // --------------------------------------------------
@@ -364,8 +503,11 @@ public final class SBAUser: NSObject, SBAUserWrapper, SBANameDataSource {
         }
         
         func fetchFallback() {
-            let result = self._getKeychainObject_NoLock(identifier.rawValue) as? HKQuantitySample
-            completion(result)
+            // The health store calls back on its own queue so return to the lock queue to read the keychain
+            self.lockQueue.async {
+                let result = self._getKeychainObject_NoLock(identifier.rawValue) as? HKQuantitySample
+                completion(result)
+            }
         }
         
         lockQueue.async {
@@ -392,7 +534,9 @@ public final class SBAUser: NSObject, SBAUserWrapper, SBANameDataSource {
     public func saveHealthKitQuantitySample(_ quantitySample: HKQuantitySample) {
         
         func saveFallback() {
-            _setKeychainObject_NoLock(quantitySample, key: quantitySample.quantityType.identifier)
+            self.lockQueue.async {
+                self._setKeychainObject_NoLock(quantitySample, key: quantitySample.quantityType.identifier)
+            }
         }
         
         lockQueue.async {
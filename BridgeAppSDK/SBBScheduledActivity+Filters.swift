@@ -115,3 +115,195 @@ extension SBBScheduledActivity {
         return NSPredicate(format: "(%K != nil) AND (%K IN %@)", key, key, array)
     }
 }
+
+/**
+ `SBAScheduleFilter` is a compiled filter for `SBBScheduledActivity` objects. Each filter has the
+ same semantics as the matching `NSPredicate` defined on `SBBScheduledActivity` but is evaluated as
+ a Swift closure so that there is no format string parsing or key-value coding when a schedule is
+ evaluated.
+ */
+public struct SBAScheduleFilter {
+    
+    fileprivate let matches: (SBBScheduledActivity) -> Bool
+    
+    /**
+     Create a filter with a closure that returns `true` if the schedule should be included.
+     */
+    public init(_ matches: @escaping (SBBScheduledActivity) -> Bool) {
+        self.matches = matches
+    }
+    
+    /**
+     Create a filter that evaluates the given predicate. This is provided for backwards compatibility
+     with predicates that do not have a compiled equivalent (such as a custom format string).
+     */
+    public init(predicate: NSPredicate) {
+        self.matches = { predicate.evaluate(with: $0) }
+    }
+    
+    /**
+     Evaluate the filter.
+     
+     @param     schedule    The schedule to evaluate.
+     @return                `true` if the schedule passes the filter.
+     */
+    public func evaluate(with schedule: SBBScheduledActivity) -> Bool {
+        return matches(schedule)
+    }
+    
+    /**
+     A block predicate that wraps this filter.
+     */
+    public var predicate: NSPredicate {
+        let matches = self.matches
+        return NSPredicate(block: { (obj, _) -> Bool in
+            guard let schedule = obj as? SBBScheduledActivity else { return false }
+            return matches(schedule)
+        })
+    }
+    
+    // MARK: Compound filters
+    
+    public static let all = SBAScheduleFilter({ _ in true })
+    
+    public static func and(_ filters: [SBAScheduleFilter]) -> SBAScheduleFilter {
+        let matches = filters.map({ $0.matches })
+        return SBAScheduleFilter({ (schedule) in
+            for match in matches where !match(schedule) {
+                return false
+            }
+            return true
+        })
+    }
+    
+    public static func or(_ filters: [SBAScheduleFilter]) -> SBAScheduleFilter {
+        let matches = filters.map({ $0.matches })
+        return SBAScheduleFilter({ (schedule) in
+            for match in matches where match(schedule) {
+                return true
+            }
+            return false
+        })
+    }
+    
+    public static func not(_ filter: SBAScheduleFilter) -> SBAScheduleFilter {
+        let match = filter.matches
+        return SBAScheduleFilter({ !match($0) })
+    }
+    
+    // MARK: Schedule filters
+    
+    public static let unfinished = SBAScheduleFilter({ $0.finishedOn == nil })
+    
+    public static let completed = SBAScheduleFilter({ $0.finishedOn != nil })
+    
+    public static let optional = SBAScheduleFilter({ $0.persistent?.boolValue ?? false })
+    
+    public static func finished(on date: Date) -> SBAScheduleFilter {
+        let range = dayRange(date)
+        return SBAScheduleFilter({ isDate($0.finishedOn, in: range) })
+    }
+    
+    public static func finishedToday() -> SBAScheduleFilter {
+        return finished(on: Date())
+    }
+    
+    public static func scheduled(on date: Date) -> SBAScheduleFilter {
+        let range = dayRange(date)
+        return SBAScheduleFilter({ isDate($0.scheduledOn, in: range) })
+    }
+    
+    public static func scheduledToday() -> SBAScheduleFilter {
+        return scheduled(on: Date())
+    }
+    
+    public static func scheduledTomorrow() -> SBAScheduleFilter {
+        return scheduled(on: Date().addingNumberOfDays(1))
+    }
+    
+    public static func scheduledComingUp(numberOfDays: Int) -> SBAScheduleFilter {
+        let start = Date().addingNumberOfDays(1).startOfDay()
+        let range = start..<start.addingNumberOfDays(numberOfDays)
+        return SBAScheduleFilter({ isDate($0.scheduledOn, in: range) })
+    }
+    
+    public static func expiredYesterday() -> SBAScheduleFilter {
+        let range = dayRange(Date().addingNumberOfDays(-1))
+        return SBAScheduleFilter({ isDate($0.expiresOn, in: range) })
+    }
+    
+    /**
+     Compiled equivalent of `SBBScheduledActivity.scheduledPredicate(on:)`.
+     */
+    public static func available(on date: Date) -> SBAScheduleFilter {
+        let startOfDay = date.startOfDay()
+        let startOfNextDay = startOfDay.addingNumberOfDays(1)
+        let thisDay = startOfDay..<startOfNextDay
+        
+        func scheduledThisDayOrBefore(_ schedule: SBBScheduledActivity) -> Bool {
+            guard let scheduledOn: Date = schedule.scheduledOn else { return true }
+            return scheduledOn < startOfNextDay
+        }
+        func expiredOnThisDay(_ schedule: SBBScheduledActivity) -> Bool {
+            guard let expiresOn = schedule.expiresOn else { return true }
+            return thisDay.contains(expiresOn)
+        }
+        func expiredOnOrAfterThisDay(_ schedule: SBBScheduledActivity) -> Bool {
+            guard let expiresOn = schedule.expiresOn else { return true }
+            return expiresOn > startOfDay
+        }
+        
+        switch(startOfDay.compare(Date().startOfDay())) {
+            
+        case .orderedAscending:
+            // a day in the past includes expired on that day OR completed on that day
+            return SBAScheduleFilter({ (schedule) in
+                guard scheduledThisDayOrBefore(schedule) else { return false }
+                if let finishedOn = schedule.finishedOn {
+                    return thisDay.contains(finishedOn)
+                }
+                return expiredOnThisDay(schedule)
+            })
+            
+        case .orderedSame:
+            // today includes activites completed today, expiring today or later and scheduled to include today
+            return SBAScheduleFilter({ (schedule) in
+                guard scheduledThisDayOrBefore(schedule), expiredOnOrAfterThisDay(schedule) else { return false }
+                if let finishedOn = schedule.finishedOn {
+                    return thisDay.contains(finishedOn)
+                }
+                return true
+            })
+            
+        case .orderedDescending:
+            // For the future, we only want unfinished schedules
+            return SBAScheduleFilter({ (schedule) in
+                return schedule.finishedOn == nil && scheduledThisDayOrBefore(schedule) && expiredOnOrAfterThisDay(schedule)
+            })
+        }
+    }
+    
+    public static func availableToday() -> SBAScheduleFilter {
+        return available(on: Date())
+    }
+    
+    public static func includeTasks(with identifiers: [String]) -> SBAScheduleFilter {
+        let identifierSet = Set(identifiers)
+        return SBAScheduleFilter({ (schedule) in
+            guard let activityIdentifier = schedule.activityIdentifier else { return false }
+            return identifierSet.contains(activityIdentifier)
+        })
+    }
+    
+    // MARK: Private
+    
+    fileprivate static func dayRange(_ date: Date) -> Range<Date> {
+        let startOfDay = date.startOfDay()
+        return startOfDay..<startOfDay.addingNumberOfDays(1)
+    }
+    
+    fileprivate static func isDate(_ date: Date?, in range: Range<Date>) -> Bool {
+        guard let date = date else { return false }
+        return range.contains(date)
+    }
+}
@@ -40,11 +40,11 @@ public extension SBBScheduledActivity {
     }
     
     var isToday: Bool {
-        return SBBScheduledActivity.availableTodayPredicate().evaluate(with: self)
+        return SBAScheduleFilter.availableToday().evaluate(with: self)
     }
     
     var isTomorrow: Bool {
-        return SBBScheduledActivity.scheduledTomorrowPredicate().evaluate(with: self)
+        return SBAScheduleFilter.scheduledTomorrow().evaluate(with: self)
     }
     
     var scheduledTime: String {
@@ -55,13 +55,13 @@ public extension SBBScheduledActivity {
             return Localization.localizedString("SBA_NOW")
         }
         else {
-            return DateFormatter.localizedString(from: scheduledOn, dateStyle: .none, timeStyle: .short)
+            return SBAFormatterCache.shared.dateFormatter(dateStyle: .none, timeStyle: .short).string(from: scheduledOn)
         }
     }
     
     var expiresTime: String? {
         if expiresOn == nil { return nil }
-        return DateFormatter.localizedString(from: expiresOn!, dateStyle: .none, timeStyle: .short)
+        return SBAFormatterCache.shared.dateFormatter(dateStyle: .none, timeStyle: .short).string(from: expiresOn!)
     }
     
     /**
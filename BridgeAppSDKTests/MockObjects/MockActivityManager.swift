@@ -94,11 +94,25 @@ class MockActivityManager : NSObject, SBBActivityManagerProtocol {
         return URLSessionTask()
     }
 
+
+    // MARK: updateScheduledActivities
+    
+    var updateScheduledActivities_Error: Error?
+    var updateScheduledActivities_callCount: Int = 0
+    var updateScheduledActivities_scheduledActivities: [[SBBScheduledActivity]] = []
+    
     public func updateScheduledActivities(_ scheduledActivities: [Any], withCompletion completion: SBBActivityManagerUpdateCompletionBlock? = nil) -> URLSessionTask {
+        
+        updateScheduledActivities_callCount += 1
+        updateScheduledActivities_scheduledActivities.append(scheduledActivities as? [SBBScheduledActivity] ?? [])
+        
+        taskQueue.async {
+            completion?(nil, self.updateScheduledActivities_Error)
+        }
+        
         return URLSessionTask()
     }
-
-
+    
     // MARK: getScheduledActivitiesForGuid
     
     var getScheduledActivitiesForRange_Result: [SBBScheduledActivity]?
@@ -39,5 +39,7 @@
 @property (nonatomic) NSMutableDictionary<NSString *, id> *keychain;
 @property (nonatomic) NSMutableDictionary<NSString *, NSError *> *errorMap;
 @property (nonatomic) BOOL reset_called;
+@property (nonatomic) NSInteger setObject_callCount;
+@property (nonatomic) NSInteger objectForKey_callCount;
 
 @end
@@ -45,6 +45,7 @@
 }
 
 - (BOOL)setObject:(id<NSSecureCoding>)object forKey:(NSString *)key error:(NSError * _Nullable *)error {
+    _setObject_callCount++;
     NSError *err = _errorMap[key];
     if (err) {
         *error = err;
@@ -57,6 +58,7 @@
 }
 
 - (id<NSSecureCoding>)objectForKey:(NSString *)key error:(NSError * _Nullable *)error {
+    _objectForKey_callCount++;
     NSError *err = _errorMap[key];
     if (err) {
         *error = err;
@@ -32,6 +32,8 @@
 //
 
 import XCTest
+import BridgeAppSDK
+import BridgeSDK
 
 class SBAActivityArchive: XCTestCase {
 
@@ -240,8 +242,127 @@ class SBAActivityArchive: XCTestCase {
         // support it.
     }
     
+    // MARK: Streaming
+    
+    func testStreamingArchive_PeakMemory() {
+        
+        // Build a synthetic result set with 200 results of 1 MB each
+        let resultCount = 200
+        let activityResult = createActivityResult(identifier: "Streaming", stepCount: resultCount)
+        
+        let baseline = residentFootprint()
+        guard let archive = SyntheticDataArchive(result: activityResult, streamBufferSize: BridgeAppSDK.SBAActivityArchive.defaultStreamBufferSize) else {
+            XCTAssert(false, "Failed to build archive")
+            return
+        }
+        defer {
+            archive.remove()
+        }
+        
+        XCTAssertEqual(archive.insertCount, resultCount)
+        
+        // The archived data is 200 MB. Peak footprint should stay well below that.
+        let ceiling: UInt64 = 64 * 1024 * 1024
+        XCTAssertLessThan(archive.peakFootprint - min(baseline, archive.peakFootprint), ceiling)
+        
+        do {
+            try archive.complete()
+        } catch let err {
+            XCTAssert(false, "Failed to complete archive: \(err)")
+        }
+        XCTAssertLessThan(residentFootprint() - min(baseline, residentFootprint()), ceiling)
+    }
+    
+    func testFileIngestion_Throughput() {
+        
+        // Write 16 sensor recordings of 4 MB each to a fake task output directory
+        let fileCount = 16
+        let outputDirectory = URL(fileURLWithPath: NSTemporaryDirectory()).appendingPathComponent(UUID().uuidString, isDirectory: true)
+        try? FileManager.default.createDirectory(at: outputDirectory, withIntermediateDirectories: true, attributes: nil)
+        defer {
+            try? FileManager.default.removeItem(at: outputDirectory)
+        }
+        let fileURLs = (0..<fileCount).map { (ii) -> URL in
+            let url = outputDirectory.appendingPathComponent("accel\(ii).json")
+            autoreleasepool {
+                let data = NSMutableData(length: SyntheticFileArchive.fileSize)!
+                arc4random_buf(data.mutableBytes, data.length)
+                data.write(to: url, atomically: false)
+            }
+            return url
+        }
+        
+        let totalBytes = Double(fileCount * SyntheticFileArchive.fileSize)
+        
+        // Insert the files by URL first so that there is a baseline to compare against
+        guard let urlRun = ingestFiles(fileURLs, mapped: false),
+            let mappedRun = ingestFiles(fileURLs, mapped: true)
+            else {
+                return
+        }
+        print("insertURL: archived \(Int(totalBytes)) bytes at \(Int(totalBytes / max(urlRun.duration, 0.001))) bytes/sec, peak footprint +\(urlRun.peak) bytes")
+        print("mapped: archived \(Int(totalBytes)) bytes at \(Int(totalBytes / max(mappedRun.duration, 0.001))) bytes/sec, peak footprint +\(mappedRun.peak) bytes")
+        
+        // The files are mapped rather than copied into memory, including while the archive is compressed
+        XCTAssertLessThan(mappedRun.peak, UInt64(totalBytes / 2))
+        XCTAssertLessThanOrEqual(mappedRun.peak, urlRun.peak + UInt64(SyntheticFileArchive.fileSize))
+    }
+    
+    /**
+     Build and complete an archive of the given files. The duration and the peak footprint cover
+     both inserting the files and compressing the archive.
+     */
+    func ingestFiles(_ fileURLs: [URL], mapped: Bool) -> (duration: TimeInterval, peak: UInt64)? {
+        let activityResult = createActivityResult(identifier: "Recorders", stepCount: fileURLs.count)
+        
+        let baseline = residentFootprint()
+        let sampler = FootprintSampler()
+        let startTime = ProcessInfo.processInfo.systemUptime
+        guard let archive = SyntheticFileArchive(result: activityResult, fileURLs: fileURLs, mapped: mapped) else {
+            sampler.stop()
+            XCTAssert(false, "Failed to build archive")
+            return nil
+        }
+        defer {
+            archive.remove()
+        }
+        do {
+            try archive.complete()
+        } catch let err {
+            sampler.stop()
+            XCTAssert(false, "Failed to complete archive: \(err)")
+            return nil
+        }
+        let duration = ProcessInfo.processInfo.systemUptime - startTime
+        let peakFootprint = max(sampler.stop(), archive.peakFootprint)
+        
+        XCTAssertEqual(archive.insertCount, fileURLs.count)
+        return (duration, peakFootprint - min(baseline, peakFootprint))
+    }
+    
     // MARK: Helper methods
     
+    func createActivityResult(identifier: String, stepCount: Int) -> SBAActivityResult {
+        let schedule = SBBScheduledActivity()
+        schedule.guid = UUID().uuidString
+        schedule.scheduledOn = Date()
+        schedule.activity = SBBActivity()
+        schedule.activity.guid = UUID().uuidString
+        schedule.activity.label = identifier
+        schedule.activity.task = SBBTaskReference()
+        schedule.activity.task!.identifier = identifier
+        
+        let activityResult = SBAActivityResult(taskIdentifier: identifier, taskRun: UUID(), outputDirectory: nil)
+        activityResult.schedule = schedule
+        activityResult.schemaIdentifier = identifier
+        activityResult.schemaRevision = NSNumber(value: 1)
+        activityResult.results = (0..<stepCount).map({ (ii) -> ORKStepResult in
+            let stepIdentifier = "step\(ii)"
+            return ORKStepResult(stepIdentifier: stepIdentifier, results: [ORKResult(identifier: stepIdentifier)])
+        })
+        return activityResult
+    }
+    
     func checkSharedArchiveKeys(_ result: ORKResult, stepIdentifier: String, expectedFilename: String) -> [AnyHashable: Any]? {
         
         result.startDate = date(year: 2016, month: 7, day: 4, hour: 8, minute: 29, second: 54)
@@ -307,3 +428,95 @@ class SBAActivityArchive: XCTestCase {
     }
 
 }
+
+class SyntheticDataArchive: BridgeAppSDK.SBAActivityArchive {
+    
+    static let entrySize = 1024 * 1024
+    
+    var insertCount: Int = 0
+    var peakFootprint: UInt64 = 0
+    
+    override func insert(result: SBAArchivableResult, stepIdentifier: String, activityIdentifier: String) -> Bool {
+        // Build the data lazily so that the result set itself is not held in memory
+        let data = NSMutableData(length: SyntheticDataArchive.entrySize)!
+        arc4random_buf(data.mutableBytes, data.length)
+        let success = insert(archiveObject: data, filename: "\(result.identifier).data", createdOn: result.startDate)
+        insertCount += 1
+        peakFootprint = max(peakFootprint, residentFootprint())
+        return success
+    }
+}
+
+class SyntheticFileArchive: BridgeAppSDK.SBAActivityArchive {
+    
+    static let fileSize = 4 * 1024 * 1024
+    
+    var fileURLs: [String : URL] = [:]
+    var insertCount: Int = 0
+    var peakFootprint: UInt64 = 0
+    
+    /** If `false`, the files are added with `insertURL` rather than being mapped. */
+    let mapped: Bool
+    
+    init?(result: SBAActivityResult, fileURLs: [URL], mapped: Bool = true) {
+        for (ii, url) in fileURLs.enumerated() {
+            self.fileURLs["step\(ii)"] = url
+        }
+        self.mapped = mapped
+        super.init(result: result, schedule: result.schedule, streamBufferSize: BridgeAppSDK.SBAActivityArchive.defaultStreamBufferSize)
+    }
+    
+    override func insert(result: SBAArchivableResult, stepIdentifier: String, activityIdentifier: String) -> Bool {
+        guard let url = fileURLs[stepIdentifier] else { return false }
+        var success = true
+        if mapped {
+            success = insert(archiveObject: url, filename: url.lastPathComponent, createdOn: result.startDate)
+        } else {
+            insertURL(intoArchive: url, fileName: url.lastPathComponent)
+        }
+        insertCount += 1
+        peakFootprint = max(peakFootprint, residentFootprint())
+        return success
+    }
+}
+
+/**
+ Samples the resident footprint on a background queue until stopped, so that the peak includes
+ work (such as compressing an archive) that does not call back into the test.
+ */
+class FootprintSampler {
+    
+    private let queue = DispatchQueue(label: "org.sagebase.BridgeAppSDKTests.FootprintSampler")
+    private let timer: DispatchSourceTimer
+    private var peak: UInt64 = 0
+    
+    init(interval: DispatchTimeInterval = .milliseconds(5)) {
+        timer = DispatchSource.makeTimerSource(queue: queue)
+        timer.schedule(deadline: .now(), repeating: interval)
+        timer.setEventHandler { [unowned self] in
+            self.peak = max(self.peak, residentFootprint())
+        }
+        timer.resume()
+    }
+    
+    /** Stop sampling and return the peak footprint. */
+    @discardableResult
+    func stop() -> UInt64 {
+        return queue.sync {
+            timer.cancel()
+            peak = max(peak, residentFootprint())
+            return peak
+        }
+    }
+}
+
+func residentFootprint() -> UInt64 {
+    var info = task_vm_info_data_t()
+    var count = mach_msg_type_number_t(MemoryLayout<task_vm_info_data_t>.size / MemoryLayout<natural_t>.size)
+    let kerr = withUnsafeMutablePointer(to: &info) { (infoPtr) -> kern_return_t in
+        return infoPtr.withMemoryRebound(to: integer_t.self, capacity: Int(count)) {
+            return task_info(mach_task_self_, task_flavor_t(TASK_VM_INFO), $0, &count)
+        }
+    }
+    return kerr == KERN_SUCCESS ? info.phys_footprint : 0
+}
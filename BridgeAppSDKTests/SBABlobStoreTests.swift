@@ -0,0 +1,247 @@
+//
+//  SBABlobStoreTests.swift
+//  BridgeAppSDKTests
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+import XCTest
+@testable import BridgeAppSDK
+
+class SBABlobStoreTests: XCTestCase {
+    
+    var rootURL: URL!
+    var blobStore: SBABlobStore!
+    
+    override func setUp() {
+        super.setUp()
+        rootURL = URL(fileURLWithPath: NSTemporaryDirectory()).appendingPathComponent(UUID().uuidString)
+        blobStore = SBABlobStore(rootURL: rootURL)
+    }
+    
+    override func tearDown() {
+        try? FileManager.default.removeItem(at: rootURL)
+        super.tearDown()
+    }
+    
+    func testStore_ContentAddressed() {
+        let data = "Hello, blob".data(using: .utf8)!
+        let reference = try? blobStore.store(data)
+        XCTAssertNotNil(reference)
+        XCTAssertEqual(try? blobStore.store(data), reference)
+        XCTAssertEqual(reference, SBABlobStore.reference(for: data))
+        
+        guard let ref = reference else { return }
+        XCTAssertTrue(blobStore.contains(ref))
+        XCTAssertEqual(blobStore.data(for: ref), data)
+        XCTAssertEqual(try? FileManager.default.contentsOfDirectory(atPath: rootURL.path).count, 1)
+        
+        // References are filenames so anything other than a hash is rejected
+        XCTAssertNil(blobStore.data(for: "../\(ref)"))
+        
+        blobStore.remove(ref)
+        XCTAssertFalse(blobStore.contains(ref))
+        XCTAssertNil(blobStore.data(for: ref))
+    }
+    
+    func testThumbnail_GeneratedOnce() {
+        guard let reference = try? blobStore.store(createImageData()) else {
+            XCTFail("Failed to store the image")
+            return
+        }
+        
+        let thumbnail = blobStore.thumbnail(for: reference, maxPixelSize: 120)
+        XCTAssertNotNil(thumbnail)
+        XCTAssertLessThanOrEqual(max(thumbnail?.size.width ?? 0, thumbnail?.size.height ?? 0), 120)
+        XCTAssertEqual(try? FileManager.default.contentsOfDirectory(atPath: rootURL.path).count, 2)
+        
+        // A new store reads the saved thumbnail
+        let reloaded = SBABlobStore(rootURL: rootURL)
+        XCTAssertNotNil(reloaded.thumbnail(for: reference, maxPixelSize: 120))
+        XCTAssertEqual(try? FileManager.default.contentsOfDirectory(atPath: rootURL.path).count, 2)
+        
+        // Removing the blob also removes its thumbnails
+        reloaded.remove(reference)
+        XCTAssertEqual(try? FileManager.default.contentsOfDirectory(atPath: rootURL.path).count, 0)
+    }
+    
+    func testProfileImage_MigratedFromKeychain() {
+        let keychain = MockKeychainWrapper()
+        let imageData = createImageData()
+        keychain.keychain["profileImage"] = imageData as NSData
+        let user = createUser(keychain: keychain)
+        
+        XCTAssertNotNil(user.profileImage)
+        XCTAssertNotNil(user.profileImageThumbnail(maxPixelSize: 60))
+        user.lockQueue.sync {}
+        user.keychainQueue.sync {}
+        
+        XCTAssertNil(keychain.keychain["profileImage"])
+        XCTAssertEqual(keychain.keychain["profileImageReference"] as? String, SBABlobStore.reference(for: imageData))
+        XCTAssertEqual(blobStore.data(for: SBABlobStore.reference(for: imageData)), imageData)
+        
+        // Replacing the image removes the old blob
+        user.profileImage = nil
+        user.lockQueue.sync {}
+        user.keychainQueue.sync {}
+        XCTAssertNil(keychain.keychain["profileImageReference"])
+        XCTAssertFalse(blobStore.contains(SBABlobStore.reference(for: imageData)))
+    }
+    
+    func testProfileImage_StoredAnswer() {
+        let keychain = MockKeychainWrapper()
+        let imageData = createImageData()
+        keychain.keychain["profileImage"] = imageData as NSData
+        let user = createUser(keychain: keychain)
+        // A profile manager without a profile image item falls back to the keychain
+        user.profileManager = SBAProfileManager(dictionaryRepresentation: [String : Any]())
+        
+        // The stored answer is read from the blob store once the image has been moved there
+        XCTAssertEqual(user.storedAnswer(for: "profileImage") as? Data, imageData)
+        XCTAssertEqual(user.storedAnswer(for: "profileImage") as? Data, imageData)
+        
+        // Setting the stored answer replaces the image that the profile image refers to
+        let newImageData = createImageData()
+        user.setStoredAnswer(newImageData, forKey: "profileImage")
+        user.lockQueue.sync {}
+        user.keychainQueue.sync {}
+        XCTAssertNil(keychain.keychain["profileImage"])
+        XCTAssertEqual(keychain.keychain["profileImageReference"] as? String, SBABlobStore.reference(for: newImageData))
+        XCTAssertEqual(user.storedAnswer(for: "profileImage") as? Data, newImageData)
+        XCTAssertFalse(blobStore.contains(SBABlobStore.reference(for: imageData)))
+    }
+    
+    func testConsentSignature_MigratedFromKeychain() {
+        let keychain = MockKeychainWrapper()
+        let legacySignature = SBAConsentSignature(identifier: "ConsentSignature")
+        legacySignature.signatureName = "Jane Doe"
+        legacySignature.signatureImage = UIImage(data: createImageData())
+        let legacySize = NSKeyedArchiver.archivedData(withRootObject: legacySignature).count
+        keychain.keychain["ConsentSignature"] = legacySignature
+        let user = createUser(keychain: keychain)
+        
+        let signature = user.consentSignature as? SBAConsentSignature
+        XCTAssertEqual(signature?.signatureName, "Jane Doe")
+        XCTAssertNotNil(signature?.signatureImageReference)
+        XCTAssertNotNil(signature?.signatureImage)
+        user.lockQueue.sync {}
+        user.keychainQueue.sync {}
+        
+        // Only the reference is archived in the keychain
+        guard let stored = keychain.keychain["ConsentSignature"] as? SBAConsentSignature else {
+            XCTFail("Signature not stored")
+            return
+        }
+        XCTAssertEqual(stored.signatureImageReference, signature?.signatureImageReference)
+        let storedData = NSKeyedArchiver.archivedData(withRootObject: stored)
+        XCTAssertLessThan(storedData.count, legacySize / 10)
+        
+        // Decoding loads the image from the blob store
+        let decoded = NSKeyedUnarchiver.unarchiveObject(with: storedData) as? SBAConsentSignature
+        decoded?.blobStore = blobStore
+        XCTAssertNotNil(decoded?.signatureImage)
+        XCTAssertEqual(decoded, stored)
+    }
+    
+    func testReadLatency_Keychain() {
+        let keychain = SBAKeychainWrapper(service: "org.sagebase.BridgeAppSDKTests.SBABlobStoreTests", accessGroup: nil)
+        defer { try? keychain.resetKeychain() }
+        do {
+            try keychain.setObject(createImageData() as NSData, forKey: "profileImage")
+        } catch let err {
+            XCTFail("Failed to set the keychain: \(err)")
+            return
+        }
+        
+        self.measure {
+            for _ in 0..<10 {
+                var error: NSError?
+                let data = keychain.object(forKey: "profileImage", error: &error) as? Data
+                XCTAssertNotNil(UIImage(data: data ?? Data()))
+            }
+        }
+    }
+    
+    func testReadLatency_BlobStore() {
+        guard let reference = try? blobStore.store(createImageData()) else {
+            XCTFail("Failed to store the image")
+            return
+        }
+        
+        self.measure {
+            for _ in 0..<10 {
+                // Use a new store each time so the image is not already in memory
+                let store = SBABlobStore(rootURL: rootURL)
+                XCTAssertNotNil(store.image(for: reference))
+            }
+        }
+    }
+    
+    func testReadLatency_BlobStoreThumbnail() {
+        guard let reference = try? blobStore.store(createImageData()) else {
+            XCTFail("Failed to store the image")
+            return
+        }
+        let _ = blobStore.thumbnail(for: reference, maxPixelSize: 120)
+        
+        self.measure {
+            for _ in 0..<10 {
+                let store = SBABlobStore(rootURL: rootURL)
+                XCTAssertNotNil(store.thumbnail(for: reference, maxPixelSize: 120))
+            }
+        }
+    }
+    
+    // MARK: helper methods
+    
+    func createUser(keychain: MockKeychainWrapper) -> SBAUser {
+        let user = SBAUser()
+        user.profileManager = nil
+        user.keychain = keychain
+        user.blobStore = blobStore
+        return user
+    }
+    
+    func createImageData() -> Data {
+        // Random blocks of color so that the image does not compress well, like a photo
+        let format = UIGraphicsImageRendererFormat()
+        format.scale = 1
+        let renderer = UIGraphicsImageRenderer(size: CGSize(width: 1200, height: 900), format: format)
+        let image = renderer.image { (context) in
+            for x in stride(from: 0, to: 1200, by: 8) {
+                for y in stride(from: 0, to: 900, by: 8) {
+                    UIColor(red: CGFloat.random(in: 0...1), green: CGFloat.random(in: 0...1), blue: CGFloat.random(in: 0...1), alpha: 1).setFill()
+                    context.fill(CGRect(x: x, y: y, width: 8, height: 8))
+                }
+            }
+        }
+        return image.jpegData(compressionQuality: 1.0)!
+    }
+}
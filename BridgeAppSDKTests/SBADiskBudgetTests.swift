@@ -0,0 +1,101 @@
+//
+//  SBADiskBudgetTests.swift
+//  BridgeAppSDK
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+import XCTest
+import BridgeAppSDK
+
+class SBADiskBudgetTests: XCTestCase {
+    
+    var rootURL: URL!
+    
+    override func setUp() {
+        super.setUp()
+        rootURL = URL(fileURLWithPath: NSTemporaryDirectory()).appendingPathComponent(UUID().uuidString)
+    }
+    
+    override func tearDown() {
+        try? FileManager.default.removeItem(at: rootURL)
+        super.tearDown()
+    }
+    
+    func testEnforce_OfflineMonth() {
+        let archivesURL = rootURL.appendingPathComponent("archives")
+        let outputURL = rootURL.appendingPathComponent("output")
+        let ledger = SBAUploadLedger(rootURL: archivesURL, fileURL: rootURL.appendingPathComponent("ledger.json"), uploader: MockArchiveUploader())
+        let budgetURL = rootURL.appendingPathComponent("budget.json")
+        let budget = SBADiskBudget(ledger: ledger, fileURL: budgetURL)
+        
+        // Two tasks a day for 30 days without uploading. The app is killed during the last 5 days of
+        // tasks before the output directories are deleted.
+        let now = Date()
+        let fileMan = FileManager.default
+        for day in 0..<30 {
+            for task in 0..<2 {
+                let date = now.addingTimeInterval(Double(day - 30) * 24 * 60 * 60 + Double(task))
+                let dirURL = archivesURL.appendingPathComponent("day\(day)_task\(task)")
+                try? fileMan.createDirectory(at: dirURL, withIntermediateDirectories: true, attributes: nil)
+                let archiveURL = dirURL.appendingPathComponent("encrypted.zip")
+                try? Data(count: 20_000).write(to: archiveURL)
+                try? fileMan.setAttributes([.modificationDate : date], ofItemAtPath: archiveURL.path)
+                
+                if day >= 25 {
+                    let outputDirectory = outputURL.appendingPathComponent("day\(day)_task\(task)")
+                    try? fileMan.createDirectory(at: outputDirectory, withIntermediateDirectories: true, attributes: nil)
+                    try? Data(count: 50_000).write(to: outputDirectory.appendingPathComponent("accel.json"))
+                    budget.registerOutputDirectory(outputDirectory)
+                }
+            }
+        }
+        
+        let before = budget.usage()
+        XCTAssertEqual(before.archiveCount, 0, "Archives are not indexed until the ledger is refreshed")
+        XCTAssertEqual(before.outputDirectoryCount, 10)
+        
+        // Relaunch and enforce a budget of 20 archives
+        let relaunched = SBADiskBudget(ledger: ledger, fileURL: budgetURL)
+        relaunched.maximumBytes = 400_000
+        let usage = relaunched.enforce(now: now)
+        
+        XCTAssertEqual(usage.outputDirectoryCount, 0)
+        XCTAssertFalse(fileMan.fileExists(atPath: outputURL.appendingPathComponent("day29_task1").path))
+        XCTAssertEqual(usage.archiveCount, 20)
+        XCTAssertLessThanOrEqual(usage.totalBytes, relaunched.maximumBytes)
+        XCTAssertEqual(usage.evictedCount, 50)
+        
+        // The newest archives are kept
+        XCTAssertTrue(fileMan.fileExists(atPath: archivesURL.appendingPathComponent("day29_task1/encrypted.zip").path))
+        XCTAssertTrue(fileMan.fileExists(atPath: archivesURL.appendingPathComponent("day20_task0/encrypted.zip").path))
+        XCTAssertFalse(fileMan.fileExists(atPath: archivesURL.appendingPathComponent("day19_task1").path))
+    }
+}
@@ -0,0 +1,184 @@
+//
+//  SBAFormatterCacheTests.swift
+//  BridgeAppSDKTests
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+import XCTest
+import BridgeSDK
+import BridgeAppSDK
+
+class SBAFormatterCacheTests: XCTestCase {
+    
+    let enUS = Locale(identifier: "en_US")
+    var calendar: Calendar = {
+        var calendar = Calendar(identifier: .gregorian)
+        calendar.timeZone = TimeZone(identifier: "UTC")!
+        return calendar
+    }()
+    
+    func testDateFormatter_Reused() {
+        let cache = SBAFormatterCache(notificationCenter: NotificationCenter())
+        
+        let formatter = cache.dateFormatter(template: "Mdy", locale: enUS, calendar: calendar)
+        XCTAssertTrue(formatter === cache.dateFormatter(template: "Mdy", locale: enUS, calendar: calendar))
+        XCTAssertFalse(formatter === cache.dateFormatter(template: "Mdy", locale: Locale(identifier: "fr_FR"), calendar: calendar))
+        XCTAssertFalse(formatter === cache.dateFormatter(template: "hma", locale: enUS, calendar: calendar))
+        XCTAssertFalse(formatter === cache.dateFormatter(format: "Mdy", locale: enUS, calendar: calendar))
+        XCTAssertEqual(cache.count, 4)
+        
+        let date = Date(timeIntervalSince1970: 1492248600)     // 2017-04-15 09:30 UTC
+        XCTAssertEqual(formatter.string(from: date), "4/15/2017")
+        XCTAssertEqual(cache.dateFormatter(format: "yyyy-MM-dd HH:mm", locale: enUS, calendar: calendar).string(from: date), "2017-04-15 09:30")
+        XCTAssertTrue(cache.numberFormatter(style: .none) === cache.numberFormatter(style: .none))
+        XCTAssertTrue(cache.personHeightFormatter().isForPersonHeightUse)
+        XCTAssertTrue(cache.personMassFormatter().isForPersonMassUse)
+    }
+    
+    func testDateFormatter_MatchesLocalizedString() {
+        let cache = SBAFormatterCache(notificationCenter: NotificationCenter())
+        let date = Date()
+        XCTAssertEqual(cache.dateFormatter(dateStyle: .medium, timeStyle: .short).string(from: date),
+                       DateFormatter.localizedString(from: date, dateStyle: .medium, timeStyle: .short))
+        XCTAssertEqual(cache.dateFormatter(dateStyle: .none, timeStyle: .short).string(from: date),
+                       DateFormatter.localizedString(from: date, dateStyle: .none, timeStyle: .short))
+    }
+    
+    func testInvalidate_LocaleOrTimeZoneChange() {
+        let notificationCenter = NotificationCenter()
+        let cache = SBAFormatterCache(notificationCenter: notificationCenter)
+        
+        let formatter = cache.dateFormatter(dateStyle: .medium, timeStyle: .none)
+        XCTAssertEqual(cache.count, 1)
+        notificationCenter.post(name: NSLocale.currentLocaleDidChangeNotification, object: nil)
+        XCTAssertEqual(cache.count, 0)
+        XCTAssertFalse(formatter === cache.dateFormatter(dateStyle: .medium, timeStyle: .none))
+        
+        notificationCenter.post(name: .NSSystemTimeZoneDidChange, object: nil)
+        XCTAssertEqual(cache.count, 0)
+    }
+    
+    func testCellConfigurationPerformance() {
+        let controller = FormatterTestActivityTableViewController()
+        let cell = createCell()
+        let indexPaths = (0..<controller.dataSource.schedules.count).map { IndexPath(row: $0, section: 0) }
+        
+        self.measure {
+            for indexPath in indexPaths {
+                controller.configure(cell: cell, in: controller.tableView, at: indexPath)
+            }
+        }
+        XCTAssertNotNil(cell.subtitleLabel.text)
+    }
+    
+    func testCellConfigurationPerformance_Uncached() {
+        // Baseline: the same strings as the cell configuration using a new formatter for each one
+        let schedules = FormatterTestDataSource().schedules
+        
+        self.measure {
+            for schedule in schedules {
+                if let finishedOn = schedule.finishedOn {
+                    let _ = DateFormatter.localizedString(from: finishedOn, dateStyle: .medium, timeStyle: .short)
+                }
+                else if let expiresOn = schedule.expiresOn {
+                    let _ = DateFormatter.localizedString(from: expiresOn, dateStyle: .medium, timeStyle: .short)
+                }
+                else {
+                    let _ = DateFormatter.localizedString(from: schedule.scheduledOn, dateStyle: .medium, timeStyle: .none)
+                }
+                let _ = DateFormatter.localizedString(from: schedule.scheduledOn, dateStyle: .none, timeStyle: .short)
+            }
+        }
+    }
+    
+    // MARK: helper methods
+    
+    func createCell() -> SBAActivityTableViewCell {
+        let cell = SBAActivityTableViewCell(style: .default, reuseIdentifier: SBAActivityTableViewController.defaultReuseIdentifier)
+        cell.titleLabel = UILabel()
+        cell.subtitleLabel = UILabel()
+        cell.timeLabel = UILabel()
+        return cell
+    }
+}
+
+class FormatterTestActivityTableViewController: SBAActivityTableViewController {
+    
+    let dataSource = FormatterTestDataSource()
+    
+    override var scheduledActivityDataSource: SBAScheduledActivityDataSource {
+        return dataSource
+    }
+}
+
+class FormatterTestDataSource: NSObject, SBAScheduledActivityDataSource {
+    
+    // A mix of completed, expired and future schedules so that each detail format is used
+    let schedules: [SBBScheduledActivity] = (0..<300).map { (ii) -> SBBScheduledActivity in
+        let now = Date()
+        let schedule = SBBScheduledActivity()
+        schedule.guid = UUID().uuidString
+        schedule.activity = SBBActivity()
+        schedule.activity.label = "Activity \(ii)"
+        schedule.activity.task = SBBTaskReference()
+        schedule.activity.task!.identifier = "Task \(ii)"
+        switch ii % 3 {
+        case 0:
+            schedule.scheduledOn = now.addingNumberOfDays(-2)
+            schedule.finishedOn = now.addingNumberOfDays(-1)
+        case 1:
+            schedule.scheduledOn = now.addingNumberOfDays(-3)
+            schedule.expiresOn = now.addingNumberOfDays(-2)
+        default:
+            schedule.scheduledOn = now.addingNumberOfDays(3 + ii)
+        }
+        return schedule
+    }
+    
+    func reloadData() {
+    }
+    
+    func numberOfSections() -> Int {
+        return 1
+    }
+    
+    func numberOfRows(for section: Int) -> Int {
+        return schedules.count
+    }
+    
+    func scheduledActivity(at indexPath: IndexPath) -> SBBScheduledActivity? {
+        return schedules[indexPath.row]
+    }
+    
+    func shouldShowTask(for indexPath: IndexPath) -> Bool {
+        return true
+    }
+}
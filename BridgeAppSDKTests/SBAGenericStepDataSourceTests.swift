@@ -0,0 +1,137 @@
+//
+//  SBAGenericStepDataSourceTests.swift
+//  BridgeAppSDK
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+import XCTest
+import ResearchKit
+@testable import BridgeAppSDK
+
+class SBAGenericStepDataSourceTests: XCTestCase {
+    
+    func testIndexedLookupAndValidity() {
+        let step = createStep(itemCount: 6)
+        let dataSource = SBAGenericStepDataSource(step: step, result: nil)
+        let delegate = MockGenericStepDataSourceDelegate()
+        dataSource.delegate = delegate
+        
+        // Numeric items share a section and each choice question is in its own section
+        XCTAssertEqual(dataSource.sections.count, 4)
+        let numericGroup = dataSource.itemGroup(with: "item4")
+        XCTAssertNotNil(numericGroup)
+        let indexPaths = dataSource.indexPaths(for: "item4")
+        XCTAssertEqual(indexPaths, [IndexPath(row: 1, section: 2)])
+        XCTAssertTrue(dataSource.itemGroup(at: indexPaths[0]) === numericGroup)
+        XCTAssertTrue(dataSource.tableItem(at: indexPaths[0])?.formItem === numericGroup?.formItem)
+        XCTAssertEqual(dataSource.indexPaths(for: "item2").count, 3)
+        XCTAssertNil(dataSource.itemGroup(with: "missing"))
+        
+        // All the questions are required
+        XCTAssertFalse(dataSource.allAnswersValid())
+        
+        dataSource.performBatchUpdates {
+            for identifier in ["item0", "item1", "item3", "item4"] {
+                dataSource.itemGroup(with: identifier)?.answer = NSNumber(value: 1)
+            }
+            for identifier in ["item2", "item5"] {
+                let indexPath = dataSource.indexPaths(for: identifier)[0]
+                dataSource.selectAnswer(selected: true, at: indexPath)
+            }
+        }
+        XCTAssertTrue(dataSource.allAnswersValid())
+        XCTAssertEqual(delegate.changes.count, 1, "Expected one notification for the batch")
+        XCTAssertEqual(delegate.changes.first, Set((0..<6).map { "item\($0)" }))
+        
+        // Clearing an answer is reported right away
+        dataSource.saveAnswer(ORKNullAnswerValue() as AnyObject, at: indexPaths[0])
+        XCTAssertFalse(dataSource.allAnswersValid())
+        XCTAssertEqual(delegate.changes.count, 2)
+        XCTAssertEqual(delegate.changes.last, ["item4"])
+    }
+    
+    func testAnswerPerformance() {
+        let step = createStep(itemCount: 500)
+        
+        measure {
+            let dataSource = SBAGenericStepDataSource(step: step, result: nil)
+            let delegate = MockGenericStepDataSourceDelegate()
+            dataSource.delegate = delegate
+            
+            // Type into each numeric field a few times
+            for section in 0..<dataSource.sections.count {
+                for row in 0..<dataSource.sections[section].itemCount() {
+                    let indexPath = IndexPath(row: row, section: section)
+                    guard let itemGroup = dataSource.itemGroup(at: indexPath) else { continue }
+                    if itemGroup.singleSelection && itemGroup.items.count > 1 {
+                        if row == 0 {
+                            dataSource.selectAnswer(selected: true, at: indexPath)
+                        }
+                    } else {
+                        for value in [1, 12, 123] {
+                            dataSource.saveAnswer(NSNumber(value: value), at: indexPath)
+                            _ = dataSource.allAnswersValid()
+                        }
+                    }
+                }
+            }
+            XCTAssertTrue(dataSource.allAnswersValid())
+        }
+    }
+    
+    // MARK: helper methods
+    
+    func createStep(itemCount: Int) -> ORKStep {
+        let step = SBANavigationFormStep(identifier: "form")
+        let choices = ["a", "b", "c"].map { ORKTextChoice(text: $0, value: $0 as NSString) }
+        step.formItems = (0..<itemCount).map { (ii) -> ORKFormItem in
+            let answerFormat: ORKAnswerFormat = (ii % 3 == 2) ?
+                ORKTextChoiceAnswerFormat(style: .singleChoice, textChoices: choices) :
+                ORKNumericAnswerFormat(style: .integer)
+            let item = ORKFormItem(identifier: "item\(ii)", text: "Question \(ii)", answerFormat: answerFormat)
+            item.isOptional = false
+            return item
+        }
+        return step
+    }
+}
+
+class MockGenericStepDataSourceDelegate: SBAGenericStepDataSourceDelegate {
+    
+    var changes: [Set<String>] = []
+    
+    func answersDidChange() {
+    }
+    
+    func answersDidChange(for identifiers: Set<String>) {
+        changes.append(identifiers)
+    }
+}
@@ -0,0 +1,184 @@
+//
+//  SBALogTests.swift
+//  BridgeAppSDK
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+import XCTest
+import BridgeAppSDK
+
+class SBALogTests: XCTestCase {
+    
+    var logDirectory: URL!
+    var originalLevel: SBALogLevel = .debug
+    
+    override func setUp() {
+        super.setUp()
+        logDirectory = URL(fileURLWithPath: NSTemporaryDirectory()).appendingPathComponent(UUID().uuidString)
+        originalLevel = SBALog.logLevel
+    }
+    
+    override func tearDown() {
+        SBALog.logLevel = originalLevel
+        try? FileManager.default.removeItem(at: logDirectory)
+        super.tearDown()
+    }
+    
+    func testFileSink_WritesEntries() {
+        let sink = SBALogFileSink(directoryURL: logDirectory)
+        SBALog.addSink(sink)
+        defer { SBALog.removeSink(sink) }
+        
+        SBALog.methodInfo("testFileSink", filenameBeingArchived: "foo.json")
+        SBALog.flush()
+        
+        guard let url = sink.logFileURLs.first,
+            let text = try? String(contentsOf: url) else {
+            XCTFail("Expected a log file")
+            return
+        }
+        XCTAssertTrue(text.contains("foo.json"))
+    }
+    
+    func testFileSink_Rotates() {
+        let sink = SBALogFileSink(directoryURL: logDirectory, maximumFileSize: 256, maximumFileCount: 3)
+        for ii in 0..<100 {
+            sink.writeEntry(SBALogEntry(level: .info, tag: "test", methodInfo: "testFileSink_Rotates", message: "message \(ii)"))
+        }
+        sink.flush()
+        
+        XCTAssertEqual(sink.logFileURLs.count, 3)
+        let newest = try? String(contentsOf: sink.logFileURLs.first!)
+        XCTAssertTrue(newest?.contains("message 99") ?? false)
+    }
+    
+    func testLogLevel_FiltersEntries() {
+        let sink = SBALogFileSink(directoryURL: logDirectory)
+        SBALog.addSink(sink)
+        defer { SBALog.removeSink(sink) }
+        
+        SBALog.logLevel = .error
+        XCTAssertFalse(SBALog.isLevelEnabled(.info))
+        SBALog.methodInfo("testLogLevel", filenameBeingArchived: "filtered.json")
+        SBALog.flush()
+        
+        let text = sink.logFileURLs.first.flatMap { try? String(contentsOf: $0) } ?? ""
+        XCTAssertFalse(text.contains("filtered.json"))
+    }
+}
+
+class SBALogEventLogTests: XCTestCase {
+    
+    var logDirectory: URL!
+    
+    override func setUp() {
+        super.setUp()
+        logDirectory = URL(fileURLWithPath: NSTemporaryDirectory()).appendingPathComponent(UUID().uuidString)
+    }
+    
+    override func tearDown() {
+        try? FileManager.default.removeItem(at: logDirectory)
+        super.tearDown()
+    }
+    
+    func testEventSink_RoundTrip() {
+        let sink = SBALogEventSink(directoryURL: logDirectory)
+        let date = Date(timeIntervalSinceReferenceDate: 500)
+        let data: [String : Any] = ["count" : 3, "size" : 1.5, "success" : true, "name" : "foo", "date" : date, "list" : ["a", "b"]]
+        sink.writeEntry(SBALogEntry(level: .info, tag: "SBA_DATA   ", methodInfo: "method", message: "upload", data: data))
+        sink.writeEntry(SBALogEntry(level: .info, tag: "SBA_VIEW   ", methodInfo: "method", message: "view"))
+        sink.flush()
+        
+        let reader = SBALogEventReader(directoryURL: logDirectory)
+        let entries = reader.entries(withTags: ["SBA_DATA"], startDate: nil, endDate: nil)
+        XCTAssertEqual(entries.count, 1)
+        guard let entry = entries.first else { return }
+        XCTAssertEqual(entry.tag, "SBA_DATA")
+        XCTAssertEqual(entry.message, "upload")
+        XCTAssertEqual(entry.data?["count"] as? Int, 3)
+        XCTAssertEqual(entry.data?["size"] as? Double, 1.5)
+        XCTAssertEqual(entry.data?["success"] as? Bool, true)
+        XCTAssertEqual(entry.data?["name"] as? String, "foo")
+        XCTAssertEqual(entry.data?["date"] as? Date, date)
+        XCTAssertEqual(entry.data?["list"] as? [String] ?? [], ["a", "b"])
+        
+        XCTAssertEqual(reader.entries(withTags: nil, startDate: nil, endDate: nil).count, 2)
+        XCTAssertEqual(reader.entries(withTags: nil, startDate: Date(), endDate: nil).count, 0)
+        XCTAssertNotNil(try? reader.jsonData(withTags: nil, startDate: nil, endDate: nil))
+    }
+    
+    func testEventSink_AppendsAfterPartialRecord() {
+        let sink = SBALogEventSink(directoryURL: logDirectory)
+        sink.writeEntry(SBALogEntry(level: .info, tag: "SBA_DATA", methodInfo: "method", message: "first"))
+        sink.writeEntry(SBALogEntry(level: .info, tag: "SBA_DATA", methodInfo: "method", message: "second"))
+        sink.flush()
+        
+        // Cut off the end of the last record as if the app was killed mid-write
+        let reader = SBALogEventReader(directoryURL: logDirectory)
+        guard let url = reader.eventFileURLs.last,
+            let handle = try? FileHandle(forWritingTo: url) else {
+            XCTFail("Event file was not written")
+            return
+        }
+        let fileSize = handle.seekToEndOfFile()
+        handle.truncateFile(atOffset: fileSize - 3)
+        handle.closeFile()
+        XCTAssertEqual(reader.entries(withTags: nil, startDate: nil, endDate: nil).map({ $0.message }), ["first"])
+        
+        // A new sink should drop the partial record before appending
+        let newSink = SBALogEventSink(directoryURL: logDirectory)
+        newSink.writeEntry(SBALogEntry(level: .info, tag: "SBA_DATA", methodInfo: "method", message: "third"))
+        newSink.writeEntry(SBALogEntry(level: .info, tag: "SBA_DATA", methodInfo: "method", message: "fourth"))
+        newSink.flush()
+        XCTAssertEqual(reader.entries(withTags: nil, startDate: nil, endDate: nil).map({ $0.message }), ["first", "third", "fourth"])
+    }
+    
+    func testEventSink_IsBounded() {
+        let maximumSize: UInt64 = 4 * 1024
+        let sink = SBALogEventSink(directoryURL: logDirectory, maximumSize: maximumSize)
+        for ii in 0..<500 {
+            sink.writeEntry(SBALogEntry(level: .info, tag: "SBA_UPLOAD", methodInfo: "method", message: "file \(ii)", data: ["index" : ii]))
+        }
+        sink.flush()
+        
+        let reader = SBALogEventReader(directoryURL: logDirectory)
+        let totalSize = reader.eventFileURLs.reduce(UInt64(0)) { (sum, url) in
+            let size = (try? FileManager.default.attributesOfItem(atPath: url.path)[.size] as? UInt64) ?? nil
+            return sum + (size ?? 0)
+        }
+        XCTAssertLessThanOrEqual(totalSize, maximumSize)
+        
+        // The newest events are kept, in order
+        let indexes = reader.entries(withTags: nil, startDate: nil, endDate: nil).compactMap { $0.data?["index"] as? Int }
+        XCTAssertEqual(indexes.last, 499)
+        XCTAssertEqual(indexes, indexes.sorted())
+    }
+}
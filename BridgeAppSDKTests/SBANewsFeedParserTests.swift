@@ -0,0 +1,385 @@
+//
+//  SBANewsFeedParserTests.swift
+//  BridgeAppSDKTests
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+import XCTest
+import BridgeAppSDK
+
+class SBANewsFeedParserTests: XCTestCase {
+    
+    let feedURL = URL(string: "https://example.org/news/feed")!
+    var storeURL: URL!
+    
+    override func setUp() {
+        super.setUp()
+        storeURL = URL(fileURLWithPath: NSTemporaryDirectory()).appendingPathComponent(UUID().uuidString).appendingPathExtension("json")
+        MockFeedURLProtocol.reset()
+    }
+    
+    override func tearDown() {
+        try? FileManager.default.removeItem(at: storeURL)
+        MockFeedURLProtocol.reset()
+        super.tearDown()
+    }
+    
+    func testFetch_RSS() {
+        MockFeedURLProtocol.response = MockFeedURLProtocol.Response(statusCode: 200, body: fixture("NewsFeed", "rss"), entityTag: "\"v1\"", lastModified: "Sat, 15 Apr 2017 09:30:00 GMT")
+        
+        let parser = createParser()
+        let (items, error) = fetch(with: parser)
+        
+        XCTAssertNil(error)
+        XCTAssertEqual(items?.map { $0.guid }, ["post-5", "post-4", "post-3", "post-2", "post-1"])
+        
+        guard let item = items?.first else { return }
+        XCTAssertEqual(item.title, "Study update 5")
+        XCTAssertEqual(item.link, "https://example.org/news/post-5")
+        XCTAssertEqual(item.author, "Study Team")
+        XCTAssertEqual(item.content, "<p>Full text of post 5.</p>")
+        XCTAssertEqual(item.imageURLsFromItemDescription() as? [String], ["https://example.org/images/post-5.png"])
+        XCTAssertEqual(item.pubDate, Date(timeIntervalSince1970: 1492248600))
+        
+        XCTAssertEqual(parser.store.entityTag, "\"v1\"")
+        XCTAssertEqual(parser.store.lastModified, "Sat, 15 Apr 2017 09:30:00 GMT")
+        XCTAssertNil(MockFeedURLProtocol.requests.first?.value(forHTTPHeaderField: "If-None-Match"))
+    }
+    
+    func testFetch_NotModified() {
+        MockFeedURLProtocol.response = MockFeedURLProtocol.Response(statusCode: 200, body: fixture("NewsFeed", "rss"), entityTag: "\"v1\"", lastModified: nil)
+        let _ = fetch(with: createParser())
+        
+        // A new parser reads the validators and items from the store file
+        let parser = createParser()
+        let (items, error) = fetch(with: parser)
+        
+        XCTAssertNil(error)
+        XCTAssertEqual(MockFeedURLProtocol.requests.count, 2)
+        XCTAssertEqual(MockFeedURLProtocol.requests.last?.value(forHTTPHeaderField: "If-None-Match"), "\"v1\"")
+        XCTAssertEqual(MockFeedURLProtocol.statusCodes, [200, 304])
+        XCTAssertEqual(items?.count, 5)
+        XCTAssertEqual(items?.first?.title, "Study update 5")
+    }
+    
+    func testFetch_StopsAtKnownItem() {
+        MockFeedURLProtocol.response = MockFeedURLProtocol.Response(statusCode: 200, body: fixture("NewsFeed", "rss"), entityTag: "\"v1\"", lastModified: nil)
+        let parser = createParser()
+        let _ = fetch(with: parser)
+        
+        MockFeedURLProtocol.response = MockFeedURLProtocol.Response(statusCode: 200, body: fixture("NewsFeed_Updated", "rss"), entityTag: "\"v2\"", lastModified: nil)
+        let (items, error) = fetch(with: parser)
+        
+        XCTAssertNil(error)
+        XCTAssertEqual(items?.map { $0.guid }, ["post-7", "post-6", "post-5", "post-4", "post-3", "post-2", "post-1"])
+        XCTAssertEqual(parser.store.entityTag, "\"v2\"")
+        
+        // Parsing stops at the first stored item so the edited titles after it are not read
+        XCTAssertEqual(items?[2].title, "Study update 5")
+        XCTAssertEqual(items?.last?.title, "Study update 1")
+    }
+    
+    func testFetch_Atom() {
+        MockFeedURLProtocol.response = MockFeedURLProtocol.Response(statusCode: 200, body: fixture("NewsFeed_Atom", "xml"), entityTag: nil, lastModified: "Thu, 13 Apr 2017 12:00:00 GMT")
+        
+        let (items, error) = fetch(with: createParser())
+        
+        XCTAssertNil(error)
+        XCTAssertEqual(items?.map { $0.guid }, ["urn:uuid:atom-post-3", "urn:uuid:atom-post-2", "urn:uuid:atom-post-1"])
+        
+        guard let item = items?.first else { return }
+        XCTAssertEqual(item.title, "Atom post 3")
+        XCTAssertEqual(item.link, "https://example.org/atom/post-3")
+        XCTAssertEqual(item.author, "Study Team")
+        XCTAssertEqual(item.itemDescription, "Summary of atom post 3.")
+        XCTAssertEqual(item.content, "<p>Full text of atom post 3.</p>")
+        XCTAssertEqual(item.pubDate, Date(timeIntervalSince1970: 1492075800))
+    }
+    
+    func testFetch_ServerError() {
+        MockFeedURLProtocol.response = MockFeedURLProtocol.Response(statusCode: 200, body: fixture("NewsFeed", "rss"), entityTag: "\"v1\"", lastModified: nil)
+        let parser = createParser()
+        let _ = fetch(with: parser)
+        
+        MockFeedURLProtocol.response = MockFeedURLProtocol.Response(statusCode: 500, body: Data(), entityTag: nil, lastModified: nil)
+        let (items, error) = fetch(with: parser)
+        
+        XCTAssertNil(items)
+        XCTAssertEqual((error as NSError?)?.domain, SBANewsFeedParserErrorDomain)
+        XCTAssertEqual((error as NSError?)?.code, 500)
+        XCTAssertEqual(parser.store.items.count, 5)
+        XCTAssertEqual(parser.store.entityTag, "\"v1\"")
+    }
+    
+    func testParseThroughput() {
+        let body = largeFeed(itemCount: 2000)
+        MockFeedURLProtocol.response = MockFeedURLProtocol.Response(statusCode: 200, body: body, entityTag: "\"v1\"", lastModified: nil)
+        
+        var elapsed: TimeInterval = 0
+        var fetchCount = 0
+        self.measure {
+            let parser = SBANewsFeedParser(feedURL: feedURL, store: SBANewsFeedStore(fileURL: nil), sessionConfiguration: MockFeedURLProtocol.sessionConfiguration())
+            let start = Date()
+            let (items, _) = fetch(with: parser)
+            elapsed += Date().timeIntervalSince(start)
+            fetchCount += 1
+            XCTAssertEqual(items?.count, 200)
+        }
+        print("Parsed \(Double(body.count * fetchCount) / elapsed) bytes/sec")
+    }
+    
+    func testUnchangedFeedPerformance() {
+        MockFeedURLProtocol.response = MockFeedURLProtocol.Response(statusCode: 200, body: largeFeed(itemCount: 2000), entityTag: "\"v1\"", lastModified: nil)
+        let parser = createParser()
+        let _ = fetch(with: parser)
+        
+        self.measure {
+            let (items, _) = fetch(with: parser)
+            XCTAssertEqual(items?.count, 200)
+        }
+        XCTAssertEqual(MockFeedURLProtocol.statusCodes.dropFirst().filter { $0 != 304 }.count, 0)
+    }
+    
+    // MARK: helper methods
+    
+    func createParser() -> SBANewsFeedParser {
+        return SBANewsFeedParser(feedURL: feedURL, store: SBANewsFeedStore(fileURL: storeURL), sessionConfiguration: MockFeedURLProtocol.sessionConfiguration())
+    }
+    
+    func fetch(with parser: SBANewsFeedParser) -> ([SBANewsFeedItem]?, Error?) {
+        var items: [SBANewsFeedItem]?
+        var error: Error?
+        let expectation = self.expectation(description: "fetch feed")
+        parser.fetchFeed { (results, err) in
+            items = results as? [SBANewsFeedItem]
+            error = err
+            expectation.fulfill()
+        }
+        self.waitForExpectations(timeout: 10, handler: nil)
+        return (items, error)
+    }
+    
+    func fixture(_ name: String, _ ext: String) -> Data {
+        let url = Bundle(for: self.classForCoder).url(forResource: name, withExtension: ext)!
+        return try! Data(contentsOf: url)
+    }
+    
+    func largeFeed(itemCount: Int) -> Data {
+        var xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<rss version=\"2.0\" xmlns:content=\"http://purl.org/rss/1.0/modules/content/\" xmlns:dc=\"http://purl.org/dc/elements/1.1/\">\n<channel>\n<title>Study News</title>\n"
+        for ii in (0..<itemCount).reversed() {
+            xml += "<item><title>Post \(ii)</title><link>https://example.org/news/post-\(ii)</link>"
+            xml += "<description><![CDATA[<p>Summary of post \(ii).</p>]]></description>"
+            xml += "<content:encoded><![CDATA[<p>\(String(repeating: "Full text of the post. ", count: 40))</p>]]></content:encoded>"
+            xml += "<pubDate>Mon, 10 Apr 2017 09:30:00 +0000</pubDate><dc:creator>Study Team</dc:creator><guid>post-\(ii)</guid></item>\n"
+        }
+        xml += "</channel>\n</rss>\n"
+        return xml.data(using: .utf8)!
+    }
+}
+
+/**
+ Local stand-in for the feed server. Serves the stubbed response in small chunks and answers
+ `304 Not Modified` when the request has a matching `If-None-Match` header.
+ */
+class MockFeedURLProtocol: URLProtocol {
+    
+    struct Response {
+        let statusCode: Int
+        let body: Data
+        let entityTag: String?
+        let lastModified: String?
+    }
+    
+    static var response = Response(statusCode: 404, body: Data(), entityTag: nil, lastModified: nil)
+    static var chunkSize = 4 * 1024
+    
+    static var requests: [URLRequest] {
+        return lock.sync { _requests }
+    }
+    static var statusCodes: [Int] {
+        return lock.sync { _statusCodes }
+    }
+    
+    private static let lock = DispatchQueue(label: "org.sagebase.BridgeAppSDKTests.MockFeedURLProtocol")
+    private static var _requests: [URLRequest] = []
+    private static var _statusCodes: [Int] = []
+    
+    static func reset() {
+        response = Response(statusCode: 404, body: Data(), entityTag: nil, lastModified: nil)
+        lock.sync {
+            _requests.removeAll()
+            _statusCodes.removeAll()
+        }
+    }
+    
+    static func sessionConfiguration() -> URLSessionConfiguration {
+        let configuration = URLSessionConfiguration.ephemeral
+        configuration.protocolClasses = [MockFeedURLProtocol.self]
+        return configuration
+    }
+    
+    override class func canInit(with request: URLRequest) -> Bool {
+        return true
+    }
+    
+    override class func canonicalRequest(for request: URLRequest) -> URLRequest {
+        return request
+    }
+    
+    override func startLoading() {
+        let stub = MockFeedURLProtocol.response
+        
+        var statusCode = stub.statusCode
+        var headers = ["Content-Type" : "application/xml"]
+        if let entityTag = stub.entityTag {
+            headers["ETag"] = entityTag
+            if request.value(forHTTPHeaderField: "If-None-Match") == entityTag {
+                statusCode = 304
+            }
+        }
+        if let lastModified = stub.lastModified {
+            headers["Last-Modified"] = lastModified
+            if stub.entityTag == nil, request.value(forHTTPHeaderField: "If-Modified-Since") == lastModified {
+                statusCode = 304
+            }
+        }
+        
+        MockFeedURLProtocol.lock.sync {
+            MockFeedURLProtocol._requests.append(request)
+            MockFeedURLProtocol._statusCodes.append(statusCode)
+        }
+        
+        let response = HTTPURLResponse(url: request.url!, statusCode: statusCode, httpVersion: "HTTP/1.1", headerFields: headers)!
+        client?.urlProtocol(self, didReceive: response, cacheStoragePolicy: .notAllowed)
+        if statusCode == 200 {
+            var offset = 0
+            while offset < stub.body.count {
+                let end = min(offset + MockFeedURLProtocol.chunkSize, stub.body.count)
+                client?.urlProtocol(self, didLoad: stub.body.subdata(in: offset..<end))
+                offset = end
+            }
+        }
+        client?.urlProtocolDidFinishLoading(self)
+    }
+    
+    override func stopLoading() {
+    }
+}
+
+class SBANewsFeedManagerTests: XCTestCase {
+    
+    var suiteName: String!
+    var userDefaults: UserDefaults!
+    
+    override func setUp() {
+        super.setUp()
+        suiteName = UUID().uuidString
+        userDefaults = UserDefaults(suiteName: suiteName)
+    }
+    
+    override func tearDown() {
+        userDefaults.removePersistentDomain(forName: suiteName)
+        super.tearDown()
+    }
+    
+    func testReadPosts() {
+        let manager = createManager()
+        manager.feedPosts = createPosts(["a", "b", "c"])
+        XCTAssertEqual(manager.unreadPostsCount(), 3)
+        
+        manager.userDidReadPost(withURL: "a")
+        manager.userDidReadPost(withURL: "a")
+        manager.userDidReadPost(withURL: "x")
+        XCTAssertTrue(manager.hasUserReadPost(withURL: "a"))
+        XCTAssertFalse(manager.hasUserReadPost(withURL: "b"))
+        XCTAssertEqual(manager.unreadPostsCount(), 2)
+        
+        // Writes are batched until the app goes to the background
+        XCTAssertNil(userDefaults.array(forKey: "ReadPostsKey"))
+        NotificationCenter.default.post(name: UIApplication.didEnterBackgroundNotification, object: nil)
+        XCTAssertEqual(Set(userDefaults.array(forKey: "ReadPostsKey") as? [String] ?? []), ["a", "x"])
+    }
+    
+    func testReadPosts_PrunedToFeed() {
+        let manager = createManager()
+        manager.feedPosts = createPosts(["a", "b", "c"])
+        manager.userDidReadPost(withURL: "a")
+        manager.userDidReadPost(withURL: "b")
+        
+        manager.feedPosts = createPosts(["b", "c", "d"])
+        XCTAssertFalse(manager.hasUserReadPost(withURL: "a"))
+        XCTAssertTrue(manager.hasUserReadPost(withURL: "b"))
+        XCTAssertEqual(manager.unreadPostsCount(), 2)
+        
+        // An empty feed does not clear the read posts
+        manager.feedPosts = []
+        XCTAssertTrue(manager.hasUserReadPost(withURL: "b"))
+        XCTAssertEqual(manager.unreadPostsCount(), 0)
+        
+        NotificationCenter.default.post(name: UIApplication.didEnterBackgroundNotification, object: nil)
+        let reloaded = createManager()
+        reloaded.feedPosts = createPosts(["b", "c", "d"])
+        XCTAssertTrue(reloaded.hasUserReadPost(withURL: "b"))
+        XCTAssertEqual(reloaded.unreadPostsCount(), 2)
+    }
+    
+    func testReadPostsPerformance() {
+        let manager = createManager()
+        let urls = (0..<1000).map { "https://example.org/news/post-\($0)" }
+        manager.feedPosts = createPosts(urls)
+        
+        self.measure {
+            for url in urls {
+                if !manager.hasUserReadPost(withURL: url) {
+                    manager.userDidReadPost(withURL: url)
+                }
+                let _ = manager.unreadPostsCount()
+            }
+        }
+        XCTAssertEqual(manager.unreadPostsCount(), 0)
+    }
+    
+    // MARK: helper methods
+    
+    func createManager() -> SBANewsFeedManager {
+        let parser = SBANewsFeedParser(feedURL: URL(string: "https://example.org/news/feed")!, store: SBANewsFeedStore(fileURL: nil), sessionConfiguration: MockFeedURLProtocol.sessionConfiguration())
+        return SBANewsFeedManager(feedParser: parser, userDefaults: userDefaults)
+    }
+    
+    func createPosts(_ urls: [String]) -> [SBANewsFeedItem] {
+        return urls.map {
+            let item = SBANewsFeedItem()
+            item.link = $0
+            item.guid = $0
+            return item
+        }
+    }
+}
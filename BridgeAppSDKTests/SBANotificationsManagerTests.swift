@@ -0,0 +1,179 @@
+//
+//  SBANotificationsManagerTests.swift
+//  BridgeAppSDK
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+import XCTest
+import BridgeSDK
+import BridgeAppSDK
+
+class SBANotificationsManagerTests: XCTestCase {
+    
+    var manager: SBANotificationsManager!
+    var scheduler: MockNotificationScheduler!
+    var suiteName: String!
+    
+    override func setUp() {
+        super.setUp()
+        
+        let appDelegate = MockAppInfoDelegate()
+        appDelegate.mockCurrentUser.mockBridgeInfo.taskMap = [
+            ["taskIdentifier" : "Notify Task", "scheduleNotification" : true],
+            ["taskIdentifier" : "Silent Task", "scheduleNotification" : false]]
+        
+        suiteName = UUID().uuidString
+        scheduler = MockNotificationScheduler()
+        manager = SBANotificationsManager()
+        manager.sharedAppDelegate = appDelegate
+        manager.notificationScheduler = scheduler
+        manager.userDefaults = UserDefaults(suiteName: suiteName)!
+    }
+    
+    override func tearDown() {
+        UserDefaults().removePersistentDomain(forName: suiteName)
+        super.tearDown()
+    }
+    
+    func testUpdateNotifications_NoChanges() {
+        let schedules = createSchedules(count: 5)
+        manager.updateNotifications(for: schedules)
+        XCTAssertEqual(scheduler.scheduleCount, 5)
+        XCTAssertEqual(scheduler.cancelCount, 0)
+        XCTAssertEqual(scheduler.scheduledLocalNotifications?.count, 5)
+        
+        // A reload with the same schedules should only read the pending notifications
+        scheduler.resetCounts()
+        manager.updateNotifications(for: schedules)
+        XCTAssertEqual(scheduler.readCount, 1)
+        XCTAssertEqual(scheduler.scheduleCount, 0)
+        XCTAssertEqual(scheduler.cancelCount, 0)
+        XCTAssertEqual(scheduler.replaceCount, 0)
+        XCTAssertEqual(scheduler.scheduledLocalNotifications?.count, 5)
+    }
+    
+    func testUpdateNotifications_ChangedSchedule() {
+        let schedules = createSchedules(count: 5)
+        manager.updateNotifications(for: schedules)
+        
+        // Move one schedule and remove another
+        scheduler.resetCounts()
+        schedules[0].scheduledOn = schedules[0].scheduledOn.addingTimeInterval(60 * 60)
+        manager.updateNotifications(for: Array(schedules.dropLast()))
+        XCTAssertEqual(scheduler.scheduleCount, 1)
+        XCTAssertEqual(scheduler.cancelCount, 2)
+        XCTAssertEqual(scheduler.replaceCount, 0)
+        XCTAssertEqual(scheduler.scheduledLocalNotifications?.count, 4)
+        
+        let fireDate = scheduler.scheduledLocalNotifications?.first(where: {
+            ($0.userInfo?["scheduleGuid"] as? String) == schedules[0].guid })?.fireDate
+        XCTAssertEqual(fireDate, schedules[0].scheduledOn)
+    }
+    
+    func testUpdateNotifications_RestoresDroppedNotification() {
+        let schedules = createSchedules(count: 5)
+        manager.updateNotifications(for: schedules)
+        
+        // The system drops a notification for a schedule that has not changed
+        let dropped = scheduler.notifications.removeLast()
+        scheduler.resetCounts()
+        manager.updateNotifications(for: schedules)
+        XCTAssertEqual(scheduler.scheduleCount, 1)
+        XCTAssertEqual(scheduler.cancelCount, 0)
+        XCTAssertEqual(scheduler.scheduledLocalNotifications?.count, 5)
+        
+        let restored = scheduler.notifications.last
+        XCTAssertEqual(restored?.userInfo?["scheduleGuid"] as? String, dropped.userInfo?["scheduleGuid"] as? String)
+        XCTAssertEqual(restored?.fireDate, dropped.fireDate)
+    }
+    
+    func testUpdateNotifications_BatchesLargeChanges() {
+        manager.batchUpdateThreshold = 8
+        manager.updateNotifications(for: createSchedules(count: 20))
+        XCTAssertEqual(scheduler.replaceCount, 1)
+        XCTAssertEqual(scheduler.scheduleCount, 0)
+        XCTAssertEqual(scheduler.scheduledLocalNotifications?.count, 20)
+    }
+    
+    func createSchedules(count: Int) -> [SBBScheduledActivity] {
+        let now = Date()
+        return (0..<(count * 2)).map({ (ii) -> SBBScheduledActivity in
+            let schedule = SBBScheduledActivity()
+            schedule.guid = UUID().uuidString
+            schedule.activity = SBBActivity()
+            schedule.activity.guid = UUID().uuidString
+            schedule.activity.label = "Task \(ii)"
+            schedule.activity.task = SBBTaskReference()
+            schedule.activity.task!.identifier = (ii % 2 == 0) ? "Notify Task" : "Silent Task"
+            schedule.scheduledOn = now.addingTimeInterval(Double(ii + 1) * 60 * 60)
+            return schedule
+        }).filter({ $0.activity.task!.identifier == "Notify Task" })
+    }
+}
+
+class MockNotificationScheduler: SBALocalNotificationScheduler {
+    
+    var notifications: [UILocalNotification] = []
+    var readCount = 0
+    var replaceCount = 0
+    var scheduleCount = 0
+    var cancelCount = 0
+    
+    func resetCounts() {
+        readCount = 0
+        replaceCount = 0
+        scheduleCount = 0
+        cancelCount = 0
+    }
+    
+    var scheduledLocalNotifications: [UILocalNotification]? {
+        get {
+            readCount += 1
+            return notifications
+        }
+        set {
+            replaceCount += 1
+            notifications = newValue ?? []
+        }
+    }
+    
+    func scheduleLocalNotification(_ notification: UILocalNotification) {
+        scheduleCount += 1
+        notifications.append(notification)
+    }
+    
+    func cancelLocalNotification(_ notification: UILocalNotification) {
+        cancelCount += 1
+        if let idx = notifications.firstIndex(of: notification) {
+            notifications.remove(at: idx)
+        }
+    }
+}
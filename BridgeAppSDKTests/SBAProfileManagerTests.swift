@@ -27,6 +27,7 @@ class SBAProfileManagerTests: ResourceTestCase {
     
     override func tearDown() {
         // Put teardown code here. This method is called after the invocation of each test method in the class.
+        SBAClientDataProfileItem.scheduledActivities = nil
         super.tearDown()
     }
     
@@ -377,6 +378,117 @@ class SBAProfileManagerTests: ResourceTestCase {
         XCTAssertEqual(testNumberSibs2, sibsBridgeValues2?[2].value as? Int, "Expected second numberOfSiblings to be \(testNumberSibs2) but got \(String(describing: sibsBridgeValues2?[2].value)) instead")
     }
     
+    func testClientDataKeychainOperationsPerScheduleLoad() {
+        guard let items = profileManager?.profileItems(),
+            let genderItem = items["gender"] as? BridgeAppSDK.SBAClientDataProfileItem,
+            let numberOfSiblingsItem = items["numberOfSiblings"] as? BridgeAppSDK.SBAClientDataProfileItem
+            else {
+                XCTFail("No ProfileManager instance")
+                return
+        }
+        
+        let mockKeychain = MockKeychainWrapper()
+        try? mockKeychain.setObject([String: [String: SBBJSONValue]]() as NSSecureCoding, forKey: SBAClientDataProfileItem.cachedItemsKey)
+        SBAClientDataProfileItem.keychain = mockKeychain
+        
+        let activityManager = MockActivityManager()
+        let startTime = Date().addingNumberOfDays(-10)
+        let schedules = buildSchedule(startTime: startTime, endTime: startTime.addingNumberOfDays(10))
+        activityManager.getScheduledActivitiesForRange_Result = schedules
+        SBBComponentManager.registerComponent(activityManager, for: SBBActivityManager.classForCoder())
+        
+        // Set and read back several values
+        for ii in 0..<5 {
+            numberOfSiblingsItem.setStoredValue(ii, asOf: Date().addingTimeInterval(Double(ii)))
+            genderItem.setStoredValue(HKBiologicalSex.female, asOf: Date().addingTimeInterval(Double(ii)))
+            XCTAssertEqual(numberOfSiblingsItem.storedValue(forKey: numberOfSiblingsItem.sourceKey) as? Int, ii)
+        }
+        
+        // Load the schedules
+        SBAClientDataProfileItem.scheduledActivities = schedules
+        SBAClientDataProfileItem.scheduledActivities = schedules
+        
+        // The keychain is read once and nothing is written until the changes are flushed
+        XCTAssertEqual(mockKeychain.objectForKey_callCount, 1)
+        XCTAssertEqual(mockKeychain.setObject_callCount, 1, "Expected only the initial write")
+        
+        SBAClientDataProfileItem.flushCurrentValues()
+        XCTAssertEqual(mockKeychain.setObject_callCount, 2)
+        
+        // Flushing again without any changes does not write
+        SBAClientDataProfileItem.flushCurrentValues()
+        XCTAssertEqual(mockKeychain.setObject_callCount, 2)
+        
+        let stored = mockKeychain.keychain[SBAClientDataProfileItem.cachedItemsKey] as? [String : [[String : SBBJSONValue]]]
+        XCTAssertEqual(stored?[numberOfSiblingsItem.profileKey]?.count, 1)
+    }
+    
+    func testClientDataTimeSeriesIndex() {
+        let startTime = Date().startOfDay()
+        let schedules = [2, 0, 4].map { createSchedule(identifier: demographicIdentifier, scheduledOn: startTime.addingNumberOfDays($0)) }
+        let index = SBAClientDataTimeSeriesIndex(scheduledActivities: schedules)
+        
+        // The best activity is the last one scheduled on or before the date, or the first if none are
+        XCTAssertTrue(index.bestScheduledActivity(for: demographicIdentifier, on: startTime.addingNumberOfDays(-1)) === schedules[1])
+        XCTAssertTrue(index.bestScheduledActivity(for: demographicIdentifier, on: startTime) === schedules[1])
+        XCTAssertTrue(index.bestScheduledActivity(for: demographicIdentifier, on: startTime.addingNumberOfDays(3)) === schedules[0])
+        XCTAssertTrue(index.bestScheduledActivity(for: demographicIdentifier, on: startTime.addingNumberOfDays(10)) === schedules[2])
+        XCTAssertNil(index.bestScheduledActivity(for: someOtherIdentifier, on: startTime))
+        
+        // Values inserted after the series is built are kept in order
+        let sourceKey = "numberOfSiblings"
+        XCTAssertEqual(index.entries(for: demographicIdentifier, sourceKey: sourceKey).count, 0)
+        for ii in [3, 1, 2] {
+            let json = SBAWhatAndWhen(ii as NSNumber, asOf: startTime.addingNumberOfDays(ii) as NSDate).dictionaryRepresentation()
+            index.insert(json, to: schedules[0], sourceKey: sourceKey)
+        }
+        let values = index.entries(for: demographicIdentifier, sourceKey: sourceKey).map { $0.json[SBAWhatAndWhen.valueKey] as? Int }
+        XCTAssertEqual(values, [1, 2, 3])
+    }
+    
+    func testClientDataTimeSeriesPerformance() {
+        guard let items = profileManager?.profileItems(),
+            let numberOfSiblingsItem = items["numberOfSiblings"] as? BridgeAppSDK.SBAClientDataProfileItem
+            else {
+                XCTFail("No ProfileManager instance")
+                return
+        }
+        
+        // Five years of daily schedules, each with a value
+        let dayCount = 5 * 365
+        let startTime = Date().startOfDay().addingNumberOfDays(-dayCount)
+        let createSchedules = { () -> [SBBScheduledActivity] in
+            return (0..<dayCount).map { (day) -> SBBScheduledActivity in
+                let scheduledOn = startTime.addingNumberOfDays(day)
+                let schedule = self.createSchedule(identifier: numberOfSiblingsItem.activityIdentifier, scheduledOn: scheduledOn)
+                let json = SBAWhatAndWhen(day as NSNumber, asOf: scheduledOn.addingTimeInterval(60) as NSDate).dictionaryRepresentation()
+                schedule.clientData = NSMutableDictionary(dictionary: [numberOfSiblingsItem.sourceKey : [json]])
+                return schedule
+            }
+        }
+        let setCount = (dayCount + 9) / 10
+        
+        var valueCount = 0
+        var finalValueCount = 0
+        self.measureMetrics(XCTestCase.defaultPerformanceMetrics, automaticallyStartMeasuring: false) {
+            // Each pass adds values to the schedules so build new ones
+            let schedules = createSchedules()
+            self.startMeasuring()
+            
+            SBAClientDataProfileItem.scheduledActivities = schedules
+            valueCount = numberOfSiblingsItem.jsonWhatsAndWhensFromBridge().count
+            for day in stride(from: 0, to: dayCount, by: 10) {
+                let json = SBAWhatAndWhen(day as NSNumber, asOf: startTime.addingNumberOfDays(day).addingTimeInterval(120) as NSDate).dictionaryRepresentation()
+                numberOfSiblingsItem.setToAppropriateScheduledActivity(json)
+            }
+            _ = numberOfSiblingsItem.valuesAndDates()
+            self.stopMeasuring()
+            finalValueCount = numberOfSiblingsItem.jsonWhatsAndWhensFromBridge().count
+        }
+        XCTAssertEqual(valueCount, dayCount)
+        XCTAssertEqual(finalValueCount, dayCount + setCount)
+    }
+    
 }
 
 class DummyCustomAttributes: SBBStudyParticipantCustomAttributes {
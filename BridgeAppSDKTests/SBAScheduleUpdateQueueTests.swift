@@ -0,0 +1,152 @@
+//
+//  SBAScheduleUpdateQueueTests.swift
+//  BridgeAppSDK
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+import XCTest
+import BridgeSDK
+@testable import BridgeAppSDK
+
+class SBAScheduleUpdateQueueTests: XCTestCase {
+    
+    var fileURL: URL!
+    var activityManager: MockActivityManager!
+    
+    override func setUp() {
+        super.setUp()
+        fileURL = URL(fileURLWithPath: NSTemporaryDirectory()).appendingPathComponent("\(UUID().uuidString).json")
+        activityManager = MockActivityManager()
+        SBBComponentManager.registerComponent(activityManager, for: SBBActivityManager.classForCoder())
+    }
+    
+    override func tearDown() {
+        SBBComponentManager.reset()
+        try? FileManager.default.removeItem(at: fileURL)
+        super.tearDown()
+    }
+    
+    func testBurstyFinishes_SendsOneRequest() {
+        let queue = SBAScheduleUpdateQueue(fileURL: fileURL, batchInterval: 0.5)
+        let schedules = (0..<5).map { createSchedule(guid: "schedule\($0)") }
+        
+        // Finish each schedule several times, sometimes with a different copy of the schedule
+        for ii in 0..<30 {
+            let schedule = ii % 2 == 0 ? schedules[ii % 5] : createSchedule(guid: "schedule\(ii % 5)")
+            schedule.finishedOn = Date()
+            queue.enqueue([schedule])
+        }
+        XCTAssertEqual(queue.pendingCount, 5)
+        
+        let sent = expectation(forNotification: SBAScheduleUpdateQueue.didSendUpdatesNotification, object: queue, handler: nil)
+        wait(for: [sent], timeout: 5)
+        
+        XCTAssertEqual(activityManager.updateScheduledActivities_callCount, 1)
+        XCTAssertEqual(activityManager.updateScheduledActivities_scheduledActivities.first?.compactMap { $0.guid }, schedules.map { $0.guid })
+        XCTAssertEqual(queue.pendingCount, 0)
+        XCTAssertFalse(FileManager.default.fileExists(atPath: fileURL.path))
+    }
+    
+    func testQueuedUpdatesSurviveRelaunch() {
+        let queue = SBAScheduleUpdateQueue(fileURL: fileURL, batchInterval: 60)
+        let startedOn = Date(timeIntervalSince1970: 1000)
+        let schedules = (0..<3).map { (ii) -> SBBScheduledActivity in
+            let schedule = createSchedule(guid: "schedule\(ii)")
+            schedule.startedOn = startedOn
+            return schedule
+        }
+        queue.enqueue(schedules)
+        
+        // A new queue reads the updates from disk
+        let relaunchedQueue = SBAScheduleUpdateQueue(fileURL: fileURL, batchInterval: 60)
+        XCTAssertEqual(relaunchedQueue.pendingCount, 3)
+        
+        let sent = expectation(forNotification: SBAScheduleUpdateQueue.didSendUpdatesNotification, object: relaunchedQueue, handler: nil)
+        relaunchedQueue.flush()
+        wait(for: [sent], timeout: 5)
+        
+        XCTAssertEqual(activityManager.updateScheduledActivities_callCount, 1)
+        let sentSchedules = activityManager.updateScheduledActivities_scheduledActivities.first ?? []
+        XCTAssertEqual(sentSchedules.compactMap { $0.guid }, ["schedule0", "schedule1", "schedule2"])
+        XCTAssertEqual(sentSchedules.first?.startedOn, startedOn)
+        XCTAssertEqual(relaunchedQueue.pendingCount, 0)
+    }
+    
+    func testEnqueue_CopiesValues() {
+        let queue = SBAScheduleUpdateQueue(fileURL: fileURL, batchInterval: 60)
+        let finishedOn = Date(timeIntervalSince1970: 1000)
+        let schedule = createSchedule(guid: "schedule")
+        schedule.finishedOn = finishedOn
+        queue.enqueue([schedule])
+        
+        // Changing the schedule after it is queued should not change the update
+        schedule.finishedOn = Date(timeIntervalSince1970: 2000)
+        
+        let sent = expectation(forNotification: SBAScheduleUpdateQueue.didSendUpdatesNotification, object: queue, handler: nil)
+        queue.flush()
+        wait(for: [sent], timeout: 5)
+        
+        let sentSchedules = activityManager.updateScheduledActivities_scheduledActivities.first ?? []
+        XCTAssertEqual(sentSchedules.count, 1)
+        XCTAssertEqual(sentSchedules.first?.finishedOn, finishedOn)
+        XCTAssertFalse(sentSchedules.first === schedule)
+    }
+    
+    func testRemoveAll() {
+        let queue = SBAScheduleUpdateQueue(fileURL: fileURL, batchInterval: 0.5)
+        queue.enqueue((0..<3).map { createSchedule(guid: "schedule\($0)") })
+        XCTAssertTrue(FileManager.default.fileExists(atPath: fileURL.path))
+        
+        queue.removeAll()
+        XCTAssertEqual(queue.pendingCount, 0)
+        XCTAssertFalse(FileManager.default.fileExists(atPath: fileURL.path))
+        
+        // The pending flush is cancelled
+        let expect = expectation(description: "wait for batch interval")
+        DispatchQueue.main.asyncAfter(deadline: .now() + 1.0) {
+            expect.fulfill()
+        }
+        wait(for: [expect], timeout: 5)
+        XCTAssertEqual(activityManager.updateScheduledActivities_callCount, 0)
+        
+        // A new queue does not load the removed updates
+        XCTAssertEqual(SBAScheduleUpdateQueue(fileURL: fileURL, batchInterval: 60).pendingCount, 0)
+    }
+    
+    // MARK: helper methods
+    
+    func createSchedule(guid: String) -> SBBScheduledActivity {
+        let schedule = SBBScheduledActivity()
+        schedule.guid = guid
+        schedule.scheduledOn = Date(timeIntervalSince1970: 0)
+        return schedule
+    }
+}
@@ -32,7 +32,7 @@
 //
 
 import XCTest
-import BridgeAppSDK
+@testable import BridgeAppSDK
 import BridgeSDK
 import ResearchKit
 
@@ -552,6 +552,58 @@ class SBAScheduledActivityManagerTests: XCTestCase {
         XCTAssertEqual(lastCountdownResult?.identifier, "file")
     }
     
+    // MARK: archiveAndUpload
+    
+    func testArchiveAndUpload_PreservesOrder() {
+        
+        let manager = TestScheduledActivityManager()
+        manager.maxConcurrentArchiveCount = 4
+        
+        let activityResults = createTextActivityResults(count: 12, stepCount: 4, answerLength: 1024)
+        let archives = manager.archiveAndUpload(activityResults: activityResults)
+        defer {
+            archives.forEach({ $0.remove() })
+        }
+        
+        XCTAssertEqual(archives.count, activityResults.count)
+        XCTAssertEqual(manager.uploadedArchives.count, activityResults.count)
+        XCTAssertTrue(manager.uploadedArchives.elementsEqual(archives, by: { $0 === $1 }))
+        
+        let expectedOrder = activityResults.map({ $0.schemaIdentifier })
+        XCTAssertEqual(manager.archivedSchemaIdentifiers, expectedOrder)
+    }
+    
+    func testArchiveAndUploadPerformance() {
+        
+        let manager = TestScheduledActivityManager()
+        let activityResults = createTextActivityResults(count: 8, stepCount: 20, answerLength: 64 * 1024)
+        
+        self.measure {
+            manager.uploadedArchives.removeAll()
+            let archives = manager.archiveAndUpload(activityResults: activityResults)
+            archives.forEach({ $0.remove() })
+        }
+    }
+    
+    func createTextActivityResults(count: Int, stepCount: Int, answerLength: Int) -> [SBAActivityResult] {
+        let answer = String(repeating: "a", count: answerLength)
+        return (0..<count).map({ (ii) -> SBAActivityResult in
+            let schemaId = "Schema \(ii)"
+            let schedule = createScheduledActivity(schemaId)
+            let activityResult = SBAActivityResult(taskIdentifier: schemaId, taskRun: UUID(), outputDirectory: nil)
+            activityResult.schedule = schedule
+            activityResult.schemaIdentifier = schemaId
+            activityResult.schemaRevision = NSNumber(value: 1)
+            activityResult.results = (0..<stepCount).map({ (jj) -> ORKStepResult in
+                let result = ORKTextQuestionResult(identifier: "text")
+                result.questionType = .text
+                result.textAnswer = answer
+                return ORKStepResult(stepIdentifier: "step\(jj)", results: [result])
+            })
+            return activityResult
+        })
+    }
+    
     func checkValidation(_ splitResults: [SBAActivityResult]) {
         for activityResult in splitResults {
             
@@ -755,6 +807,399 @@ class SBAScheduledActivityManagerTests: XCTestCase {
         
     }
     
+    // MARK: activity store
+    
+    func testActivityStore_Lookup() {
+        let (schedules, _, _) = createFullSchedule()
+        let store = SBAScheduledActivityStore(activities: schedules)
+        
+        XCTAssertEqual(store.count, schedules.count)
+        for schedule in schedules {
+            XCTAssertEqual(store.activity(withGuid: schedule.guid), schedule)
+            XCTAssertEqual(store.activity(withScheduleIdentifier: schedule.activity.guid), schedule)
+            XCTAssertEqual(store.firstActivity(withActivityIdentifier: schedule.activityIdentifier!), schedule)
+        }
+        
+        let tomorrow = Date().addingNumberOfDays(1)
+        let expectedTomorrow = schedules.filter({ Calendar.current.isDate($0.scheduledOn, inSameDayAs: tomorrow) })
+        XCTAssertEqual(store.activities(scheduledOn: tomorrow), expectedTomorrow)
+        
+        let yesterday = Date().addingNumberOfDays(-1)
+        let expectedExpired = schedules.filter({ $0.expiresOn != nil && Calendar.current.isDate($0.expiresOn!, inSameDayAs: yesterday) })
+        XCTAssertEqual(store.activities(expiringOn: yesterday), expectedExpired)
+        
+        XCTAssertNil(store.activity(withGuid: "not a guid"))
+    }
+    
+    func testActivityStore_Update() {
+        let (schedules, _, _) = createFullSchedule()
+        var store = SBAScheduledActivityStore(activities: schedules)
+        
+        let schedule = schedules.sba_find({ $0.taskIdentifier == "4AM - Incomplete" })!
+        XCTAssertFalse(store.activities(finishedOn: Date()).contains(schedule))
+        
+        schedule.finishedOn = Date()
+        store.update(schedule)
+        
+        let expected = schedules.filter({ $0.finishedOn != nil && Calendar.current.isDateInToday($0.finishedOn!) })
+        XCTAssertEqual(store.activities(finishedOn: Date()), expected)
+    }
+    
+    func testDidUpdate_SectionsAreUpdatedIncrementally() {
+        let manager = TestScheduledActivityManager()
+        manager.daysAhead = 7
+        let (schedules, sections, _) = createFullSchedule()
+        manager.sections = sections
+        manager.activities = schedules
+        
+        // Load the section cache
+        for section in 0..<manager.numberOfSections() {
+            _ = manager.numberOfRows(for: section)
+        }
+        
+        // Finish an optional task
+        let schedule = schedules.sba_find({ $0.taskIdentifier == "2 Days Ago - Incomplete - Optional" })!
+        schedule.finishedOn = Date()
+        manager.didUpdate(scheduledActivities: [schedule])
+        
+        for section in 0..<manager.numberOfSections() {
+            let filter = manager.filter(for: section)!
+            let expected = schedules.filter({ filter.evaluate(with: $0) })
+            XCTAssertEqual(manager.scheduledActivities(for: section), expected, "\(section)")
+        }
+    }
+    
+    func testLoad_Unchanged_SkipsNotificationsAndTableUpdates() {
+        let manager = TestScheduledActivityManager()
+        let delegate = TestScheduledActivityManagerDelegate()
+        manager.delegate = delegate
+        
+        let schedules = createScheduledActivities([comboTaskId, tappingTaskId, voiceTaskId])
+        manager.load(scheduledActivities: schedules)
+        XCTAssertEqual(manager.notificationSetupCount, 1)
+        XCTAssertEqual(delegate.changes.count, 1)
+        XCTAssertEqual(delegate.changes.last?.insertedGuids.count, 3)
+        
+        // Reloading the same schedules should not change the notifications or the table
+        manager.load(scheduledActivities: schedules)
+        XCTAssertEqual(manager.notificationSetupCount, 1)
+        XCTAssertEqual(delegate.changes.count, 2)
+        XCTAssertEqual(delegate.changes.last?.isEmpty, true)
+        XCTAssertEqual(delegate.changes.last?.deletedIndexPaths.count, 0)
+        XCTAssertEqual(delegate.changes.last?.insertedIndexPaths.count, 0)
+    }
+    
+    func testLoad_Changed_SendsRowChanges() {
+        let manager = TestScheduledActivityManager()
+        let delegate = TestScheduledActivityManagerDelegate()
+        manager.delegate = delegate
+        
+        let now = Date()
+        let scheduleA = createScheduledActivity(comboTaskId, scheduledOn: now.addingTimeInterval(-3 * 60))
+        let scheduleB = createScheduledActivity(tappingTaskId, scheduledOn: now.addingTimeInterval(-2 * 60))
+        let scheduleC = createScheduledActivity(voiceTaskId, scheduledOn: now.addingTimeInterval(-1 * 60))
+        manager.load(scheduledActivities: [scheduleA, scheduleB, scheduleC])
+        XCTAssertEqual(manager.numberOfRows(for: 0), 3)
+        
+        // Remove B, finish C and add D
+        let scheduleD = createScheduledActivity(comboTaskId, scheduledOn: now)
+        scheduleC.finishedOn = now
+        manager.load(scheduledActivities: [scheduleA, scheduleC, scheduleD])
+        
+        guard let changes = delegate.changes.last else {
+            XCTFail("Delegate was not called")
+            return
+        }
+        XCTAssertEqual(changes.insertedGuids, [scheduleD.guid])
+        XCTAssertEqual(changes.removedGuids, [scheduleB.guid])
+        XCTAssertEqual(changes.updatedGuids, [scheduleC.guid])
+        XCTAssertFalse(changes.requiresReload)
+        XCTAssertEqual(changes.deletedIndexPaths, [IndexPath(row: 1, section: 0), IndexPath(row: 2, section: 0)])
+        XCTAssertEqual(changes.insertedIndexPaths, [IndexPath(row: 1, section: 0), IndexPath(row: 2, section: 0)])
+        XCTAssertEqual(manager.numberOfRows(for: 0), 3)
+        XCTAssertEqual(manager.notificationSetupCount, 2)
+        
+        // Updating a schedule in place should only send the changed row
+        scheduleA.finishedOn = now
+        manager.didUpdate(scheduledActivities: [scheduleA])
+        XCTAssertEqual(delegate.changes.last?.updatedGuids, [scheduleA.guid])
+        XCTAssertEqual(delegate.changes.last?.deletedIndexPaths ?? [], [IndexPath(row: 0, section: 0)])
+        XCTAssertEqual(delegate.changes.last?.insertedIndexPaths ?? [], [IndexPath(row: 0, section: 0)])
+    }
+    
+    func testFilterPredicateOverride() {
+        let manager = TestPredicateScheduledActivityManager()
+        
+        let now = Date()
+        let scheduleA = createScheduledActivity(comboTaskId, scheduledOn: now.addingTimeInterval(-3 * 60))
+        let scheduleB = createScheduledActivity(tappingTaskId, scheduledOn: now.addingTimeInterval(-2 * 60))
+        let scheduleC = createScheduledActivity(voiceTaskId, scheduledOn: now.addingTimeInterval(-1 * 60))
+        manager.load(scheduledActivities: [scheduleA, scheduleB, scheduleC])
+        
+        // The overridden predicate should be used to build the section
+        XCTAssertEqual(manager.numberOfRows(for: 0), 1)
+        XCTAssertEqual(manager.scheduledActivities(for: 0).first?.guid, scheduleB.guid)
+    }
+    
+    func testSectionFilterPerformance_Predicate() {
+        let manager = createLargeScheduleManager()
+        self.measure {
+            // Evaluate the predicates for each visible cell without using the section cache
+            for section in 0..<manager.numberOfSections() {
+                guard let predicate = manager.filterPredicate(for: section) else { continue }
+                let rowCount = manager.activities.filter({ predicate.evaluate(with: $0) }).count
+                for row in 0..<min(rowCount, 20) {
+                    let schedules = manager.activities.filter({ predicate.evaluate(with: $0) })
+                    _ = schedules[row]
+                }
+            }
+        }
+    }
+    
+    func testSectionFilterPerformance_Indexed() {
+        let manager = createLargeScheduleManager()
+        self.measure {
+            manager.invalidateSections()
+            for section in 0..<manager.numberOfSections() {
+                let rowCount = manager.numberOfRows(for: section)
+                for row in 0..<min(rowCount, 20) {
+                    _ = manager.scheduledActivity(at: IndexPath(row: row, section: section))
+                }
+            }
+        }
+    }
+    
+    func testSnapshot_UsesFilterFromContext() {
+        let manager = TestScheduledActivityManager()
+        manager.scheduleFilter = .all
+        
+        let now = Date()
+        let scheduleA = createScheduledActivity(comboTaskId, scheduledOn: now.addingTimeInterval(-2 * 60))
+        let scheduleB = createScheduledActivity(tappingTaskId, scheduledOn: now.addingTimeInterval(-1 * 60))
+        
+        // Changing the filter after the context is created should not change the snapshot
+        let context = manager.createLoadContext()
+        manager.scheduleFilter = SBAScheduleFilter({ _ in false })
+        let snapshot = manager.createSnapshot(for: [scheduleA, scheduleB], context: context)
+        XCTAssertEqual(snapshot.activities.count, 2)
+    }
+    
+    func testSnapshot_CreatedOffMain() {
+        let manager = TestScheduledActivityManager()
+        manager.daysAhead = 14
+        manager.sections = [.expiredYesterday, .today, .keepGoing, .tomorrow, .comingUp]
+        let delegate = TestScheduledActivityManagerDelegate()
+        manager.delegate = delegate
+        let schedules = createLargeSchedules(count: 1000, taskIds: [comboTaskId, tappingTaskId, voiceTaskId])
+        
+        let context = manager.createLoadContext()
+        let expect = expectation(description: "Snapshot applied")
+        manager.scheduleLoadQueue.async {
+            let snapshot = manager.createSnapshot(for: schedules, context: context)
+            DispatchQueue.main.async {
+                manager.apply(snapshot: snapshot)
+                expect.fulfill()
+            }
+        }
+        waitForExpectations(timeout: 10, handler: nil)
+        
+        let filteredSchedules = schedules.filter({ manager.scheduleFilter.evaluate(with: $0) })
+        XCTAssertEqual(manager.activities, filteredSchedules)
+        XCTAssertEqual(manager.activityStore.count, filteredSchedules.count)
+        XCTAssertEqual(delegate.changes.count, 1)
+        XCTAssertEqual(manager.lastLoadMetrics?.scheduleCount, schedules.count)
+        for section in 0..<manager.numberOfSections() {
+            let filter = manager.filter(for: section)!
+            let expected = schedules.filter({ filter.evaluate(with: $0) })
+            XCTAssertEqual(manager.scheduledActivities(for: section), expected, "\(section)")
+        }
+    }
+    
+    func testScheduleLoadPerformance_MainThreadApply() {
+        let manager = TestScheduledActivityManager()
+        manager.daysAhead = 14
+        manager.sections = [.expiredYesterday, .today, .keepGoing, .tomorrow, .comingUp]
+        let schedules = createLargeSchedules(count: 10000, taskIds: [comboTaskId, tappingTaskId, voiceTaskId])
+        
+        // Only the time spent on the main thread is measured
+        self.measureMetrics(XCTestCase.defaultPerformanceMetrics, automaticallyStartMeasuring: false) {
+            manager.activities = []
+            let snapshot = manager.createSnapshot(for: schedules, context: manager.createLoadContext())
+            self.startMeasuring()
+            manager.apply(snapshot: snapshot)
+            _ = manager.numberOfRows(for: 0)
+            self.stopMeasuring()
+        }
+        if let metrics = manager.lastLoadMetrics {
+            print("filter: \(metrics.filterDuration), merge: \(metrics.mergeDuration), section: \(metrics.sectionDuration), apply: \(metrics.applyDuration)")
+        }
+    }
+    
+    func testSnapshotCache_RoundTrip() {
+        let cache = SBAScheduledActivitySnapshotCache(url: temporarySnapshotURL())
+        defer { cache.remove() }
+        
+        let manager = createLargeScheduleManager(count: 200)
+        manager.snapshotCache = cache
+        let sectionGuids = (0..<manager.numberOfSections()).map({ manager.scheduledActivities(for: $0).map({ $0.guid! }) })
+        try! cache.write(activities: manager.activities, sectionGuids: sectionGuids, day: Date().startOfDay(), version: manager.snapshotVersion)
+        
+        // A different version should be ignored
+        XCTAssertNil(cache.read(version: "other"))
+        
+        let newManager = createLargeScheduleManager(count: 0)
+        newManager.snapshotCache = cache
+        let delegate = TestScheduledActivityManagerDelegate()
+        newManager.delegate = delegate
+        XCTAssertTrue(newManager.loadSnapshotCache())
+        XCTAssertEqual(delegate.changes.count, 1)
+        XCTAssertEqual(newManager.activities.map({ $0.guid! }), manager.activities.map({ $0.guid! }))
+        for (schedule, expected) in zip(newManager.activities, manager.activities) {
+            XCTAssertEqual(schedule.taskIdentifier, expected.taskIdentifier)
+            XCTAssertEqual(schedule.activity.guid, expected.activity.guid)
+            XCTAssertEqual(schedule.scheduledOn, expected.scheduledOn)
+            XCTAssertEqual(schedule.expiresOn, expected.expiresOn)
+            XCTAssertEqual(schedule.finishedOn, expected.finishedOn)
+            XCTAssertEqual(schedule.persistentValue, expected.persistentValue)
+        }
+        for section in 0..<newManager.numberOfSections() {
+            XCTAssertEqual(newManager.scheduledActivities(for: section).map({ $0.guid! }), sectionGuids[section])
+        }
+    }
+    
+    func testSnapshotCache_ReplacedByLoadedSchedules() {
+        let cache = SBAScheduledActivitySnapshotCache(url: temporarySnapshotURL())
+        defer { cache.remove() }
+        
+        let schedules = createLargeSchedules(count: 30, taskIds: [comboTaskId, tappingTaskId, voiceTaskId])
+        let manager = TestScheduledActivityManager()
+        manager.load(scheduledActivities: schedules)
+        XCTAssertGreaterThan(manager.activities.count, 0)
+        try! cache.write(activities: manager.activities, sectionGuids: nil, day: Date().startOfDay(), version: manager.snapshotVersion)
+        
+        let newManager = TestScheduledActivityManager()
+        newManager.snapshotCache = cache
+        XCTAssertTrue(newManager.loadSnapshotCache())
+        XCTAssertFalse(zip(newManager.activities, manager.activities).contains(where: { $0 === $1 }))
+        
+        // Loading the same schedules from BridgeSDK should replace the activities rebuilt from the snapshot
+        newManager.load(scheduledActivities: schedules)
+        XCTAssertEqual(newManager.activities.count, manager.activities.count)
+        XCTAssertFalse(zip(newManager.activities, manager.activities).contains(where: { $0 !== $1 }))
+        for section in 0..<newManager.numberOfSections() {
+            for schedule in newManager.scheduledActivities(for: section) {
+                XCTAssertTrue(schedules.contains(where: { $0 === schedule }))
+            }
+        }
+    }
+    
+    func testSnapshotCache_RemovedOnSignOut() {
+        let cache = SBAScheduledActivitySnapshotCache()
+        defer { cache.remove() }
+        
+        let manager = createLargeScheduleManager(count: 20)
+        try! cache.write(activities: manager.activities, sectionGuids: nil, day: Date().startOfDay(), version: manager.snapshotVersion)
+        
+        let user = SBAUser()
+        user.profileManager = nil
+        user.keychain = MockKeychainWrapper()
+        user.resetStoredUserData()
+        
+        // The next participant to sign in should not see the schedules of the previous one
+        let newManager = createLargeScheduleManager(count: 0)
+        newManager.snapshotCache = cache
+        XCTAssertFalse(newManager.loadSnapshotCache())
+        XCTAssertEqual(newManager.activities.count, 0)
+    }
+    
+    func testColdStartPerformance_SnapshotCache() {
+        let cache = SBAScheduledActivitySnapshotCache(url: temporarySnapshotURL())
+        defer { cache.remove() }
+        
+        let manager = createLargeScheduleManager(count: 10000)
+        let sectionGuids = (0..<manager.numberOfSections()).map({ manager.scheduledActivities(for: $0).map({ $0.guid! }) })
+        try! cache.write(activities: manager.activities, sectionGuids: sectionGuids, day: Date().startOfDay(), version: manager.snapshotVersion)
+        
+        // Measure the time to the first rendered row for a new manager
+        self.measure {
+            let newManager = self.createLargeScheduleManager(count: 0)
+            newManager.snapshotCache = cache
+            XCTAssertTrue(newManager.loadSnapshotCache())
+            let section = (0..<newManager.numberOfSections()).first(where: { newManager.numberOfRows(for: $0) > 0 })
+            XCTAssertNotNil(newManager.scheduledActivity(at: IndexPath(row: 0, section: section ?? 0)))
+        }
+    }
+    
+    func temporarySnapshotURL() -> URL {
+        return URL(fileURLWithPath: NSTemporaryDirectory()).appendingPathComponent("\(UUID().uuidString).plist")
+    }
+    
+    func createLargeScheduleManager(count: Int = 10000) -> TestScheduledActivityManager {
+        let manager = TestScheduledActivityManager()
+        manager.daysAhead = 14
+        manager.sections = [.expiredYesterday, .today, .keepGoing, .tomorrow, .comingUp]
+        manager.activities = createLargeSchedules(count: count, taskIds: (0..<50).map({ "Task \($0)" }))
+        return manager
+    }
+    
+    func testTaskSchemaRegistry_Lookup() {
+        let bridgeInfo = MockBridgeInfo()
+        bridgeInfo.taskMap = [["taskIdentifier" : "taskA", "activityMinutes" : 1],
+                              ["taskIdentifier" : "taskA", "activityMinutes" : 2],
+                              ["taskIdentifier" : "taskB"]]
+        bridgeInfo.schemaMap = [["schemaIdentifier" : "schemaA", "schemaRevision" : 3]]
+        
+        // The first mapping for an identifier is used
+        XCTAssertEqual(bridgeInfo.taskReferenceWithIdentifier("taskA")?.activityMinutes, 1)
+        XCTAssertNotNil(bridgeInfo.taskReferenceWithIdentifier("taskB"))
+        XCTAssertNil(bridgeInfo.taskReferenceWithIdentifier("taskC"))
+        XCTAssertEqual(bridgeInfo.schemaReferenceWithIdentifier("schemaA")?.schemaRevision, 3)
+        XCTAssertNil(bridgeInfo.schemaReferenceWithIdentifier("schemaB"))
+        
+        // The registry is reused until it is invalidated
+        XCTAssertTrue(bridgeInfo.taskSchemaRegistry === bridgeInfo.taskSchemaRegistry)
+        bridgeInfo.taskMap = [["taskIdentifier" : "taskC"]]
+        XCTAssertNil(bridgeInfo.taskReferenceWithIdentifier("taskC"))
+        SBATaskSchemaRegistry.invalidate(for: bridgeInfo)
+        XCTAssertNotNil(bridgeInfo.taskReferenceWithIdentifier("taskC"))
+        XCTAssertNil(bridgeInfo.taskReferenceWithIdentifier("taskA"))
+    }
+    
+    func testTaskSchemaRegistryPerformance() {
+        // 1k task and schema mappings looked up for 10k schedules
+        let taskIds = (0..<1000).map { "task\($0)" }
+        let bridgeInfo = MockBridgeInfo()
+        bridgeInfo.taskMap = taskIds.map { ["taskIdentifier" : $0] as NSDictionary }
+        bridgeInfo.schemaMap = taskIds.map { ["schemaIdentifier" : $0, "schemaRevision" : 2] as NSDictionary }
+        let schedules = createLargeSchedules(count: 10000, taskIds: taskIds)
+        
+        measure {
+            SBATaskSchemaRegistry.invalidate(for: bridgeInfo)
+            var found = 0
+            for schedule in schedules {
+                if let taskId = bridgeInfo.taskReferenceForSchedule(schedule)?.taskIdentifier,
+                    bridgeInfo.schemaReferenceWithIdentifier(taskId) != nil {
+                    found += 1
+                }
+            }
+            XCTAssertEqual(found, schedules.count)
+        }
+    }
+    
+    func createLargeSchedules(count: Int, taskIds: [String]) -> [SBBScheduledActivity] {
+        // Spread the schedules over 28 days with a mix of finished, expiring and optional schedules
+        let startDay = Date().startOfDay().addingNumberOfDays(-14)
+        return (0..<count).map({ (ii) -> SBBScheduledActivity in
+            let scheduledOn = startDay.addingNumberOfDays(ii % 28).addingTimeInterval(Double(ii % 24) * 60 * 60)
+            let finishedOn: Date? = (ii % 3 == 0) ? scheduledOn.addingTimeInterval(30 * 60) : nil
+            return createScheduledActivity(taskIds[ii % taskIds.count],
+                                           scheduledOn: scheduledOn,
+                                           expiresOn: scheduledOn.addingNumberOfDays(1),
+                                           finishedOn: finishedOn,
+                                           optional: (ii % 5 == 0))
+        })
+    }
+    
     // MARK: helper methods
     
     func createScheduledActivities(_ taskIds:[String]) -> [SBBScheduledActivity] {
@@ -948,6 +1393,20 @@ class TestTaskViewController: SBATaskViewController {
     
 }
 
+class TestScheduledActivityManagerDelegate: UIViewController, SBAScheduledActivityManagerDelegate {
+    
+    var reloadCount = 0
+    var changes: [SBAScheduledActivityChanges] = []
+    
+    func reloadFinished(_ sender: Any?) {
+        reloadCount += 1
+    }
+    
+    func scheduledActivitiesDidChange(_ sender: Any?, changes: SBAScheduledActivityChanges) {
+        self.changes.append(changes)
+    }
+}
+
 class TestScheduledActivityManager: SBAScheduledActivityManager, SBABridgeInfo {
 
     // MARK: bridge info
@@ -1021,8 +1480,46 @@ class TestScheduledActivityManager: SBAScheduledActivityManager, SBABridgeInfo {
         updatedScheduledActivities = scheduledActivities
     }
     
+    var notificationSetupCount = 0
+    
+    override func setupNotifications(for scheduledActivities: [SBBScheduledActivity]) {
+        notificationSetupCount += 1
+    }
+    
+    var uploadedArchives: [SBAActivityArchive] = []
+    var archivedSchemaIdentifiers: [String] = []
+    
+    private let archiveLock = NSLock()
+    private var schemaIdentifierMap: [ObjectIdentifier : String] = [:]
+    
+    override func archive(for activityResult: SBAActivityResult) -> SBAActivityArchive? {
+        // Finish out of order to check that the upload order is preserved
+        usleep(useconds_t(arc4random_uniform(2000)))
+        guard let archive = super.archive(for: activityResult) else { return nil }
+        archiveLock.lock()
+        schemaIdentifierMap[ObjectIdentifier(archive)] = activityResult.schemaIdentifier
+        archiveLock.unlock()
+        return archive
+    }
+    
+    override func upload(archive: SBAActivityArchive) {
+        uploadedArchives.append(archive)
+        archiveLock.lock()
+        if let schemaIdentifier = schemaIdentifierMap[ObjectIdentifier(archive)] {
+            archivedSchemaIdentifiers.append(schemaIdentifier)
+        }
+        archiveLock.unlock()
+    }
+    
     override func instantiateTaskViewController(for schedule: SBBScheduledActivity, task: ORKTask, taskRef: SBATaskReference) -> SBATaskViewController {
         return TestTaskViewController(task: task, taskRun: nil)
     }
     
 }
+
+class TestPredicateScheduledActivityManager: TestScheduledActivityManager {
+    
+    override func filterPredicate(for tableSection: Int) -> NSPredicate? {
+        return SBBScheduledActivity.includeTasksPredicate(with: [tappingTaskId])
+    }
+}
@@ -1348,8 +1348,67 @@ class SBASurveyFactoryTests: XCTestCase {
         XCTAssertEqual(steps[3].text, "Question 3")
     }
     
+    // MARK: Task template cache
+    
+    func testTaskTemplateCache_ReturnsCopy() {
+        let survey = createLargeSurvey(questionCount: 10)
+        let factory = SBASurveyFactory()
+        factory.taskTemplateCache = SBATaskTemplateCache()
+        
+        let task1 = factory.cachedTaskWithSurvey(survey)
+        let task2 = factory.cachedTaskWithSurvey(survey)
+        XCTAssertFalse(task1 === task2)
+        XCTAssertEqual(task1.steps.count, 10)
+        XCTAssertEqual(task1.steps.map { $0.identifier }, task2.steps.map { $0.identifier })
+        XCTAssertFalse(task1.steps.first === task2.steps.first)
+        
+        // A different survey version is not the same template
+        let newVersion = createLargeSurvey(questionCount: 5, guid: survey.guid)
+        XCTAssertEqual(factory.cachedTaskWithSurvey(newVersion).steps.count, 5)
+    }
+    
+    func testTaskPresentationPerformance_Uncached() {
+        let survey = createLargeSurvey(questionCount: 300)
+        measure {
+            let factory = SBASurveyFactory()
+            factory.taskTemplateCache = nil
+            let task = factory.cachedTaskWithSurvey(survey)
+            let _ = ORKTaskViewController(task: task, taskRun: nil)
+        }
+    }
+    
+    func testTaskPresentationPerformance_Cached() {
+        let survey = createLargeSurvey(questionCount: 300)
+        let cache = SBATaskTemplateCache()
+        measure {
+            let factory = SBASurveyFactory()
+            factory.taskTemplateCache = cache
+            let task = factory.cachedTaskWithSurvey(survey)
+            let _ = ORKTaskViewController(task: task, taskRun: nil)
+        }
+    }
+    
     
     // MARK: Helper methods
+    
+    func createLargeSurvey(questionCount: Int, guid: String = UUID().uuidString) -> SBBSurvey {
+        let survey = SBBSurvey()
+        survey.createdOn = Date(timeIntervalSinceNow: Double(questionCount))
+        survey.guid = guid
+        survey.identifier = "large"
+        for ii in 0..<questionCount {
+            let question = ii % 2 == 0 ? createMultipleChoiceQuestion(allowMultiple: false) : SBBSurveyQuestion()
+            question.identifier = "question\(ii)"
+            question.guid = UUID().uuidString
+            if ii % 2 == 1 {
+                question.uiHint = "checkbox"
+                question.prompt = "Question \(ii)"
+                question.constraints = SBBBooleanConstraints()
+            }
+            survey.addElementsObject(question)
+        }
+        return survey
+    }
 
     func createMultipleChoiceQuestion(allowMultiple: Bool) -> SBBSurveyQuestion {
         let inputStep:SBBSurveyQuestion = SBBSurveyQuestion()
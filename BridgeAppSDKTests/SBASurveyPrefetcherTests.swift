@@ -0,0 +1,205 @@
+//
+//  SBASurveyPrefetcherTests.swift
+//  BridgeAppSDK
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+import XCTest
+import BridgeSDK
+@testable import BridgeAppSDK
+
+class SBASurveyPrefetcherTests: XCTestCase {
+    
+    var storeURL: URL!
+    var loader: MockSurveyLoader!
+    var prefetcher: SBASurveyPrefetcher!
+    
+    override func setUp() {
+        super.setUp()
+        storeURL = URL(fileURLWithPath: NSTemporaryDirectory()).appendingPathComponent(UUID().uuidString)
+        loader = MockSurveyLoader()
+        prefetcher = SBASurveyPrefetcher(store: SBASurveyStore(directoryURL: storeURL), loader: loader)
+    }
+    
+    override func tearDown() {
+        try? FileManager.default.removeItem(at: storeURL)
+        super.tearDown()
+    }
+    
+    func testPrefetch_DeduplicatesRequests() {
+        let createdOn = Date(timeIntervalSince1970: 1000)
+        let references = (0..<30).map { createSurveyReference(guid: "survey\($0 % 3)", createdOn: createdOn) }
+        
+        prefetcher.maxConcurrentRequests = 10
+        prefetcher.prefetch(references)
+        prefetcher.prefetch(references)
+        waitForLoader()
+        
+        XCTAssertEqual(loader.requestCount, 3)
+    }
+    
+    func testPrefetch_LimitsConcurrentRequests() {
+        let createdOn = Date(timeIntervalSince1970: 1000)
+        let references = (0..<5).map { createSurveyReference(guid: "survey\($0)", createdOn: createdOn) }
+        
+        prefetcher.maxConcurrentRequests = 2
+        prefetcher.prefetch(references)
+        waitForLoader()
+        XCTAssertEqual(loader.requestCount, 2)
+        
+        // Completing a request starts the next one
+        loader.completeNext()
+        waitForLoader()
+        XCTAssertEqual(loader.requestCount, 3)
+    }
+    
+    func testPrefetch_SkipsStoredSurveys() {
+        let reference = createSurveyReference(guid: "survey", createdOn: Date(timeIntervalSince1970: 1000))
+        prefetcher.prefetch([reference])
+        waitForLoader()
+        loader.completeNext()
+        waitForLoader()
+        XCTAssertEqual(loader.requestCount, 1)
+        
+        // The survey is stored and is not requested again
+        prefetcher.prefetch([reference])
+        waitForLoader()
+        XCTAssertEqual(loader.requestCount, 1)
+        
+        // Loading the survey uses the stored copy
+        let expect = expectation(description: "load survey")
+        var loadedSurvey: SBBSurvey?
+        prefetcher.loadSurvey(reference) { (survey, _) in
+            loadedSurvey = survey
+            expect.fulfill()
+        }
+        waitForExpectations(timeout: 2, handler: nil)
+        XCTAssertEqual(loader.requestCount, 1)
+        XCTAssertEqual(loadedSurvey?.guid, "survey")
+        XCTAssertEqual(loadedSurvey?.elements.count, 1)
+    }
+    
+    func testLoadSurvey_JoinsRequestInFlight() {
+        let reference = createSurveyReference(guid: "survey", createdOn: Date(timeIntervalSince1970: 1000))
+        prefetcher.prefetch([reference])
+        
+        let expect = expectation(description: "load survey")
+        prefetcher.loadSurvey(reference) { (survey, _) in
+            XCTAssertNotNil(survey)
+            expect.fulfill()
+        }
+        waitForLoader()
+        XCTAssertEqual(loader.requestCount, 1)
+        
+        loader.completeNext()
+        waitForExpectations(timeout: 2, handler: nil)
+        XCTAssertEqual(loader.requestCount, 1)
+    }
+    
+    func testSurveyStore_ReadsJSON() {
+        // A survey with values that cannot be stored in a property list is stored as JSON
+        let store = SBASurveyStore(directoryURL: storeURL)
+        let key = SBASurveyKey(guid: "survey", createdOn: Date(timeIntervalSince1970: 1000))
+        let survey = SBBSurvey()
+        survey.guid = key.guid
+        survey.identifier = key.guid
+        survey.createdOn = key.createdOn
+        var dictionary = survey.dictionaryRepresentation() as! [String : Any]
+        dictionary["copyrightNotice"] = NSNull()
+        XCTAssertNil(try? PropertyListSerialization.data(fromPropertyList: dictionary, format: .binary, options: 0))
+        
+        try! FileManager.default.createDirectory(at: storeURL, withIntermediateDirectories: true, attributes: nil)
+        let data = try! JSONSerialization.data(withJSONObject: dictionary, options: [])
+        try! data.write(to: storeURL.appendingPathComponent(key.filename!))
+        
+        XCTAssertTrue(store.contains(key))
+        XCTAssertEqual(store.survey(for: key)?.guid, "survey")
+    }
+    
+    // MARK: helper methods
+    
+    func createSurveyReference(guid: String, createdOn: Date) -> SBBSurveyReference {
+        let reference = SBBSurveyReference()
+        reference.guid = guid
+        reference.identifier = guid
+        reference.createdOn = createdOn
+        return reference
+    }
+    
+    func waitForLoader() {
+        // The prefetcher starts requests on its own queue
+        let expect = expectation(description: "wait")
+        DispatchQueue.main.asyncAfter(deadline: .now() + 0.1) {
+            expect.fulfill()
+        }
+        waitForExpectations(timeout: 2, handler: nil)
+    }
+}
+
+class MockSurveyLoader: SBASurveyLoader {
+    
+    private let lock = NSLock()
+    private var requests: [(SBBSurveyReference, (SBBSurvey?, Error?) -> Void)] = []
+    private var _requestCount = 0
+    
+    var requestCount: Int {
+        lock.lock(); defer { lock.unlock() }
+        return _requestCount
+    }
+    
+    func loadSurvey(_ surveyReference: SBBSurveyReference, completion: @escaping (SBBSurvey?, Error?) -> Void) {
+        lock.lock(); defer { lock.unlock() }
+        _requestCount += 1
+        requests.append((surveyReference, completion))
+    }
+    
+    func completeNext() {
+        lock.lock()
+        guard requests.count > 0 else {
+            lock.unlock()
+            return
+        }
+        let (reference, completion) = requests.removeFirst()
+        lock.unlock()
+        
+        let step = SBBSurveyInfoScreen()
+        step.identifier = "intro"
+        step.title = "Title"
+        step.prompt = "Text"
+        
+        let survey = SBBSurvey()
+        survey.guid = reference.guid
+        survey.identifier = reference.identifier
+        survey.createdOn = reference.createdOn
+        survey.addElementsObject(step)
+        completion(survey, nil)
+    }
+}
@@ -0,0 +1,167 @@
+//
+//  SBAUploadLedgerTests.swift
+//  BridgeAppSDK
+//
+//  Copyright © 2017 Sage Bionetworks. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+// 1.  Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2.  Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation and/or
+// other materials provided with the distribution.
+//
+// 3.  Neither the name of the copyright holder(s) nor the names of any contributors
+// may be used to endorse or promote products derived from this software without
+// specific prior written permission. No license is granted to the trademarks of
+// the copyright holders even if such marks are included in this software.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+
+
+import XCTest
+import BridgeAppSDK
+
+class SBAUploadLedgerTests: XCTestCase {
+    
+    var rootURL: URL!
+    var ledgerURL: URL!
+    var uploader: MockArchiveUploader!
+    
+    override func setUp() {
+        super.setUp()
+        rootURL = URL(fileURLWithPath: NSTemporaryDirectory()).appendingPathComponent(UUID().uuidString)
+        ledgerURL = rootURL.appendingPathExtension("json")
+        uploader = MockArchiveUploader()
+    }
+    
+    override func tearDown() {
+        try? FileManager.default.removeItem(at: rootURL)
+        try? FileManager.default.removeItem(at: ledgerURL)
+        super.tearDown()
+    }
+    
+    func testRefresh_IndexesArchivesSmallestFirst() {
+        let large = createArchive(named: "large", size: 300)
+        let small = createArchive(named: "small", size: 100)
+        
+        let ledger = SBAUploadLedger(rootURL: rootURL, fileURL: ledgerURL, uploader: uploader)
+        ledger.refresh()
+        XCTAssertEqual(ledger.pendingFileURLs.map { $0.lastPathComponent }, ["encrypted.zip", "encrypted.zip"])
+        XCTAssertEqual(ledger.pendingFileURLs.map { $0.deletingLastPathComponent().lastPathComponent }, ["small", "large"])
+        XCTAssertEqual(ledger.pendingEntries.map { $0.fileSize }, [100, 300])
+        
+        // The ledger is read from disk without looking for the archives again
+        let reloaded = SBAUploadLedger(rootURL: rootURL, fileURL: ledgerURL, uploader: uploader)
+        XCTAssertEqual(reloaded.pendingEntries.count, 2)
+        
+        // Removed archives are dropped on refresh
+        try? FileManager.default.removeItem(at: large.deletingLastPathComponent())
+        reloaded.refresh()
+        XCTAssertEqual(reloaded.pendingEntries.map { $0.fileSize }, [100])
+        XCTAssertTrue(FileManager.default.fileExists(atPath: small.path))
+    }
+    
+    func testRetryPendingUploads() {
+        let large = createArchive(named: "large", size: 300)
+        let small = createArchive(named: "small", size: 100)
+        uploader.failingDirectories = ["large"]
+        
+        let ledger = SBAUploadLedger(rootURL: rootURL, fileURL: ledgerURL, uploader: uploader)
+        ledger.retryAge = 0
+        
+        let retried = expectation(description: "retried uploads")
+        ledger.retryPendingUploads {
+            retried.fulfill()
+        }
+        wait(for: [retried], timeout: 5)
+        
+        // The smaller archive is uploaded first and then deleted
+        XCTAssertEqual(uploader.uploadedDirectories, ["small", "large"])
+        XCTAssertFalse(FileManager.default.fileExists(atPath: small.path))
+        XCTAssertTrue(FileManager.default.fileExists(atPath: large.path))
+        
+        // The failed upload stays in the ledger
+        let entries = ledger.pendingEntries
+        XCTAssertEqual(entries.count, 1)
+        XCTAssertEqual(entries.first?.attemptCount, 1)
+        XCTAssertNotNil(entries.first?.lastError)
+        
+        let metrics = ledger.metrics
+        XCTAssertEqual(metrics.uploadCount, 1)
+        XCTAssertEqual(metrics.failureCount, 1)
+        XCTAssertEqual(metrics.bytesUploaded, 100)
+        
+        // The failed upload is not tried again until the retry interval has passed
+        let retriedAgain = expectation(description: "retried uploads again")
+        ledger.retryPendingUploads {
+            retriedAgain.fulfill()
+        }
+        wait(for: [retriedAgain], timeout: 5)
+        XCTAssertEqual(uploader.uploadedDirectories.count, 2)
+    }
+    
+    func testRemoveAll_DeletesPendingArchives() {
+        let large = createArchive(named: "large", size: 300)
+        let ledger = SBAUploadLedger(rootURL: rootURL, fileURL: ledgerURL, uploader: uploader)
+        ledger.refresh()
+        
+        // Archives that are not yet in the ledger are also removed
+        let small = createArchive(named: "small", size: 100)
+        ledger.removeAll()
+        XCTAssertEqual(ledger.pendingEntries.count, 0)
+        XCTAssertFalse(FileManager.default.fileExists(atPath: large.deletingLastPathComponent().path))
+        XCTAssertFalse(FileManager.default.fileExists(atPath: small.deletingLastPathComponent().path))
+        XCTAssertEqual(SBAUploadLedger(rootURL: rootURL, fileURL: ledgerURL, uploader: uploader).pendingEntries.count, 0)
+        
+        let expect = expectation(description: "retry")
+        ledger.retryPendingUploads {
+            expect.fulfill()
+        }
+        waitForExpectations(timeout: 2, handler: nil)
+        XCTAssertEqual(uploader.uploadedDirectories, [])
+    }
+    
+    // MARK: helper methods
+    
+    @discardableResult
+    func createArchive(named name: String, size: Int) -> URL {
+        let dirURL = rootURL.appendingPathComponent(name, isDirectory: true)
+        try? FileManager.default.createDirectory(at: dirURL, withIntermediateDirectories: true, attributes: nil)
+        let fileURL = dirURL.appendingPathComponent("encrypted.zip")
+        try? Data(count: size).write(to: fileURL)
+        return fileURL
+    }
+}
+
+/**
+ Stands in for the Bridge upload endpoint. Uploads from the `failingDirectories` fail with a
+ server error.
+ */
+class MockArchiveUploader: SBAArchiveUploader {
+    
+    var failingDirectories: Set<String> = []
+    var uploadedDirectories: [String] = []
+    
+    func uploadFile(_ fileURL: URL, completion: @escaping (Error?) -> Void) {
+        let directory = fileURL.deletingLastPathComponent().lastPathComponent
+        uploadedDirectories.append(directory)
+        let error: Error? = failingDirectories.contains(directory) ? NSError(domain: NSURLErrorDomain, code: 503, userInfo: nil) : nil
+        DispatchQueue.global().async {
+            completion(error)
+        }
+    }
+}
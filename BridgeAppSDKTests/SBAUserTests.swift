@@ -33,7 +33,7 @@
 
 import XCTest
 import BridgeSDK
-import BridgeAppSDK
+@testable import BridgeAppSDK
 
 class SBAUserTests: XCTestCase {
     
@@ -143,6 +143,96 @@ class SBAUserTests: XCTestCase {
         XCTAssertTrue(user.isDataSharingEnabled)
     }
     
+    func testKeychainCache_LaunchSequence() {
+        let keychain = MockKeychainWrapper()
+        keychain.keychain["sessionToken"] = "token" as NSString
+        keychain.keychain["password"] = "abcd1234" as NSString
+        keychain.keychain["username"] = "test+1002@sagebase.org" as NSString
+        keychain.keychain["SavedSubpopulationGuid"] = "subpopulation" as NSString
+        
+        let user = SBAUser()
+        user.profileManager = nil
+        user.keychain = keychain
+        
+        // Launch, login and ensureSignedIn each read the same values
+        for _ in 0..<3 {
+            XCTAssertEqual(user.sessionToken, "token")
+            XCTAssertEqual(user.password, "abcd1234")
+            XCTAssertEqual(user.email, "test+1002@sagebase.org")
+            XCTAssertEqual(user.subpopulationGuid, "subpopulation")
+            XCTAssertNil(user.consentSignature)
+            XCTAssertNil(user.externalId)
+        }
+        
+        // Each key is read from the keychain once, including the ones that are not set
+        XCTAssertEqual(keychain.objectForKey_callCount, 6)
+        
+        // Changes are written through to the keychain without reading it again
+        user.sessionToken = "newToken"
+        XCTAssertEqual(user.sessionToken, "newToken")
+        user.lockQueue.sync {}
+        user.keychainQueue.sync {}
+        XCTAssertEqual(keychain.setObject_callCount, 1)
+        XCTAssertEqual(keychain.keychain["sessionToken"] as? String, "newToken")
+        XCTAssertEqual(keychain.objectForKey_callCount, 6)
+        
+        // Resetting the user clears the cache
+        user.resetStoredUserData()
+        XCTAssertTrue(keychain.reset_called)
+        XCTAssertNil(user.sessionToken)
+        XCTAssertEqual(keychain.objectForKey_callCount, 7)
+    }
+    
+    func testResetStoredUserData_ResetsKeychainBeforeReturning() {
+        let keychain = MockKeychainWrapper()
+        keychain.keychain["externalId"] = "oldUser" as NSString
+        
+        let user = SBAUser()
+        user.profileManager = nil
+        user.keychain = keychain
+        user.sessionToken = "oldToken"
+        
+        // Sign out and then sign in as a new user that writes to the keychain directly
+        user.resetStoredUserData()
+        XCTAssertTrue(keychain.reset_called)
+        keychain.keychain["externalId"] = "newUser" as NSString
+        
+        user.lockQueue.sync {}
+        user.keychainQueue.sync {}
+        XCTAssertEqual(keychain.keychain["externalId"] as? String, "newUser")
+        XCTAssertNil(keychain.keychain["sessionToken"])
+    }
+    
+    func testResetStoredUserData_DropsPendingClientDataWrite() {
+        let clientDataKeychain = MockKeychainWrapper()
+        let previousKeychain = SBAClientDataProfileItem.keychain
+        let previousFlushDelay = SBAClientDataProfileItem.flushDelay
+        SBAClientDataProfileItem.keychain = clientDataKeychain
+        SBAClientDataProfileItem.flushDelay = 0.1
+        defer {
+            SBAClientDataProfileItem.keychain = previousKeychain
+            SBAClientDataProfileItem.flushDelay = previousFlushDelay
+        }
+        
+        let user = SBAUser()
+        user.profileManager = nil
+        user.keychain = MockKeychainWrapper()
+        
+        // Set a value and then sign out before the change is written
+        SBAClientDataProfileItem.addToCurrentValues(["value" : NSNumber(value: 3)], forProfileKey: "numberOfSiblings")
+        user.resetStoredUserData()
+        
+        let waited = expectation(description: "flush delay")
+        DispatchQueue.main.asyncAfter(deadline: .now() + 0.5) {
+            waited.fulfill()
+        }
+        wait(for: [waited], timeout: 2)
+        SBAClientDataProfileItem.flushCurrentValues()
+        
+        XCTAssertEqual(clientDataKeychain.setObject_callCount, 0)
+        XCTAssertNil(clientDataKeychain.keychain[SBAClientDataProfileItem.cachedItemsKey])
+    }
+    
     // MARK: helper methods
     
     func createLoginResponseObject(dataSharing: Bool, sharingScope: String, email: String) -> NSDictionary {
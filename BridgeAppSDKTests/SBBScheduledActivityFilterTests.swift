@@ -79,6 +79,122 @@ class SBBScheduledActivityFilterTests: XCTestCase {
         XCTAssertEqual(filtered, expected)
     }
 
+    // MARK: SBAScheduleFilter parity
+    
+    func testScheduleFilterParity_Simple() {
+        let schedules = createParitySchedules()
+        checkParity(schedules, SBBScheduledActivity.unfinishedPredicate(), .unfinished, "unfinished")
+        checkParity(schedules, SBBScheduledActivity.completedPredicate(), .completed, "completed")
+        checkParity(schedules, SBBScheduledActivity.optionalPredicate(), .optional, "optional")
+        checkParity(schedules, SBBScheduledActivity.finishedTodayPredicate(), .finishedToday(), "finishedToday")
+        checkParity(schedules, SBBScheduledActivity.scheduledTodayPredicate(), .scheduledToday(), "scheduledToday")
+        checkParity(schedules, SBBScheduledActivity.scheduledTomorrowPredicate(), .scheduledTomorrow(), "scheduledTomorrow")
+        checkParity(schedules, SBBScheduledActivity.expiredYesterdayPredicate(), .expiredYesterday(), "expiredYesterday")
+        checkParity(schedules, SBBScheduledActivity.availableTodayPredicate(), .availableToday(), "availableToday")
+        for numberOfDays in [1, 3, 7] {
+            checkParity(schedules, SBBScheduledActivity.scheduledComingUpPredicate(numberOfDays: numberOfDays),
+                        .scheduledComingUp(numberOfDays: numberOfDays), "scheduledComingUp \(numberOfDays)")
+        }
+        checkParity(schedules, SBBScheduledActivity.includeTasksPredicate(with: ["b", "d"]),
+                    .includeTasks(with: ["b", "d"]), "includeTasks")
+    }
+    
+    func testScheduleFilterParity_Dates() {
+        let schedules = createParitySchedules()
+        for offset in -3...3 {
+            let date = Date().addingNumberOfDays(offset)
+            checkParity(schedules, SBBScheduledActivity.finishedPredicate(on: date), .finished(on: date), "finished \(offset)")
+            checkParity(schedules, SBBScheduledActivity.scheduledPredicate(on: date), .available(on: date), "available \(offset)")
+        }
+    }
+    
+    func testScheduleFilterParity_Compound() {
+        let schedules = createParitySchedules()
+        
+        let todayPredicate = NSCompoundPredicate(andPredicateWithSubpredicates: [
+            NSCompoundPredicate(notPredicateWithSubpredicate: SBBScheduledActivity.optionalPredicate()),
+            SBBScheduledActivity.availableTodayPredicate()])
+        checkParity(schedules, todayPredicate, .and([.not(.optional), .availableToday()]), "today section")
+        
+        let keepGoingPredicate = NSCompoundPredicate(andPredicateWithSubpredicates: [
+            SBBScheduledActivity.optionalPredicate(),
+            SBBScheduledActivity.unfinishedPredicate(),
+            SBBScheduledActivity.availableTodayPredicate()])
+        checkParity(schedules, keepGoingPredicate, .and([.optional, .unfinished, .availableToday()]), "keep going section")
+        
+        let orPredicate = NSCompoundPredicate(orPredicateWithSubpredicates: [todayPredicate, SBBScheduledActivity.expiredYesterdayPredicate()])
+        checkParity(schedules, orPredicate, .or([.and([.not(.optional), .availableToday()]), .expiredYesterday()]), "or")
+        
+        // The wrapped predicate should match the filter
+        checkParity(schedules, SBAScheduleFilter.availableToday().predicate, .availableToday(), "wrapped predicate")
+    }
+    
+    func testScheduleFilterPerformance_Predicate() {
+        let schedules = createParitySchedules(repeatCount: 20)
+        let predicate = NSCompoundPredicate(andPredicateWithSubpredicates: [
+            NSCompoundPredicate(notPredicateWithSubpredicate: SBBScheduledActivity.optionalPredicate()),
+            SBBScheduledActivity.availableTodayPredicate()])
+        measureEvaluations(count: schedules.count) {
+            _ = schedules.filter({ predicate.evaluate(with: $0) })
+        }
+    }
+    
+    func testScheduleFilterPerformance_Compiled() {
+        let schedules = createParitySchedules(repeatCount: 20)
+        let filter = SBAScheduleFilter.and([.not(.optional), .availableToday()])
+        measureEvaluations(count: schedules.count) {
+            _ = schedules.filter({ filter.evaluate(with: $0) })
+        }
+    }
+    
+    func measureEvaluations(count: Int, _ block: @escaping () -> Void) {
+        var totalTime: TimeInterval = 0
+        var iterations = 0
+        self.measure {
+            let start = Date()
+            block()
+            totalTime += Date().timeIntervalSince(start)
+            iterations += 1
+        }
+        let evaluationsPerSecond = Double(count * iterations) / max(totalTime, .ulpOfOne)
+        print("\(self.name): \(Int(evaluationsPerSecond)) evaluations/sec")
+    }
+    
+    func checkParity(_ schedules: [SBBScheduledActivity], _ predicate: NSPredicate, _ filter: SBAScheduleFilter, _ message: String) {
+        let expected = schedules.filter({ predicate.evaluate(with: $0) }).map({ $0.guid! })
+        let actual = schedules.filter({ filter.evaluate(with: $0) }).map({ $0.guid! })
+        XCTAssertEqual(actual, expected, message)
+    }
+    
+    func createParitySchedules(repeatCount: Int = 1) -> [SBBScheduledActivity] {
+        let today = Date().startOfDay()
+        let hours: [TimeInterval] = [0, 4.5 * 60 * 60, 23.9 * 60 * 60]
+        let taskIds = ["a", "b", "c", "d"]
+        var schedules: [SBBScheduledActivity] = []
+        for _ in 0..<repeatCount {
+            for scheduledOffset in -3...3 {
+                for hour in hours {
+                    let scheduledOn = today.addingNumberOfDays(scheduledOffset).addingTimeInterval(hour)
+                    let expiresOptions: [Date?] = [nil] + (-2...3).map({ today.addingNumberOfDays($0).addingTimeInterval(hour) })
+                    let finishedOptions: [Date?] = [nil] + (-2...1).map({ today.addingNumberOfDays($0).addingTimeInterval(hour) })
+                    for expiresOn in expiresOptions {
+                        for finishedOn in finishedOptions {
+                            for optional in [true, false] {
+                                let taskId = taskIds[schedules.count % taskIds.count]
+                                schedules.append(createScheduledActivityWithTask(taskId,
+                                                                                 scheduledOn: scheduledOn,
+                                                                                 expiresOn: expiresOn,
+                                                                                 finishedOn: finishedOn,
+                                                                                 optional: optional))
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return schedules
+    }
+
     // MARK: helper methods
     
     func createScheduledActivityWithTask(_ taskId: String,